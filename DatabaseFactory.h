@@ -26,6 +26,9 @@ namespace afm {
 
                 IDatabaseSPtr createDatabase(const DatabaseOptions &options);
                 IDatabaseSPtr createDatabase(const std::string &connection, const std::string &name, DatabaseType type);
+
+            private:
+                IDatabaseSPtr allocateDatabase(DatabaseType type) const;
         };
     } // namespace database
 }
@@ -0,0 +1,40 @@
+/**
+ * IBlobStream.h
+ * 
+ * @brief - Chunked access to a single large binary value
+ */
+
+#ifndef _H_IBLOB_STREAM
+#define _H_IBLOB_STREAM
+
+#include <memory>
+
+#include "IVariableData.h"
+
+namespace afm {
+    namespace database {
+        class IBlobStream
+        {
+            public:
+                virtual ~IBlobStream() {}
+
+                // size of the whole value in bytes, for a write the size it was opened with
+                virtual uint64_t getSize() const = 0;
+                virtual uint64_t getPosition() const = 0;
+
+                // hands back the next max_length bytes or fewer, false once the value is exhausted or on error
+                virtual bool read(BinaryBlob &chunk, uint32_t max_length) = 0;
+
+                // appends the next length bytes, never more than the size it was opened with
+                virtual bool write(const uint8_t *pData, uint32_t length) = 0;
+
+                virtual bool isOpen() const = 0;
+
+                // a write only takes effect when every byte was written before closing
+                virtual bool close() = 0;
+        };
+
+        using IBlobStreamSPtr = std::shared_ptr<IBlobStream>;
+    }
+}
+#endif
@@ -0,0 +1,33 @@
+/**
+ * ICursor.h
+ * 
+ * @brief - Forward only cursor over the rows of a query
+ */
+
+#ifndef _H_ICURSOR
+#define _H_ICURSOR
+
+#include <memory>
+
+#include "IRow.h"
+
+namespace afm {
+    namespace database {
+        class ICursor
+        {
+            public:
+                virtual ~ICursor() {}
+
+                // hands back a fresh row each call, false once the rows are exhausted or on error
+                virtual bool next(IRowSPtr &pRow) = 0;
+
+                // once next has returned false, true when it stopped on an error rather than running out of rows
+                virtual bool hasFailed() const = 0;
+                virtual bool isOpen() const = 0;
+                virtual void close() = 0;
+        };
+
+        using ICursorSPtr = std::shared_ptr<ICursor>;
+    }
+}
+#endif
@@ -7,6 +7,8 @@
 #ifndef _H_IDATABASE
 #define _H_IDATABASE
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <set>
 #include <string>
@@ -14,12 +16,27 @@
 #include <nlohmann/json.hpp>
 
 #include "ITable.h"
+#include "ITransaction.h"
 
 namespace afm {
     namespace database {
 
         using DatabaseOptions = nlohmann::json;
 
+        // rows of an asynchronous query in their text form, NULL comes back empty
+        struct QueryResult {
+            bool                        success = false;
+            std::string                 error;
+            std::vector<std::string>    columns;
+            std::vector<RowData>        rows;
+            uint64_t                    affected_rows = 0;
+        };
+
+        using QueryCallback = std::function<void(const QueryResult &result)>;
+
+        // bound to the query's markers in order, written the backend's own way (? or $1), null binds SQL NULL
+        using QueryParameters = nlohmann::json;
+
         enum DatabaseType {
             SQLITE_DB,
             MYSQL_DB,
@@ -32,6 +49,7 @@ namespace afm {
             public:
                 virtual ~IDatabase() {}
 
+                virtual bool initialize(const DatabaseOptions &options) = 0;
                 virtual bool initialize(const std::string &connection, const std::string &database_name) = 0;
 
                 virtual DatabaseType getType() const = 0;
@@ -45,6 +63,22 @@ namespace afm {
                 virtual ITableSPtr createTable(const TableOptions &details) = 0;
 
                 virtual bool test_database() = 0;
+
+                // any statement, joins included, run by the server.  Rows carry the columns the result
+                // describes, named and typed by the backend rather than by a table
+                virtual ICursorSPtr query(const std::string &query, const QueryParameters &parameters = QueryParameters()) = 0;
+
+                // queued for the async driver, the callback runs on its thread once the query completes
+                virtual bool queryAsync(const std::string &query, QueryCallback callback) = 0;
+                virtual std::future<QueryResult> queryAsync(const std::string &query) = 0;
+
+                // sends every query in one round trip where the backend can, one result per query
+                virtual bool queryBatch(const std::vector<std::string> &queries, std::vector<QueryResult> &results) = 0;
+
+                // every table call from this thread joins it until it ends, beginning another inside it opens a savepoint.
+                // A read only one reads a single snapshot throughout and refuses writes where the backend can, the
+                // flag only counts for the outermost one
+                virtual ITransactionSPtr beginTransaction(bool read_only = false) = 0;
         };
 
         using IDatabaseSPtr = std::shared_ptr<IDatabase>;
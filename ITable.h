@@ -7,23 +7,87 @@
 #ifndef _H_ITABLE
 #define _H_ITABLE
 
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
 
+#include "IBlobStream.h"
 #include "IColumn.h"
+#include "ICursor.h"
 #include "IRow.h"
 
 namespace afm {
     namespace database {
         using TableOptions = nlohmann::json;
 
+        /**
+         * Filters rows on the server, every entry has to hold:
+         *      "column": value                     equality, null tests for null and an array is an in list
+         *      "column": {"op": operand, ...}      =, !=, <, <=, >, >=, like, not like, in, not in,
+         *                                          between, not between ([low, high]) and is null (true/false)
+         *      "$or": [{...}, {...}]               any one of the groups, each built the same way
+         *      "$and": [{...}, {...}]              every one of the groups
+         * and for get, scan and aggregate only
+         *      "$order_by": "column [asc|desc]"    or an array of them
+         *      "$limit": count, "$offset": count
+         * Values are bound where the backend supports it.
+         */
         using QueryOptions = nlohmann::json;
 
         static const QueryOptions sm_emptyOptions = nlohmann::json{};
 
+        static const uint32_t sc_default_batch_size = 500;
+
+        // layouts for moving a whole table to or from a file
+        enum class BulkFormat {
+            Text,       // a line per row, tab separated columns in the backend's text escaping
+            Binary,     // the backend's own binary layout, only read back by the same backend
+            EndBulkFormats
+        };
+
+        // handed each exported row in turn, returning false stops the export
+        using RowCallback = std::function<bool(const IRowSPtr &pRow)>;
+
+        // fills in the next row to import, returning false once there are no more
+        using RowSource = std::function<bool(IRowSPtr &pRow)>;
+
+        // the columns a query brings back, in the order they appear in each row
+        using ColumnNames = std::vector<std::string>;
+
+        enum class PageOrder {
+            Ascending,
+            Descending,
+            EndPageOrders
+        };
+
+        // the key values of the last row a page ended on, null before the first page and after the last
+        using PageToken = nlohmann::json;
+
+        enum class AggregateFunction {
+            Count,      // rows, or values that are not null when a column is named
+            Sum,
+            Minimum,
+            Maximum,
+            Average,
+            EndAggregateFunctions
+        };
+
+        struct Aggregate {
+            AggregateFunction   function = AggregateFunction::Count;
+            std::string         column;
+        };
+
+        using Aggregates = std::vector<Aggregate>;
+
+        // one per group, the grouping values in order followed by one value per aggregate.
+        // Counts come back as BIG_INT_T, sums as BIG_INT_T over integers and FLOAT_T otherwise,
+        // averages as FLOAT_T and minimum and maximum in the type of their column.
+        using AggregateRow = std::vector<IVariableDataSPtr>;
+        using AggregateRows = std::vector<AggregateRow>;
+
         class ITable
         {
             public:
@@ -35,9 +99,45 @@ namespace afm {
                 virtual Columns getColumns() const = 0;
                 virtual bool get(IRowSPtr &pRow, const QueryOptions &options = sm_emptyOptions) = 0;
                 virtual bool set(IRowSPtr &pRow, const QueryOptions &options = sm_emptyOptions) = 0;
+                // no rows matching is not a failure, rows is simply left empty
                 virtual bool get(Rows &rows, const QueryOptions &options = sm_emptyOptions) = 0;
+
+                // rows holding only the named columns, no names brings back every column
+                virtual bool get(Rows &rows, const ColumnNames &columns, const QueryOptions &options = sm_emptyOptions) = 0;
                 virtual bool create(IRowSPtr &pRow) = 0;
 
+                // inserts in batches of batch_size rows, each batch is a single transaction
+                virtual bool createMany(const Rows &rows, uint32_t batch_size = sc_default_batch_size) = 0;
+
+                // streams the rows instead of materializing them, the cursor holds the connection until closed
+                virtual ICursorSPtr scan(const QueryOptions &options = sm_emptyOptions) = 0;
+                virtual ICursorSPtr scan(const ColumnNames &columns, const QueryOptions &options = sm_emptyOptions) = 0;
+
+                // the next page_size rows after token in key order, token moves on to where this page ended.
+                // The key is the primary key unless named, it has to be unique and options can't order or limit.
+                virtual bool page(Rows &rows, PageToken &token, uint32_t page_size, PageOrder order = PageOrder::Ascending,
+                                  const QueryOptions &options = sm_emptyOptions, const ColumnNames &key = ColumnNames()) = 0;
+
+                // computed by the server over the rows matching options, a row per distinct group_by value
+                virtual bool aggregate(AggregateRows &results, const Aggregates &aggregates, const ColumnNames &group_by = ColumnNames(),
+                                       const QueryOptions &options = sm_emptyOptions) = 0;
+
+                // moves one binary column of the row matching options in chunks rather than as a single value
+                virtual IBlobStreamSPtr readBlob(const std::string &column_name, const QueryOptions &options) = 0;
+
+                // replaces the value with size bytes, written through the stream and applied when it is closed
+                virtual IBlobStreamSPtr writeBlob(const std::string &column_name, const QueryOptions &options, uint64_t size) = 0;
+
+                // every column of every row in one pass, files are only supported where the backend has a bulk copy.
+                // On PostgreSQL the file copy runs outside of any transaction, so it fails while this thread has one open
+                virtual bool exportRows(const std::string &file_name, BulkFormat format = BulkFormat::Text) = 0;
+                // the callback returning false stops early and is not a failure, a row that could not be fetched is
+                virtual bool exportRows(RowCallback callback) = 0;
+                virtual bool importRows(const std::string &file_name, BulkFormat format = BulkFormat::Text) = 0;
+
+                // rows are pulled from source as they are written, batch_size rows to a transaction
+                virtual bool importRows(RowSource source, uint32_t batch_size = sc_default_batch_size) = 0;
+
                 virtual IRowSPtr createEmptyRow() const = 0;
                 virtual IColumnSPtr createEmptyColumn() const = 0;
                 virtual std::string getColumnNames() const = 0;
@@ -45,6 +145,7 @@ namespace afm {
 
         using ITableSPtr = std::shared_ptr<ITable>;
         using Tables = std::set<ITableSPtr>;
+        using TableNames = std::vector<std::string>;
     }
 }
 #endif
\ No newline at end of file
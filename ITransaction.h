@@ -0,0 +1,29 @@
+/**
+ * ITransaction.h
+ * 
+ * @brief - scoped transaction over the table operations of the thread that began it
+ */
+
+#ifndef _H_ITRANSACTION
+#define _H_ITRANSACTION
+
+#include <memory>
+
+namespace afm {
+    namespace database {
+        class ITransaction
+        {
+            public:
+                // rolls back when released while still active
+                virtual ~ITransaction() {}
+
+                // a PostgreSQL cursor or blob stream still open inside the transaction is closed when it ends
+                virtual bool commit() = 0;
+                virtual bool rollback() = 0;
+                virtual bool isActive() const = 0;
+        };
+
+        using ITransactionSPtr = std::shared_ptr<ITransaction>;
+    }
+}
+#endif
@@ -117,11 +117,11 @@ namespace afm {
                 virtual bool getValue(int64_t &value) const = 0;
                 virtual bool setValue(const int64_t &value) = 0;
 
-                // Decimal / Numeric
+                // Decimal / Numeric, held as a double and narrowed on the way out
                 virtual bool getValue(float &value) const = 0;
                 virtual bool setValue(const float &value) = 0;
 
-                // Float / Real
+                // Float / Real, Decimal / Numeric at full width
                 virtual bool getValue(double &value) const = 0;
                 virtual bool setValue(const double &value) = 0;
 
@@ -0,0 +1,94 @@
+/**
+ * AsyncDriver.h
+ *
+ * @brief - event loop multiplexing queries over non blocking connections
+ */
+
+#ifndef _H_ASYNC_DRIVER
+#define _H_ASYNC_DRIVER
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IDatabase.h"
+
+namespace afm {
+    namespace database {
+
+        /**
+         * One non blocking connection of a backend, the driver waits on its socket and
+         * calls back in whenever the socket is ready.  Events are epoll event bits.
+         */
+        class AsyncConnection
+        {
+            public:
+                virtual ~AsyncConnection() {}
+
+                virtual int getSocket() const = 0;
+
+                // send the query off, returns the events to wait for or 0 once it is complete
+                virtual uint32_t start(const std::string &query) = 0;
+                virtual uint32_t resume(uint32_t events) = 0;
+
+                // collects what the completed query left behind
+                virtual void getResult(QueryResult &result) = 0;
+        };
+
+        using AsyncConnectionSPtr = std::shared_ptr<AsyncConnection>;
+        using AsyncConnections = std::vector<AsyncConnectionSPtr>;
+
+        /**
+         * A single thread waits in epoll on every connection socket along with an eventfd
+         * that wakes it for new submissions.  Queries queue until a connection is idle,
+         * each connection carries one query at a time.  Callbacks run on the driver thread
+         * so they should hand anything lengthy off elsewhere.
+         */
+        class AsyncDriver
+        {
+            public:
+                AsyncDriver();
+                virtual ~AsyncDriver();
+
+                bool initialize(const AsyncConnections &connections);
+                bool submit(const std::string &query, QueryCallback callback);
+
+            private:
+                struct PendingQuery {
+                    uint64_t        id = 0;
+                    std::string     query;
+                    QueryCallback   callback;
+                };
+
+                struct Slot {
+                    AsyncConnectionSPtr pConnection = nullptr;
+                    QueryCallback       callback;
+                    bool                busy = false;
+                };
+
+                bool wake();
+                void event_loop();
+                void dispatch();
+                void advance(uint32_t index, uint32_t events);
+                void complete(uint32_t index);
+                bool watch(uint32_t index, uint32_t events);
+                void fail_all(const std::string &error);
+
+                int                         m_epoll = -1;
+                int                         m_wakeup = -1;
+                std::vector<Slot>           m_slots;
+                std::deque<PendingQuery>    m_pending;
+                uint64_t                    m_next_id = 0;
+                std::mutex                  m_lock;
+                std::thread                 m_thread;
+                std::atomic<bool>           m_stopping;
+        };
+
+        using AsyncDriverSPtr = std::shared_ptr<AsyncDriver>;
+    }
+}
+#endif
@@ -0,0 +1,45 @@
+/**
+ * BlobStream.h
+ * 
+ * @brief - Blob stream base class regardless of implementation
+ */
+
+#ifndef _H_BLOB_STREAM
+#define _H_BLOB_STREAM
+
+#include "IBlobStream.h"
+
+namespace afm {
+    namespace database {
+        class BlobStream : public IBlobStream
+        {
+            public:
+                BlobStream(uint64_t size, bool is_writable);
+                virtual ~BlobStream();
+
+                virtual uint64_t getSize() const final { return m_size; }
+                virtual uint64_t getPosition() const final { return m_position; }
+                virtual bool read(BinaryBlob &chunk, uint32_t max_length) final;
+                virtual bool write(const uint8_t *pData, uint32_t length) final;
+                virtual bool isOpen() const final { return m_is_open; }
+                virtual bool close() final;
+
+            protected:
+                bool is_writable() const { return m_is_writable; }
+
+                // derived classes must call close() from their destructor
+                virtual bool on_read(uint64_t offset, uint8_t *pBuffer, uint32_t length) = 0;
+                virtual bool on_write(uint64_t offset, const uint8_t *pData, uint32_t length) = 0;
+
+                // complete is only true for a write that received every byte, anything else is discarded
+                virtual bool on_close(bool complete) = 0;
+
+            private:
+                uint64_t    m_size = 0;
+                uint64_t    m_position = 0;
+                bool        m_is_writable = false;
+                bool        m_is_open = true;
+        };
+    }
+}
+#endif
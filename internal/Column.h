@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <ctime> 
+#include <vector>
 
 #include "IColumn.h"
 
@@ -65,6 +66,25 @@ namespace afm {
         static const std::string sc_text_type = "TEXT";
         static const std::string sc_clob_type = "CLOB";
 
+        enum ColumnDescriptionFlags : uint8_t {
+            sc_description_primary = 0x01,
+            sc_description_key = 0x02,
+            sc_description_unique = 0x04,
+            sc_description_null = 0x08,
+            sc_description_auto_increment = 0x10
+        };
+
+        // resolved column metadata, enough to rebuild a column without parsing its type again
+        struct ColumnDescription {
+            std::string name;
+            DataType    type = DataType::EndDataTypes;
+            uint64_t    max_length = 0;
+            uint8_t     precision = 0;
+            uint8_t     flags = 0;
+        };
+
+        using ColumnDescriptions = std::vector<ColumnDescription>;
+
         class Column : public IColumn
         {
             public:
@@ -76,6 +96,9 @@ namespace afm {
 
                 virtual bool initialize(const std::string &details) override = 0;
 
+                bool initialize(const ColumnDescription &description);
+                void describe(ColumnDescription &description) const;
+
                 virtual std::string getName() const final { return m_name; }
                 virtual DataType getType() const final;
                 virtual std::string getTypeName() const override = 0;
@@ -0,0 +1,285 @@
+/**
+ * ConnectionPool.h
+ *
+ * @brief - pool of backend connections leased out per thread
+ */
+
+#ifndef _H_CONNECTION_POOL
+#define _H_CONNECTION_POOL
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace afm {
+    namespace database {
+        struct ConnectionPoolSettings {
+            std::size_t             min_connections = 0;
+            std::size_t             max_connections = 1;
+            std::chrono::seconds    idle_timeout{0};            // idle longer than this closes, down to min_connections, 0 never
+            std::chrono::seconds    health_check_interval{0};   // idle longer than this is checked before reuse, 0 every time
+        };
+
+        /**
+         * Connections are handed out as leases, a lease goes back to the pool once the last
+         * copy of it is released.  A thread asking again while it still holds a lease is given
+         * the same connection so nested calls on one thread cannot starve themselves.  Anything
+         * that keeps a connection busy between calls, a cursor part way through its rows, takes
+         * an exclusive one instead so the thread's other calls don't land in the middle of it.
+         *
+         * Idle connections past the idle timeout are closed on the next acquire, and with a
+         * health check an idle connection is only reused once it passes, otherwise it is
+         * closed and the next idle one or a new one is tried.
+         *
+         * The pool must be owned by a std::shared_ptr as each lease refers back to it.
+         */
+        template <typename ConnectionType>
+        class ConnectionPool : public std::enable_shared_from_this<ConnectionPool<ConnectionType>>
+        {
+            public:
+                using ConnectionSPtr = std::shared_ptr<ConnectionType>;
+                using ConnectionFactory = std::function<ConnectionSPtr()>;
+                using HealthCheck = std::function<bool(const ConnectionSPtr &pConnection)>;
+
+                ConnectionPool(ConnectionFactory factory, std::size_t max_connections)
+                    : m_factory(factory)
+                    , m_max_connections(max_connections > 0 ? max_connections : 1)
+                {
+
+                }
+
+                ConnectionPool(ConnectionFactory factory, const ConnectionPoolSettings &settings, HealthCheck health_check = nullptr)
+                    : m_factory(factory)
+                    , m_health_check(health_check)
+                    , m_max_connections(settings.max_connections > 0 ? settings.max_connections : 1)
+                    , m_min_connections(settings.min_connections)
+                    , m_idle_timeout(settings.idle_timeout)
+                    , m_health_check_interval(settings.health_check_interval)
+                {
+
+                }
+
+                virtual ~ConnectionPool()
+                {
+                    clear();
+                }
+
+                // open connections up front so a bad configuration fails early
+                bool reserve(std::size_t connection_count)
+                {
+                    bool success = true;
+                    std::unique_lock<std::mutex> guard(m_mutex);
+
+                    while ((success == true) && (m_idle.size() < connection_count) && (m_open < m_max_connections)) {
+                        ConnectionSPtr pConnection = m_factory();
+
+                        if (pConnection != nullptr) {
+                            m_idle.push_back({pConnection, Clock::now()});
+                            m_open++;
+                        } else {
+                            success = false;
+                        }
+                    }
+
+                    return success;
+                }
+
+                ConnectionSPtr acquire()
+                {
+                    ConnectionSPtr pLease = nullptr;
+                    std::thread::id owner = std::this_thread::get_id();
+                    std::unique_lock<std::mutex> guard(m_mutex);
+
+                    typename LeaseMap::iterator iter = m_leases.find(owner);
+
+                    if (iter != m_leases.end()) {
+                        pLease = iter->second.lock();
+                    }
+
+                    if (pLease == nullptr) {
+                        ConnectionSPtr pConnection = open_connection(guard, true);
+
+                        if (pConnection != nullptr) {
+                            pLease = make_lease(pConnection, owner);
+                            m_leases[owner] = pLease;
+                        }
+                    }
+
+                    return pLease;
+                }
+
+                // a connection apart from the thread's lease, never handed to another acquire while held.
+                // With the pool exhausted it fails rather than waits when the thread holds a lease itself,
+                // it could otherwise be waiting on its own connection
+                ConnectionSPtr acquireExclusive()
+                {
+                    ConnectionSPtr pLease = nullptr;
+                    std::unique_lock<std::mutex> guard(m_mutex);
+                    typename LeaseMap::iterator iter = m_leases.find(std::this_thread::get_id());
+                    bool can_wait = (iter == m_leases.end()) || (iter->second.expired() == true);
+                    ConnectionSPtr pConnection = open_connection(guard, can_wait);
+
+                    if (pConnection != nullptr) {
+                        // owned by no thread, so no acquire finds it in the lease map
+                        pLease = make_lease(pConnection, std::thread::id());
+                    }
+
+                    return pLease;
+                }
+
+                // the lease the calling thread already holds, nullptr rather than acquiring one
+                ConnectionSPtr getLease()
+                {
+                    ConnectionSPtr pLease = nullptr;
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    typename LeaseMap::iterator iter = m_leases.find(std::this_thread::get_id());
+
+                    if (iter != m_leases.end()) {
+                        pLease = iter->second.lock();
+                    }
+
+                    return pLease;
+                }
+
+                // closes the idle connections, leased ones are closed rather than kept as they come back
+                void clear()
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    m_open -= m_idle.size();
+                    m_idle.clear();
+                    m_generation++;
+                }
+
+                std::size_t getMaxConnections() const { return m_max_connections; }
+
+            private:
+                using Clock = std::chrono::steady_clock;
+                using LeaseMap = std::map<std::thread::id, std::weak_ptr<ConnectionType>>;
+
+                struct IdleConnection {
+                    ConnectionSPtr      pConnection;
+                    Clock::time_point   since;
+                };
+
+                // an idle connection or a new one, waiting for one to come back when allowed
+                ConnectionSPtr open_connection(std::unique_lock<std::mutex> &guard, bool can_wait)
+                {
+                    ConnectionSPtr pConnection = nullptr;
+                    bool failed = false;
+
+                    while ((pConnection == nullptr) && (failed == false)) {
+                        if (can_wait == true) {
+                            m_available.wait(guard, [this]() { return (m_idle.size() > 0) || (m_open < m_max_connections); });
+                        } else if ((m_idle.size() == 0) && (m_open >= m_max_connections)) {
+                            failed = true;
+                        }
+
+                        if (failed == false) {
+                            expire_idle();
+
+                            if (m_idle.size() > 0) {
+                                IdleConnection idle = m_idle.front();
+
+                                m_idle.pop_front();
+                                pConnection = idle.pConnection;
+
+                                // checked outside the lock, it may well be a round trip to the server
+                                if ((m_health_check != nullptr) && ((Clock::now() - idle.since) >= m_health_check_interval)) {
+                                    guard.unlock();
+                                    bool healthy = m_health_check(pConnection);
+                                    guard.lock();
+
+                                    if (healthy == false) {
+                                        pConnection = nullptr;
+                                        m_open--;
+                                    }
+                                }
+                            } else {
+                                // hold the slot while opening so others don't overshoot the limit
+                                m_open++;
+                                guard.unlock();
+                                pConnection = m_factory();
+                                guard.lock();
+
+                                if (pConnection == nullptr) {
+                                    m_open--;
+                                    m_available.notify_one();
+                                    failed = true;
+                                }
+                            }
+                        }
+                    }
+
+                    return pConnection;
+                }
+
+                // released connections go on the front, so the oldest idle are at the back
+                void expire_idle()
+                {
+                    if (m_idle_timeout.count() > 0) {
+                        Clock::time_point cutoff = Clock::now() - m_idle_timeout;
+
+                        while ((m_idle.size() > 0) && (m_open > m_min_connections) && (m_idle.back().since < cutoff)) {
+                            m_idle.pop_back();
+                            m_open--;
+                        }
+                    }
+                }
+
+                ConnectionSPtr make_lease(const ConnectionSPtr &pConnection, std::thread::id owner)
+                {
+                    std::weak_ptr<ConnectionPool> pPool = this->shared_from_this();
+                    uint64_t generation = m_generation;
+
+                    return ConnectionSPtr(pConnection.get(), [pPool, pConnection, owner, generation](ConnectionType *) {
+                        std::shared_ptr<ConnectionPool> pOwner = pPool.lock();
+
+                        // if the pool is gone the connection simply closes with the lease
+                        if (pOwner != nullptr) {
+                            pOwner->release(pConnection, owner, generation);
+                        }
+                    });
+                }
+
+                void release(const ConnectionSPtr &pConnection, std::thread::id owner, uint64_t generation)
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    typename LeaseMap::iterator iter = m_leases.find(owner);
+
+                    // the owner may already hold a newer lease, leave that one alone
+                    if ((iter != m_leases.end()) && (iter->second.expired() == true)) {
+                        m_leases.erase(iter);
+                    }
+
+                    // leased out before a clear, it closes with the lease instead of going back
+                    if (generation == m_generation) {
+                        m_idle.push_front({pConnection, Clock::now()});
+                    } else {
+                        m_open--;
+                    }
+                    m_available.notify_one();
+                }
+
+                ConnectionFactory           m_factory;
+                HealthCheck                 m_health_check = nullptr;
+                std::size_t                 m_max_connections = 1;
+                std::size_t                 m_min_connections = 0;
+                std::chrono::seconds        m_idle_timeout{0};
+                std::chrono::seconds        m_health_check_interval{0};
+                std::size_t                 m_open = 0;
+                uint64_t                    m_generation = 0;
+                std::list<IdleConnection>   m_idle;
+                LeaseMap                    m_leases;
+                std::mutex                  m_mutex;
+                std::condition_variable     m_available;
+        };
+    }
+}
+#endif
@@ -0,0 +1,54 @@
+/**
+ * Cursor.h
+ * 
+ * @brief - Cursor base class regardless of implementation
+ */
+
+#ifndef _H_CURSOR
+#define _H_CURSOR
+
+#include "ICursor.h"
+#include "Table.h"
+
+namespace afm {
+    namespace database {
+
+        class Cursor : public ICursor
+        {
+            public:
+                // the table is held for as long as the cursor lives, its rows are made from the table's columns
+                Cursor(TableConstSPtr pTable, const Projection &projection = Projection());
+
+                // rows shaped by the result of a query rather than a table, see set_columns
+                Cursor();
+                virtual ~Cursor();
+
+                virtual bool next(IRowSPtr &pRow) final;
+                virtual bool hasFailed() const final { return m_has_failed; }
+                virtual bool isOpen() const final { return m_is_open; }
+                virtual void close() final;
+
+            protected:
+                // derived classes must call close() from their destructor
+                virtual bool on_next(IRowSPtr &pRow) = 0;
+                virtual void on_close() = 0;
+
+                // on_next returns false for both, this marks the error
+                void set_failed() { m_has_failed = true; }
+
+                // a query cursor describes its rows once the query has run, each column made by on_create_column
+                void set_columns(const ColumnDescriptions &columns) { m_columns = columns; }
+                virtual IColumnSPtr on_create_column() const { return nullptr; }
+
+            private:
+                IRowSPtr create_row() const;
+
+                TableConstSPtr      m_pTable = nullptr;
+                Projection          m_projection;
+                ColumnDescriptions  m_columns;
+                bool                m_is_open = true;
+                bool                m_has_failed = false;
+        };
+    }
+}
+#endif
@@ -7,7 +7,14 @@
 #ifndef _H_DATABASE
 #define _H_DATABASE
 
+#include <mutex>
+
 #include "IDatabase.h"
+#include "AsyncDriver.h"
+#include "ConnectionPool.h"
+#include "SchemaCache.h"
+#include "Table.h"
+#include "Transaction.h"
 
 namespace afm {
     namespace database {
@@ -38,6 +45,7 @@ namespace afm {
                 Database();
                 virtual ~Database();
 
+                virtual bool initialize(const DatabaseOptions &options) final;
                 virtual bool initialize(const std::string &connection, const std::string &database_name) override;
 
                 virtual DatabaseType getType() const final;
@@ -52,6 +60,15 @@ namespace afm {
 
                 virtual bool test_database() override = 0;
 
+                virtual ICursorSPtr query(const std::string &query, const QueryParameters &parameters = QueryParameters()) final;
+
+                virtual bool queryAsync(const std::string &query, QueryCallback callback) final;
+                virtual std::future<QueryResult> queryAsync(const std::string &query) final;
+
+                virtual bool queryBatch(const std::vector<std::string> &queries, std::vector<QueryResult> &results) final;
+
+                virtual ITransactionSPtr beginTransaction(bool read_only = false) final;
+
             protected:
                 virtual void load_tables() = 0;
                 virtual uint32_t get_default_port() const { return 0; }
@@ -59,18 +76,41 @@ namespace afm {
                 void removeTable(ITableSPtr &pTable);
                 void setType(DatabaseType type) { m_type = type; }
                 std::string getName() const { return m_database_name; }
+                const DatabaseOptions &getOptions() const { return m_options; }
                 virtual std::string build_table_create(ITableSPtr &pTable) const;
                 const ConnectionDetails &getConnectionDetails() const { return m_connection_details; }
                 void parse_connection_details(const std::string &connection_details);
                 void set_database_field(CreateDatabaseField field, const std::string &field_value);
                 std::string get_database_field(CreateDatabaseField field) const;
+                bool get_preload_tables(const TableNames &available, TableNames &tables) const;
+
+                // sizes and timeouts for the backends that pool their connections
+                ConnectionPoolSettings get_pool_settings() const;
+                bool load_schema_cache(CatalogDescriptions &catalog);
+                void save_schema_cache();
+                virtual bool get_schema_version(std::string &version) = 0;
+
+                // separate non blocking connections for the async driver, none unless the backend has them
+                virtual bool create_async_connections(uint32_t count, AsyncConnections &connections) { return false; }
 
                 virtual std::string get_column_creation(IColumnSPtr &pColumn) const;
                 virtual bool on_drop_table(const std::string &query) = 0;
+                virtual void on_query_batch(const std::vector<std::string> &queries, std::vector<QueryResult> &results) = 0;
+
+                // the cursor holds its connection until it is closed, the same lease when this thread is in a transaction
+                virtual ICursorSPtr on_query(const std::string &query, const StatementValues &values) = 0;
+
+                // the lease the calling thread writes through, the same one its table calls get
+                virtual TransactionConnectionSPtr get_transaction_connection() = 0;
 
             private:
                 DatabaseFieldMap    m_field_map;
                 ConnectionDetails   m_connection_details;
+                DatabaseOptions     m_options;
+                SchemaCacheSPtr     m_pSchemaCache = nullptr;
+                std::string         m_schema_version;
+                AsyncDriverSPtr     m_pAsyncDriver = nullptr;
+                std::mutex          m_async_lock;
                 std::string         m_database_name;
                 DatabaseType        m_type = DatabaseType::END_DATABASE_TYPES;
                 Tables              m_tables;
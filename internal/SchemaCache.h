@@ -0,0 +1,39 @@
+/**
+ * SchemaCache.h
+ *
+ * @brief - resolved catalog kept in a binary file between runs
+ */
+
+#ifndef _H_SCHEMA_CACHE
+#define _H_SCHEMA_CACHE
+
+#include <memory>
+#include <string>
+
+#include "Table.h"
+
+namespace afm {
+    namespace database {
+        /**
+         * The file is a fixed header, a table record per table, a column record per column and
+         * then the names and version text.  Records are fixed size so a load maps the file and
+         * reads them in place, nothing is parsed.  The cache is only used when the stored
+         * version matches the one the server reports now.
+         */
+        class SchemaCache
+        {
+            public:
+                SchemaCache(const std::string &file_name);
+                virtual ~SchemaCache();
+
+                bool load(const std::string &version, CatalogDescriptions &catalog) const;
+                bool save(const std::string &version, const CatalogDescriptions &catalog) const;
+
+            private:
+                std::string m_file_name;
+        };
+
+        using SchemaCacheSPtr = std::shared_ptr<SchemaCache>;
+    }
+}
+#endif
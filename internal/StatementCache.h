@@ -0,0 +1,101 @@
+/**
+ * StatementCache.h
+ *
+ * @brief - per connection cache of idle prepared statements, for any backend
+ */
+
+#ifndef _H_STATEMENT_CACHE
+#define _H_STATEMENT_CACHE
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace afm {
+    namespace database {
+        /**
+         * Idle statements are kept in least recently used order keyed by their sql text,
+         * the text already encodes the table, operation, column set and predicate columns.
+         * A statement is handed out exclusively on acquire and comes back on release.
+         *
+         * StatementType is made from the connection's HandleType and provides initialize(query),
+         * getQuery() and reset(), the last readying it for the next caller.
+         */
+        template <typename StatementType, typename HandleType>
+        class StatementCache
+        {
+            public:
+                using StatementSPtr = std::shared_ptr<StatementType>;
+
+                StatementCache(HandleType *pHandle, std::size_t capacity)
+                    : m_pHandle(pHandle)
+                    , m_capacity(capacity)
+                {
+
+                }
+
+                virtual ~StatementCache()
+                {
+                    clear();
+                }
+
+                StatementSPtr acquire(const std::string &query)
+                {
+                    StatementSPtr pStatement = nullptr;
+                    typename StatementMap::iterator iter = m_lookup.find(query);
+
+                    if (iter != m_lookup.end()) {
+                        // hand it out exclusively, it is returned on release
+                        pStatement = *iter->second;
+                        m_statements.erase(iter->second);
+                        m_lookup.erase(iter);
+                    } else {
+                        pStatement = std::make_shared<StatementType>(m_pHandle);
+
+                        if (pStatement->initialize(query) == false) {
+                            pStatement = nullptr;
+                        }
+                    }
+
+                    return pStatement;
+                }
+
+                void release(StatementSPtr &pStatement)
+                {
+                    if (pStatement != nullptr) {
+                        pStatement->reset();
+
+                        // a second copy may have been prepared while this one was out, keep just one
+                        if ((m_capacity > 0) && (m_lookup.find(pStatement->getQuery()) == m_lookup.end())) {
+                            m_statements.push_front(pStatement);
+                            m_lookup[pStatement->getQuery()] = m_statements.begin();
+
+                            if (m_statements.size() > m_capacity) {
+                                // the last reference going finalizes it, on a server backend that frees it there too
+                                m_lookup.erase(m_statements.back()->getQuery());
+                                m_statements.pop_back();
+                            }
+                        }
+                        pStatement = nullptr;
+                    }
+                }
+
+                void clear()
+                {
+                    m_lookup.clear();
+                    m_statements.clear();
+                }
+
+            private:
+                using StatementList = std::list<StatementSPtr>;
+                using StatementMap = std::unordered_map<std::string, typename StatementList::iterator>;
+
+                HandleType      *m_pHandle = nullptr;
+                std::size_t     m_capacity = 0;
+                StatementList   m_statements;
+                StatementMap    m_lookup;
+        };
+    }
+}
+#endif
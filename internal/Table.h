@@ -7,47 +7,169 @@
 #ifndef _H_TABLE
 #define _H_TABLE
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "ITable.h"
 #include "Column.h"
 
 namespace afm {
     namespace database {
-        class Table : public ITable
+        // values handed to a backend in placeholder order when it binds rather than splices them
+        using StatementValues = std::vector<IVariableDataSPtr>;
+
+        // positions in the table columns of those a query brings back, empty for all of them
+        using Projection = std::vector<std::size_t>;
+
+        // the type each value of a result row is read into, in select order
+        using DataTypes = std::vector<DataType>;
+
+        // column descriptions in column order, each in the form the backend column initialize expects
+        using ColumnDetails = std::vector<std::string>;
+
+        // column descriptions for a whole catalog keyed by table name
+        using CatalogDetails = std::map<std::string, ColumnDetails>;
+
+        // resolved column metadata for a whole catalog keyed by table name
+        using CatalogDescriptions = std::map<std::string, ColumnDescriptions>;
+
+        // sql text compiled for one set of columns, columns_text leads and values_text follows,
+        // marker positions start from 1 so it only applies with no values bound ahead of it
+        struct StatementTemplate {
+            std::vector<std::string>    columns;
+            std::string                 columns_text;
+            std::string                 values_text;
+            bool                        anonymous_markers = false;
+        };
+
+        using StatementTemplates = std::vector<StatementTemplate>;
+
+        // shared so a cursor can keep the table it makes rows for alive
+        class Table : public ITable, public std::enable_shared_from_this<Table>
         {
             public:
                 virtual ~Table();
 
                 virtual bool initialize(const TableOptions &options) override;
                 virtual bool initialize(const std::string &table_name) override;
+                bool initialize(const std::string &table_name, const ColumnDetails &columns);
+                bool initialize(const std::string &table_name, const ColumnDescriptions &columns);
+                bool describe(ColumnDescriptions &columns) const;
                 virtual std::string getName() const final { return m_table_name; }
-                virtual Columns getColumns() const final { return m_columns; }
+                virtual Columns getColumns() const final { return get_columns(); }
                 virtual bool get(IRowSPtr &pRow, const QueryOptions &options = sm_emptyOptions) override;
                 virtual bool set(IRowSPtr &pRow, const QueryOptions &options = sm_emptyOptions) final;
                 virtual bool get(Rows &rows, const QueryOptions &options = sm_emptyOptions) override;
+                virtual bool get(Rows &rows, const ColumnNames &columns, const QueryOptions &options = sm_emptyOptions) final;
                 virtual bool create(IRowSPtr &pRow) final;
+                virtual bool createMany(const Rows &rows, uint32_t batch_size = sc_default_batch_size) final;
+                virtual ICursorSPtr scan(const QueryOptions &options = sm_emptyOptions) override;
+                virtual ICursorSPtr scan(const ColumnNames &columns, const QueryOptions &options = sm_emptyOptions) final;
+                virtual bool page(Rows &rows, PageToken &token, uint32_t page_size, PageOrder order = PageOrder::Ascending,
+                                  const QueryOptions &options = sm_emptyOptions, const ColumnNames &key = ColumnNames()) final;
+                virtual bool aggregate(AggregateRows &results, const Aggregates &aggregates, const ColumnNames &group_by = ColumnNames(),
+                                       const QueryOptions &options = sm_emptyOptions) final;
+                virtual IBlobStreamSPtr readBlob(const std::string &column_name, const QueryOptions &options) final;
+                virtual IBlobStreamSPtr writeBlob(const std::string &column_name, const QueryOptions &options, uint64_t size) final;
+                virtual bool exportRows(const std::string &file_name, BulkFormat format = BulkFormat::Text) final;
+                virtual bool exportRows(RowCallback callback) final;
+                virtual bool importRows(const std::string &file_name, BulkFormat format = BulkFormat::Text) final;
+                virtual bool importRows(RowSource source, uint32_t batch_size = sc_default_batch_size) final;
 
                 virtual std::string getColumnNames() const override;
                 virtual IRowSPtr createEmptyRow() const;
+                IRowSPtr createEmptyRow(const Projection &projection) const;
                 virtual IColumnSPtr createEmptyColumn() const = 0;
 
             protected:
                 void add_column(IColumnSPtr pColumn) { m_columns.push_back(pColumn); }
-                const Columns &get_columns() const { return m_columns; }
-                virtual void process_table_options(std::stringstream &output, const QueryOptions &options) const;
-                virtual bool on_create_row(const std::string &query) = 0;
-                virtual bool on_update_row(const std::string &query) = 0;
-                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query) = 0;
-                virtual bool on_get_rows(Rows &rows, const std::string &query) = 0;
+                const Columns &get_columns() const;
+                static std::string build_name_list(const TableNames &names);
+                // the where clause of the options, false when they are malformed
+                virtual bool process_table_options(std::stringstream &output, const QueryOptions &options, StatementValues &values) const;
+
+                // order by, limit and offset, only a select takes them
+                virtual bool process_query_modifiers(std::stringstream &output, const QueryOptions &options) const;
+
+                // what a limit reads when only an offset is given
+                virtual std::string get_unbounded_limit() const { return "-1"; }
+                virtual bool uses_bound_values() const { return false; }
+                virtual std::string get_parameter_marker(std::size_t index) const { return "?"; }
+                void append_value(std::stringstream &output, const IVariableDataSPtr &pValue, StatementValues &values) const;
+                virtual bool on_create_row(const std::string &query, const StatementValues &values) = 0;
+                virtual bool on_create_rows(const Rows &rows, uint32_t batch_size) = 0;
+                virtual bool on_update_row(const std::string &query, const StatementValues &values) = 0;
+                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query, const StatementValues &values) = 0;
+                // rows are shaped by the projection, see createEmptyRow
+                virtual bool on_get_rows(Rows &rows, const std::string &query, const StatementValues &values, const Projection &projection) = 0;
+                virtual ICursorSPtr on_scan(const std::string &query, const StatementValues &values, const Projection &projection) = 0;
+
+                // a result row of bare values per row selected, no rows is still a success
+                virtual bool on_get_values(AggregateRows &results, const std::string &query, const StatementValues &values, const DataTypes &types) = 0;
+                static AggregateRow create_values(const DataTypes &types);
                 virtual IColumnSPtr on_clone_column(const Column &column) const = 0;
-                virtual std::string build_select(const QueryOptions &options);
-                virtual std::string build_insert(const IRowSPtr &pRow) const;
-                virtual std::string build_update(const IRowSPtr &pRow, const QueryOptions &options) const;
+                virtual bool on_load_columns(ColumnDetails &columns) const = 0;
+
+                // filter is the where clause picking the row, values hold what it binds
+                virtual IBlobStreamSPtr on_read_blob(const std::string &column_name, const std::string &filter, const StatementValues &values) = 0;
+                virtual IBlobStreamSPtr on_write_blob(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t size) = 0;
+                bool is_blob_column(const std::string &column_name) const;
+
+                // bulk moves, by default a scan out and batched inserts in with no file support
+                virtual bool on_export_rows(const std::string &file_name, BulkFormat format) { return false; }
+                virtual bool on_export_rows(RowCallback callback);
+                virtual bool on_import_rows(const std::string &file_name, BulkFormat format) { return false; }
+                virtual bool on_import_rows(RowSource source, uint32_t batch_size);
+                virtual std::string build_select(const QueryOptions &options, StatementValues &values, const Projection &projection);
+                bool resolve_projection(const ColumnNames &columns, Projection &projection) const;
+                bool build_page_options(const PageToken &token, uint32_t page_size, PageOrder order, const QueryOptions &options,
+                                        const Projection &key, QueryOptions &page_options) const;
+                virtual std::string build_insert(const IRowSPtr &pRow, StatementValues &values) const;
+                std::string build_insert_columns(const IRowSPtr &pRow) const;
+                std::string build_insert_values(const IRowSPtr &pRow, StatementValues &values) const;
+                bool is_insert_column(const IColumnSPtr &pColumn) const;
+                virtual std::string build_update(const IRowSPtr &pRow, const QueryOptions &options, StatementValues &values) const;
 
             private:
-                std::string m_table_name;
-                Columns     m_columns;
+                void add_columns(const ColumnDetails &columns) const;
+
+                bool build_filter(std::stringstream &output, const QueryOptions &options, StatementValues &values) const;
+                bool build_groups(std::stringstream &output, const nlohmann::json &groups, const std::string &conjunction, StatementValues &values) const;
+                bool build_condition(std::stringstream &output, const std::string &name, const nlohmann::json &condition, StatementValues &values) const;
+                bool build_comparison(std::stringstream &output, const std::string &name, const std::string &op, const nlohmann::json &operand, StatementValues &values) const;
+                bool parse_order_term(const std::string &term, std::string &column, std::string &direction) const;
+                bool resolve_column(const std::string &name, std::string &column) const;
+                bool build_aggregate(std::stringstream &output, const Aggregate &aggregate, DataType &type) const;
+
+                // templates only apply when values are bound, spliced values change the text every call
+                bool get_insert_template(const IRowSPtr &pRow, StatementTemplate &statement) const;
+                bool get_update_template(const IRowSPtr &pRow, StatementTemplate &statement) const;
+                bool get_select_template(const QueryOptions &options, StatementTemplate &statement) const;
+                void save_template(StatementTemplates &templates, StatementTemplate &statement) const;
+                std::string build_insert_values_text(const IRowSPtr &pRow, StatementValues &values) const;
+                std::string build_update_set(const IRowSPtr &pRow, StatementValues &values, IColumnSPtr &pKeyColumn) const;
+                std::string build_key_filter(const IColumnSPtr &pKeyColumn, StatementValues &values) const;
+                void collect_insert_values(const IRowSPtr &pRow, StatementValues &values) const;
+                IColumnSPtr collect_update_values(const IRowSPtr &pRow, StatementValues &values) const;
+
+                std::string                 m_table_name;
+
+                // resolved on first use when the table was only named, see get_columns
+                mutable Columns             m_columns;
+                mutable std::atomic<bool>   m_columns_loaded{false};
+                mutable std::mutex          m_column_lock;
+
+                mutable StatementTemplates  m_insert_templates;
+                mutable StatementTemplates  m_update_templates;
+                mutable StatementTemplates  m_select_templates;
+                mutable std::mutex          m_template_lock;
         };
+
+        using TableConstSPtr = std::shared_ptr<const Table>;
     }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+/**
+ * Transaction.h
+ * 
+ * @brief - transaction scopes over a leased connection, nested scopes become savepoints
+ */
+
+#ifndef _H_TRANSACTION
+#define _H_TRANSACTION
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ITransaction.h"
+
+namespace afm {
+    namespace database {
+
+        /**
+         * A connection able to carry a transaction.  The first scope opened on it begins the
+         * transaction and any scope opened inside that is a savepoint, so internal batches
+         * such as createMany nest inside whatever the caller already has open.  Scopes are
+         * numbered by depth from 1, ending one also ends every scope opened inside it.
+         *
+         * A connection is only ever used by the thread holding its lease, so none of this
+         * is locked.
+         */
+        class TransactionConnection
+        {
+            public:
+                virtual ~TransactionConnection() {}
+
+                // the depth of the new scope, 0 when it could not be opened.  Read only is up to the
+                // transaction itself, a savepoint inside one is whatever the transaction is
+                uint32_t beginScope(bool read_only = false);
+                bool commitScope(uint32_t depth);
+                bool rollbackScope(uint32_t depth);
+
+                bool inTransaction() const { return m_scopes.size() > 0; }
+                uint32_t getDepth() const { return m_scopes.size(); }
+
+                // tells apart scopes opened at the same depth one after the other, 0 once it has ended
+                uint64_t getScope(uint32_t depth) const;
+
+            protected:
+                virtual bool on_begin(bool read_only) = 0;
+                virtual bool on_commit() = 0;
+                virtual bool on_rollback() = 0;
+                virtual bool on_execute(const std::string &command) = 0;
+
+                // for a connection dropping its transaction outside of the scopes
+                void reset_scopes() { m_scopes.clear(); }
+
+            private:
+                std::string get_savepoint(uint32_t depth) const;
+
+                std::vector<uint64_t>   m_scopes;
+                uint64_t                m_next_scope = 1;
+        };
+
+        using TransactionConnectionSPtr = std::shared_ptr<TransactionConnection>;
+
+        // holds the lease on its connection, so the thread's table calls share it until the scope ends
+        class Transaction : public ITransaction
+        {
+            public:
+                Transaction(TransactionConnectionSPtr pConnection);
+                virtual ~Transaction();
+
+                bool initialize(bool read_only = false);
+
+                virtual bool commit() final;
+                virtual bool rollback() final;
+                virtual bool isActive() const final;
+
+            private:
+                TransactionConnectionSPtr   m_pConnection = nullptr;
+                uint32_t                    m_depth = 0;
+                uint64_t                    m_scope = 0;
+        };
+    }
+}
+#endif
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <ctime> 
+#include <nlohmann/json.hpp>
 
 #include "IVariableData.h"
 
@@ -99,6 +100,8 @@ namespace afm {
                 static const uint32_t sc_max_file_size = std::numeric_limits<int32_t>::max();
 
             private:
+                bool set_binary(const uint8_t *pValue, uint64_t length);
+
                 DataType    m_type = DataType::EndDataTypes;
                 uint64_t    m_length = 0;
                 uint64_t    m_max_length = sc_max_text_size;
@@ -114,7 +117,6 @@ namespace afm {
                     int32_t     s_doubleword;
                     uint64_t    quadword;
                     int64_t     s_quadword;
-                    float       decimal;
                     double      bigdecimal;
                     char        *varchar;
                     wchar_t     *wvarchar;
@@ -123,6 +125,12 @@ namespace afm {
                 };
                 variable_values m_values;        
         };
+
+        // builds a typed value from a json scalar, nullptr when there is no sensible mapping
+        IVariableDataSPtr createVariableData(const nlohmann::json &value);
+
+        // the reverse for numbers, bits and text, false for binary data which json has no form for
+        bool getJsonValue(const IVariableDataSPtr &pValue, nlohmann::json &value);
     }
 }
 #endif
\ No newline at end of file
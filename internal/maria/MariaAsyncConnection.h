@@ -0,0 +1,48 @@
+/**
+ * MariaAsyncConnection.h
+ * 
+ * @brief - MariaDB connection driven by the non blocking client api
+ */
+
+#ifndef _H_MARIA_ASYNC_CONNECTION
+#define _H_MARIA_ASYNC_CONNECTION
+
+#include <mariadb/mysql.h>
+
+#include "AsyncDriver.h"
+#include "Database.h"
+
+namespace afm {
+    namespace database {
+
+        class MariaAsyncConnection : public AsyncConnection
+        {
+            public:
+                MariaAsyncConnection();
+                virtual ~MariaAsyncConnection();
+
+                // the connection itself is made up front and blocks, only the queries are non blocking
+                bool initialize(const ConnectionDetails &details, uint32_t port, const std::string &database_name);
+
+                virtual int getSocket() const override { return mysql_get_socket(m_p_db); }
+                virtual uint32_t start(const std::string &query) override;
+                virtual uint32_t resume(uint32_t events) override;
+                virtual void getResult(QueryResult &result) override;
+
+            private:
+                enum class Phase {
+                    Idle,
+                    Query,
+                    Store
+                };
+
+                uint32_t advance(int status);
+
+                MYSQL       *m_p_db = nullptr;
+                MYSQL_RES   *m_pResults = nullptr;
+                Phase       m_phase = Phase::Idle;
+                int         m_error = 0;
+        };
+    }
+}
+#endif
@@ -0,0 +1,38 @@
+/**
+ * MariaBlobStream.h
+ * 
+ * @brief - MariaDB blob stream, chunked reads and long data writes
+ */
+
+#ifndef _H_MARIA_BLOB_STREAM
+#define _H_MARIA_BLOB_STREAM
+
+#include "BlobStream.h"
+#include "Table.h"
+#include "maria/MariaConnection.h"
+
+namespace afm {
+    namespace database {
+
+        class MariaBlobStream : public BlobStream
+        {
+            public:
+                MariaBlobStream(MariaConnectionSPtr pConnection, uint64_t size, bool is_writable);
+                virtual ~MariaBlobStream();
+
+                // the value is picked out by table, column and the where clause of the caller along with its values
+                bool initialize(const std::string &table_name, const std::string &column_name, const std::string &filter, const StatementValues &values);
+
+            protected:
+                virtual bool on_read(uint64_t offset, uint8_t *pBuffer, uint32_t length) override;
+                virtual bool on_write(uint64_t offset, const uint8_t *pData, uint32_t length) override;
+                virtual bool on_close(bool complete) override;
+
+            private:
+                MariaConnectionSPtr     m_pConnection = nullptr;
+                MariaStatementSPtr      m_pStatement = nullptr;
+                StatementValues         m_values;
+        };
+    }
+}
+#endif
@@ -0,0 +1,66 @@
+/**
+ * MariaConnection.h
+ *
+ * @brief - MariaDB connection along with the prepared statements made on it
+ */
+
+#ifndef _H_MARIA_CONNECTION
+#define _H_MARIA_CONNECTION
+
+#include <memory>
+#include <string>
+
+#include <mariadb/mysql.h>
+
+#include "ConnectionPool.h"
+#include "Database.h"
+#include "Transaction.h"
+#include "maria/MariaStatement.h"
+
+namespace afm {
+    namespace database {
+
+        /**
+         * Prepared statements only exist on the connection they were prepared on, so each
+         * pooled connection carries its own statement cache.
+         */
+        class MariaConnection : public TransactionConnection
+        {
+            public:
+                MariaConnection();
+                virtual ~MariaConnection();
+
+                // an empty database name connects without selecting one
+                bool initialize(const ConnectionDetails &details, uint32_t port, const std::string &database_name);
+
+                MYSQL *getHandle() const { return m_p_db; }
+                MariaStatementCacheSPtr getStatementCache() const { return m_pStatementCache; }
+
+                // reconnects are left to the pool, a connection that fails here is simply closed
+                bool isAlive();
+
+                // a statement without a result, anything it returns is thrown away
+                bool execute(const std::string &command);
+
+            protected:
+                virtual bool on_begin(bool read_only) override;
+                virtual bool on_commit() override;
+                virtual bool on_rollback() override;
+                virtual bool on_execute(const std::string &command) override { return execute(command); }
+
+            private:
+                MYSQL                   *m_p_db = nullptr;
+                MariaStatementCacheSPtr m_pStatementCache = nullptr;
+        };
+
+        using MariaConnectionSPtr = std::shared_ptr<MariaConnection>;
+        using MariaConnectionPool = ConnectionPool<MariaConnection>;
+        using MariaConnectionPoolSPtr = std::shared_ptr<MariaConnectionPool>;
+
+        // the connection a cursor reads through.  Unbuffered rows block every other command on their
+        // connection, so they only stream over a connection of the cursor's own, inside a transaction
+        // (or with none to spare) the thread's lease is used and buffered is set to read them up front
+        MariaConnectionSPtr acquireCursorConnection(const MariaConnectionPoolSPtr &pPool, bool &buffered);
+    }
+}
+#endif
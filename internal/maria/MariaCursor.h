@@ -0,0 +1,36 @@
+/**
+ * MariaCursor.h
+ * 
+ * @brief - Maria cursor over an unbuffered statement result
+ */
+
+#ifndef _H_MARIA_CURSOR
+#define _H_MARIA_CURSOR
+
+#include "Cursor.h"
+#include "maria/MariaConnection.h"
+
+namespace afm {
+    namespace database {
+
+        class MariaCursor : public Cursor
+        {
+            public:
+                MariaCursor(TableConstSPtr pTable, MariaConnectionSPtr pConnection, MariaStatementSPtr pStatement, const Projection &projection = Projection());
+
+                // over a query of its own, rows are shaped by the statement's result
+                MariaCursor(MariaConnectionSPtr pConnection, MariaStatementSPtr pStatement);
+                virtual ~MariaCursor();
+
+            protected:
+                virtual bool on_next(IRowSPtr &pRow) override;
+                virtual void on_close() override;
+                virtual IColumnSPtr on_create_column() const override;
+
+            private:
+                MariaConnectionSPtr     m_pConnection = nullptr;
+                MariaStatementSPtr      m_pStatement = nullptr;
+        };
+    }
+}
+#endif
@@ -10,6 +10,7 @@
 #include <mariadb/mysql.h>
 
 #include "Database.h"
+#include "maria/MariaConnection.h"
 
 namespace afm {
     namespace database {
@@ -20,6 +21,7 @@ namespace afm {
                 MariaDatabase();
                 virtual ~MariaDatabase();
 
+                using Database::initialize;
                 virtual bool initialize(const std::string &connection, const std::string &database_name) override;
 
                 virtual ITableSPtr getTable(const std::string &name) override;
@@ -31,13 +33,18 @@ namespace afm {
             protected:
                 virtual void load_tables() override;
                 virtual uint32_t get_default_port() const override { return m_port; }
-                bool select_database(const std::string &name);
-                bool create_database(const std::string &name);
+                bool select_database(MYSQL *p_db, const std::string &name);
+                bool create_database(MYSQL *p_db, const std::string &name);
                 virtual bool on_drop_table(const std::string &query) override;
+                virtual void on_query_batch(const std::vector<std::string> &queries, std::vector<QueryResult> &results) override;
+                virtual ICursorSPtr on_query(const std::string &query, const StatementValues &values) override;
+                virtual TransactionConnectionSPtr get_transaction_connection() override;
+                virtual bool get_schema_version(std::string &version) override;
+                virtual bool create_async_connections(uint32_t count, AsyncConnections &connections) override;
 
             private:
-                MYSQL     *m_p_db = nullptr;
-                uint32_t  m_port = 3306;
+                MariaConnectionPoolSPtr m_pPool = nullptr;
+                uint32_t                m_port = 3306;
         };
     }
 }
@@ -0,0 +1,96 @@
+/**
+ * MariaStatement.h
+ *
+ * @brief - MariaDB server side prepared statement and the per connection cache that holds them
+ */
+
+#ifndef _H_MARIA_STATEMENT
+#define _H_MARIA_STATEMENT
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mariadb/mysql.h>
+
+#include "IRow.h"
+#include "StatementCache.h"
+#include "Table.h"
+
+namespace afm {
+    namespace database {
+        static const std::size_t sc_default_maria_statement_cache_size = 32;
+
+        /**
+         * Parameters and results go over the binary protocol, each one is bound to a buffer
+         * of the native type for the DataType of the value it comes from or goes into.
+         * Text and binary buffers start small and grow to the largest value seen, they are
+         * kept with the statement so later executions reuse them.
+         */
+        class MariaStatement
+        {
+            public:
+                MariaStatement(MYSQL *p_db);
+                virtual ~MariaStatement();
+
+                bool initialize(const std::string &query);
+                const std::string &getQuery() const { return m_query; }
+
+                // the columns the result carries as the server describes them
+                void describe(ColumnDescriptions &columns) const { columns = m_columns; }
+
+                bool bind(const StatementValues &values);
+                bool sendLongData(uint32_t index, const uint8_t *pData, uint32_t length);
+
+                // buffered pulls the whole result over first, otherwise rows arrive as they are fetched
+                bool execute(bool buffered = true);
+                uint64_t getRowCount() const;
+                bool fetch(const IRowSPtr &pRow);
+                bool fetch(const StatementValues &values);
+
+                // after a fetch returns false, true when it failed rather than ran out of rows
+                bool fetchFailed() const { return m_fetch_failed; }
+                void reset();
+
+            private:
+                struct Buffer {
+                    union {
+                        int8_t  tiny;
+                        int16_t small;
+                        int32_t integer;
+                        int64_t big;
+                        float   single;
+                        double  real;
+                    } number;
+                    std::vector<char>   data;
+                    unsigned long       length = 0;
+                    my_bool             is_null = 0;
+                    my_bool             error = 0;
+                };
+
+                void bind_parameter(MYSQL_BIND &bind, Buffer &buffer, const IVariableDataSPtr &pValue);
+                bool bind_results(const StatementValues &values);
+                bool get_value(std::size_t index, const IVariableDataSPtr &pValue);
+
+                MYSQL                   *m_p_db = nullptr;
+                MYSQL_STMT              *m_p_statement = nullptr;
+                std::string             m_query;
+                uint32_t                m_field_count = 0;
+                std::vector<bool>       m_unsigned_fields;
+                ColumnDescriptions      m_columns;
+                std::vector<MYSQL_BIND> m_parameters;
+                std::vector<Buffer>     m_parameter_buffers;
+                std::vector<MYSQL_BIND> m_results;
+                std::vector<Buffer>     m_result_buffers;
+                std::vector<DataType>   m_result_types;
+                bool                    m_results_bound = false;
+                bool                    m_fetch_failed = false;
+        };
+
+        using MariaStatementSPtr = std::shared_ptr<MariaStatement>;
+
+        using MariaStatementCache = StatementCache<MariaStatement, MYSQL>;
+        using MariaStatementCacheSPtr = std::shared_ptr<MariaStatementCache>;
+    }
+}
+#endif
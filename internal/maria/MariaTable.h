@@ -11,6 +11,7 @@
 
 #include "Table.h"
 #include "Column.h"
+#include "maria/MariaConnection.h"
 
 namespace afm {
     namespace database {
@@ -18,24 +19,36 @@ namespace afm {
         class MariaTable : public Table
         {
             public:
-                MariaTable(MYSQL *p_db);
+                MariaTable(MariaConnectionPoolSPtr pPool);
                 virtual ~MariaTable();
 
-                virtual bool initialize(const std::string &table_name) override;
-                virtual bool get(IRowSPtr &pRow, const QueryOptions &options = sm_emptyOptions) override;
-                virtual bool get(Rows &rows, const QueryOptions &options = sm_emptyOptions) override;
-
                 virtual IColumnSPtr createEmptyColumn() const override;
 
+                // column details for every table, or just the named ones, in a single query
+                static bool loadCatalog(MYSQL *p_db, CatalogDetails &catalog, const TableNames &tables = TableNames());
+
             protected:
-                virtual bool on_create_row(const std::string &query) override;
-                virtual bool on_update_row(const std::string &query) override;
-                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query) override;
-                virtual bool on_get_rows(Rows &rows, const std::string &query) override;
+                virtual bool uses_bound_values() const override { return true; }
+                // there is no limit all, the largest unsigned value stands in for it
+                virtual std::string get_unbounded_limit() const override { return "18446744073709551615"; }
+                virtual bool on_create_row(const std::string &query, const StatementValues &values) override;
+                virtual bool on_create_rows(const Rows &rows, uint32_t batch_size) override;
+                virtual bool on_update_row(const std::string &query, const StatementValues &values) override;
+                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query, const StatementValues &values) override;
+                virtual bool on_get_rows(Rows &rows, const std::string &query, const StatementValues &values, const Projection &projection) override;
+                virtual ICursorSPtr on_scan(const std::string &query, const StatementValues &values, const Projection &projection) override;
+                virtual bool on_get_values(AggregateRows &results, const std::string &query, const StatementValues &values, const DataTypes &types) override;
                 virtual IColumnSPtr on_clone_column(const Column &column) const override;
+                virtual bool on_load_columns(ColumnDetails &columns) const override;
+                virtual IBlobStreamSPtr on_read_blob(const std::string &column_name, const std::string &filter, const StatementValues &values) override;
+                virtual IBlobStreamSPtr on_write_blob(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t size) override;
+                bool execute(const MariaConnectionSPtr &pConnection, const std::string &query);
+                bool execute(const MariaConnectionSPtr &pConnection, const std::string &query, const StatementValues &values);
+                bool get_blob_size(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t &size);
 
             private:
-                MYSQL     *m_p_db;
+                // each call leases a connection for as long as it runs, a cursor or stream for as long as it is open
+                MariaConnectionPoolSPtr m_pPool = nullptr;
         };
     }
 }
@@ -10,12 +10,20 @@
 #include <string>
 #include <mariadb/mysql.h>
 
+#include "IDatabase.h"
 #include "IRow.h"
 
 namespace afm {
     namespace database {
         bool issueCommand(MYSQL *p_db, const std::string &command, MYSQL_RES **);
+        bool issueStreamingCommand(MYSQL *p_db, const std::string &command, MYSQL_RES **);
         std::size_t getRows(MYSQL_RES *pResults, RowData &data, char delimiter = 0, bool include_empty = false);
+
+        // decodes the next row straight into the columns of pRow, false once the rows are exhausted
+        bool fetchRow(MYSQL_RES *pResults, const IRowSPtr &pRow);
+
+        // text rows of a stored result, or the affected rows of a statement without one, frees the result
+        void getResult(MYSQL *p_db, MYSQL_RES *pResults, QueryResult &result);
     }
 }
 #endif
\ No newline at end of file
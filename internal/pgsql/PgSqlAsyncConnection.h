@@ -0,0 +1,46 @@
+/**
+ * PgSqlAsyncConnection.h
+ * 
+ * @brief - PgSQL connection driven by the libpq asynchronous command api
+ */
+
+#ifndef _H_PGSQL_ASYNC_CONNECTION
+#define _H_PGSQL_ASYNC_CONNECTION
+
+#include <libpq-fe.h>
+
+#include "AsyncDriver.h"
+
+namespace afm {
+    namespace database {
+
+        /**
+         * libpqxx has no non blocking interface so this talks to libpq directly on a
+         * connection of its own, opened with the same connection string.
+         */
+        class PgSqlAsyncConnection : public AsyncConnection
+        {
+            public:
+                PgSqlAsyncConnection();
+                virtual ~PgSqlAsyncConnection();
+
+                // the connection itself is made up front and blocks, only the queries are non blocking
+                bool initialize(const std::string &connection);
+
+                virtual int getSocket() const override { return PQsocket(m_pConnection); }
+                virtual uint32_t start(const std::string &query) override;
+                virtual uint32_t resume(uint32_t events) override;
+                virtual void getResult(QueryResult &result) override;
+
+            private:
+                uint32_t advance();
+                void clear_result();
+
+                PGconn      *m_pConnection = nullptr;
+                PGresult    *m_pResult = nullptr;
+                std::string m_error;
+                bool        m_flushing = false;
+        };
+    }
+}
+#endif
@@ -0,0 +1,46 @@
+/**
+ * PgSqlBlobStream.h
+ * 
+ * @brief - PostgreSQL blob stream over a bytea column in chunks
+ */
+
+#ifndef _H_PGSQL_BLOB_STREAM
+#define _H_PGSQL_BLOB_STREAM
+
+#include <memory>
+#include <pqxx/pqxx>
+
+#include "BlobStream.h"
+#include "Table.h"
+#include "pgsql/PgSqlSession.h"
+
+namespace afm {
+    namespace database {
+
+        class PgSqlBlobStream : public BlobStream
+        {
+            public:
+                PgSqlBlobStream(PgSqlSessionSPtr pSession, uint64_t size, bool is_writable);
+                virtual ~PgSqlBlobStream();
+
+                // the value is picked out by table, column and the where clause of the caller
+                bool initialize(const std::string &table_name, const std::string &column_name, const std::string &filter, const StatementValues &values);
+
+            protected:
+                virtual bool on_read(uint64_t offset, uint8_t *pBuffer, uint32_t length) override;
+                virtual bool on_write(uint64_t offset, const uint8_t *pData, uint32_t length) override;
+                virtual bool on_close(bool complete) override;
+
+            private:
+                PgSqlSessionSPtr            m_pSession = nullptr;
+                std::unique_ptr<pqxx::work> m_pWork = nullptr;
+                pqxx::transaction_base      *m_pTransaction = nullptr;
+                uint64_t                    m_user_id = 0;
+                std::string                 m_chunk_table;
+                std::string                 m_query;
+                StatementValues             m_values;
+                uint32_t                    m_chunk_count = 0;
+        };
+    }
+}
+#endif
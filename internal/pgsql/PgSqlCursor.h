@@ -0,0 +1,52 @@
+/**
+ * PgSqlCursor.h
+ * 
+ * @brief - Postgres server side cursor fetched in batches
+ */
+
+#ifndef _H_PGSQL_CURSOR
+#define _H_PGSQL_CURSOR
+
+#include <memory>
+#include <pqxx/pqxx>
+
+#include "Cursor.h"
+#include "Table.h"
+#include "pgsql/PgSqlSession.h"
+
+namespace afm {
+    namespace database {
+        static const uint32_t sc_cursor_fetch_size = 1000;
+
+        class PgSqlCursor : public Cursor
+        {
+            public:
+                PgSqlCursor(TableConstSPtr pTable, PgSqlSessionSPtr pSession, const Projection &projection = Projection(), uint32_t fetch_size = sc_cursor_fetch_size);
+
+                // over a query of its own, rows are shaped by its first batch
+                PgSqlCursor(PgSqlSessionSPtr pSession, uint32_t fetch_size = sc_cursor_fetch_size);
+                virtual ~PgSqlCursor();
+
+                bool initialize(const std::string &query, const StatementValues &values);
+
+            protected:
+                virtual bool on_next(IRowSPtr &pRow) override;
+                virtual void on_close() override;
+                virtual IColumnSPtr on_create_column() const override;
+
+            private:
+                bool fetch();
+
+                PgSqlSessionSPtr            m_pSession = nullptr;
+                std::unique_ptr<pqxx::work> m_pWork = nullptr;
+                pqxx::transaction_base      *m_pTransaction = nullptr;
+                uint64_t                    m_user_id = 0;
+                std::string                 m_name;
+                pqxx::result                m_results;
+                int                         m_position = 0;
+                uint32_t                    m_fetch_size = sc_cursor_fetch_size;
+                bool                        m_describe = false;
+        };
+    }
+}
+#endif
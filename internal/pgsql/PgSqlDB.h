@@ -10,6 +10,7 @@
 #include <pqxx/pqxx>
 
 #include "Database.h"
+#include "pgsql/PgSqlSession.h"
 
 namespace afm {
     namespace database {
@@ -20,6 +21,7 @@ namespace afm {
                 PgSqlDatabase();
                 virtual ~PgSqlDatabase();
 
+                using Database::initialize;
                 virtual bool initialize(const std::string &connection, const std::string &database_name) override;
 
                 virtual ITableSPtr getTable(const std::string &name) override;
@@ -35,10 +37,16 @@ namespace afm {
                 bool create_database(const std::string &name);
                 virtual std::string get_column_creation(IColumnSPtr &pColumn) const override;
                 virtual bool on_drop_table(const std::string &query) override;
+                virtual void on_query_batch(const std::vector<std::string> &queries, std::vector<QueryResult> &results) override;
+                virtual ICursorSPtr on_query(const std::string &query, const StatementValues &values) override;
+                virtual TransactionConnectionSPtr get_transaction_connection() override;
+                virtual bool get_schema_version(std::string &version) override;
+                virtual bool create_async_connections(uint32_t count, AsyncConnections &connections) override;
 
             private:
-                pqxx::connection    *m_pConnection = nullptr;
-                uint32_t            m_port = 5432;
+                PgSqlSessionPoolSPtr    m_pPool = nullptr;
+                std::string             m_connection_string;
+                uint32_t                m_port = 5432;
         };
     }
 }
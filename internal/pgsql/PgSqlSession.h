@@ -0,0 +1,129 @@
+/**
+ * PgSqlSession.h
+ * 
+ * @brief - PgSQL connection along with the execution mode its statements run in
+ */
+
+#ifndef _H_PGSQL_SESSION
+#define _H_PGSQL_SESSION
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <libpq-fe.h>
+#include <pqxx/pqxx>
+
+#include "ConnectionPool.h"
+#include "pgsql/PgSqlUtility.h"
+#include "Table.h"
+#include "Transaction.h"
+
+namespace afm {
+    namespace database {
+        static const std::size_t sc_default_pgsql_statement_cache_size = 64;
+
+        // closes a cursor or stream working inside the session's transaction
+        using TransactionUser = std::function<void()>;
+
+        enum class PgSqlSessionMode {
+            AutoCommit,     // every statement stands alone, nothing is wrapped in begin and commit
+            ReadSnapshot,   // a read only repeatable read transaction shared by every read until it ends
+            Write,          // a read write transaction held open across statements until committed
+            EndSessionModes
+        };
+
+        /**
+         * pqxx allows one transaction on a connection at a time, so the tables, cursors and
+         * streams all go through the session owning the connection they leased.  Outside of
+         * a snapshot or write transaction statements run through a nontransaction, a single
+         * statement is atomic on its own and needs no begin or commit around it.
+         *
+         * Statements with bound values are prepared on the connection once per sql text and
+         * kept in least recently used order, the oldest is deallocated once there are too many.
+         * They run through libpq on the connection pqxx owns, as pqxx only asks for text results.
+         * A statement whose result types all have a binary form we decode asks for binary.
+         *
+         * Transaction scopes open a write transaction, or a snapshot when read only, nested ones
+         * are savepoints within it.
+         */
+        class PgSqlSession : public TransactionConnection
+        {
+            public:
+                PgSqlSession(const std::string &connection_string, std::size_t statement_capacity = sc_default_pgsql_statement_cache_size);
+                virtual ~PgSqlSession();
+
+                bool initialize();
+
+                pqxx::connection *getConnection() const { return m_pConnection.get(); }
+
+                // for anything that needs a libpq connection of its own to the same database
+                const std::string &getConnectionString() const { return m_connection_string; }
+                PgSqlSessionMode getMode() const { return m_mode; }
+
+                // the open snapshot or write transaction, nullptr when in auto commit.  Anything holding on
+                // to it attaches so it is closed before the transaction ends, and detaches once closed
+                pqxx::transaction_base *getTransaction() const { return m_pTransaction.get(); }
+                uint64_t attach(TransactionUser close_user);
+                void detach(uint64_t user_id);
+
+                // only from auto commit, one has to end before another begins
+                bool begin(PgSqlSessionMode mode);
+                bool commit();
+                bool rollback();
+
+                bool execute(const std::string &query, pqxx::result &result);
+
+                // runs the prepared statement for the query, values fill its $n markers in order
+                bool execute(const std::string &query, const StatementValues &values, PgSqlResult &result);
+
+                // a round trip to the server, a session that fails is closed rather than reconnected
+                bool isAlive();
+
+            protected:
+                virtual bool on_begin(bool read_only) override { return begin((read_only == true) ? PgSqlSessionMode::ReadSnapshot : PgSqlSessionMode::Write); }
+                virtual bool on_commit() override { return commit(); }
+                virtual bool on_rollback() override { return rollback(); }
+                virtual bool on_execute(const std::string &command) override;
+
+            private:
+                struct PreparedStatement {
+                    std::string query;
+                    std::string name;
+                    int         result_format = 0;
+                };
+
+                using StatementList = std::list<PreparedStatement>;
+                using StatementMap = std::unordered_map<std::string, StatementList::iterator>;
+
+                bool prepare(const std::string &query, PreparedStatement &statement);
+                void close_users();
+
+                std::unique_ptr<pqxx::connection>       m_pConnection = nullptr;
+                PGconn                                  *m_pRawConnection = nullptr;   // owned by m_pConnection
+                std::string                             m_connection_string;
+                std::unique_ptr<pqxx::transaction_base> m_pTransaction = nullptr;
+                PgSqlSessionMode                        m_mode = PgSqlSessionMode::AutoCommit;
+                std::size_t                             m_statement_capacity = sc_default_pgsql_statement_cache_size;
+                uint64_t                                m_statement_id = 0;
+                StatementList                           m_statements;
+                StatementMap                            m_lookup;
+                std::map<uint64_t, TransactionUser>     m_users;
+                uint64_t                                m_user_id = 0;
+        };
+
+        using PgSqlSessionSPtr = std::shared_ptr<PgSqlSession>;
+        using PgSqlSessionPool = ConnectionPool<PgSqlSession>;
+        using PgSqlSessionPoolSPtr = std::shared_ptr<PgSqlSessionPool>;
+
+        // the session a cursor or stream works through.  Inside the thread's transaction it is the lease,
+        // otherwise one of its own as the transaction it opens would clash with the thread's other calls.
+        // nullptr when the thread holds the last session itself
+        PgSqlSessionSPtr acquireCursorSession(const PgSqlSessionPoolSPtr &pPool);
+    }
+}
+#endif
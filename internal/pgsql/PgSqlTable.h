@@ -7,10 +7,12 @@
 #ifndef _H_PGSQL_TABLE
 #define _H_PGSQL_TABLE
 
+#include <libpq-fe.h>
 #include <pqxx/pqxx>
 
 #include "Table.h"
 #include "Column.h"
+#include "pgsql/PgSqlSession.h"
 
 namespace afm {
     namespace database {
@@ -18,22 +20,46 @@ namespace afm {
         class PgSqlTable : public Table
         {
             public:
-                PgSqlTable(pqxx::connection *pConnection);
+                PgSqlTable(PgSqlSessionPoolSPtr pPool, const std::string &connection_string);
                 virtual ~PgSqlTable();
 
-                virtual bool initialize(const std::string &table_name) override;
 
                 virtual IColumnSPtr createEmptyColumn() const override;
 
+                // column details for every table, or just the named ones, in a single query
+                static bool loadCatalog(PgSqlSessionSPtr pSession, CatalogDetails &catalog, const TableNames &tables = TableNames());
+
             protected:
-                virtual bool on_create_row(const std::string &query) override;
-                virtual bool on_update_row(const std::string &query) override;
-                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query) override;
-                virtual bool on_get_rows(Rows &rows, const std::string &query) override;
+                virtual bool uses_bound_values() const override { return true; }
+                virtual std::string get_parameter_marker(std::size_t index) const override { return "$" + std::to_string(index); }
+                virtual std::string get_unbounded_limit() const override { return "all"; }
+                virtual bool on_create_row(const std::string &query, const StatementValues &values) override;
+                virtual bool on_create_rows(const Rows &rows, uint32_t batch_size) override;
+                virtual bool on_update_row(const std::string &query, const StatementValues &values) override;
+                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query, const StatementValues &values) override;
+                virtual bool on_get_rows(Rows &rows, const std::string &query, const StatementValues &values, const Projection &projection) override;
+                virtual ICursorSPtr on_scan(const std::string &query, const StatementValues &values, const Projection &projection) override;
+                virtual bool on_get_values(AggregateRows &results, const std::string &query, const StatementValues &values, const DataTypes &types) override;
                 virtual IColumnSPtr on_clone_column(const Column &column) const override;
+                virtual bool on_load_columns(ColumnDetails &columns) const override;
+                virtual IBlobStreamSPtr on_read_blob(const std::string &column_name, const std::string &filter, const StatementValues &values) override;
+                virtual IBlobStreamSPtr on_write_blob(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t size) override;
+                bool get_blob_size(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t &size);
+
+                // copy to stdout and from stdin, files over a libpq connection of their own and rows through the session
+                virtual bool on_export_rows(const std::string &file_name, BulkFormat format) override;
+                virtual bool on_export_rows(RowCallback callback) override;
+                virtual bool on_import_rows(const std::string &file_name, BulkFormat format) override;
+                virtual bool on_import_rows(RowSource source, uint32_t batch_size) override;
+                bool copy_rows(RowSource source, uint32_t batch_size);
+                bool can_copy() const;
+                PGconn *start_copy(const std::string &command, BulkFormat format, ExecStatusType expected) const;
+                bool finish_copy(PGconn *pConnection) const;
 
             private:
-                pqxx::connection    *m_pConnection = nullptr;
+                // each call leases a session for as long as it runs, a cursor or stream for as long as it is open
+                PgSqlSessionPoolSPtr    m_pPool = nullptr;
+                std::string             m_connection_string;
         };
     }
 }
@@ -7,14 +7,67 @@
 #ifndef _H_PGSQL_UTILITY
 #define _H_PGSQL_UTILITY
 
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include <libpq-fe.h>
 #include <pqxx/pqxx>
 #include <pqxx/result.hxx>
 
+#include "IDatabase.h"
+#include "IRow.h"
+#include "Table.h"
+
 namespace afm {
     namespace database {
+        // libpq's format code for a binary parameter or result
+        static const int sc_pgsql_binary_format = 1;
+
+        struct PgSqlResultDeleter {
+            void operator()(PGresult *pResult) const { PQclear(pResult); }
+        };
+
+        // a libpq result, for the statements run outside of pqxx so their results can come back binary
+        using PgSqlResult = std::unique_ptr<PGresult, PgSqlResultDeleter>;
+
+        // libpq's parameter arrays for the $n markers, bytea goes across binary and the rest as text
+        struct PgSqlParameters {
+            std::vector<std::string>    data;
+            std::vector<const char *>   values;
+            std::vector<int>            lengths;
+            std::vector<int>            formats;
+        };
+
         bool issueCommand(pqxx::connection *pConnection, const std::string &command, pqxx::result &result);
+
+        // text rows of a result along with its affected rows
+        void getResult(const pqxx::result &source, QueryResult &result);
+
+        // typed parameters for the $n markers of a statement, in marker order
+        pqxx::params getParameters(const StatementValues &values);
+        void getParameters(const StatementValues &values, PgSqlParameters &parameters);
+
+        // true when every field of a described statement has a binary form we decode
+        bool hasBinaryResults(const PGresult *pDescription);
+
+        // a field parsed into the native type of the value, NULL leaves the value untouched.  pqxx only
+        // hands back text format results, the libpq overloads below decode the binary ones
+        bool getValue(const pqxx::field &field, const IVariableDataSPtr &pValue);
+        bool getValue(const PGresult *pResult, int row, int column, const IVariableDataSPtr &pValue);
+
+        // the same from the raw text, as a result field or a copy column, bytea in hex or escape form
+        bool getValue(const char *pText, std::size_t length, const IVariableDataSPtr &pValue);
+
+        // text form of a value for a copy column, nullopt for NULL
+        std::optional<std::string> getText(const IVariableDataSPtr &pValue);
+        bool decodeBytea(const char *pText, std::size_t length, BinaryBlob &value);
+        bool getRow(const pqxx::row &source, const IRowSPtr &pRow);
+        bool getRow(const PGresult *pResult, int row, const IRowSPtr &pRow);
+
+        // the columns of a result named and typed from its type oids, anything unknown is text
+        void describe(const pqxx::result &source, ColumnDescriptions &columns);
     }
 }
 #endif
\ No newline at end of file
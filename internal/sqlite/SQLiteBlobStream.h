@@ -0,0 +1,40 @@
+/**
+ * SQLiteBlobStream.h
+ * 
+ * @brief - SQLite blob stream over the incremental blob api
+ */
+
+#ifndef _H_SQLITE_BLOB_STREAM
+#define _H_SQLITE_BLOB_STREAM
+
+#include <vector>
+
+#include "BlobStream.h"
+#include "sqlite/SQLiteConnection.h"
+
+namespace afm {
+    namespace database {
+
+        class SQLiteBlobStream : public BlobStream
+        {
+            public:
+                // a write ends the transaction scope it was opened in as it closes
+                SQLiteBlobStream(SQLiteConnectionSPtr pConnection, uint64_t size, bool is_writable, uint32_t scope = 0);
+                virtual ~SQLiteBlobStream();
+
+                // opens the value on each handle, a write through replica has the file as a second one
+                bool initialize(const std::string &table_name, const std::string &column_name, int64_t row_id, const std::vector<sqlite3 *> &handles);
+
+            protected:
+                virtual bool on_read(uint64_t offset, uint8_t *pBuffer, uint32_t length) override;
+                virtual bool on_write(uint64_t offset, const uint8_t *pData, uint32_t length) override;
+                virtual bool on_close(bool complete) override;
+
+            private:
+                SQLiteConnectionSPtr        m_pConnection = nullptr;
+                uint32_t                    m_scope = 0;
+                std::vector<sqlite3_blob *> m_blobs;
+        };
+    }
+}
+#endif
@@ -0,0 +1,76 @@
+/**
+ * SQLiteConnection.h
+ *
+ * @brief - a single sqlite3 handle along with its statement cache
+ */
+
+#ifndef _H_SQLITE_CONNECTION
+#define _H_SQLITE_CONNECTION
+
+#include <memory>
+#include <string>
+
+#include <sqlite3.h>
+
+#include "ConnectionPool.h"
+#include "Transaction.h"
+#include "sqlite/SQLiteStatement.h"
+
+namespace afm {
+    namespace database {
+
+        // per connection settings, zero leaves the sqlite default in place
+        struct SQLiteSettings {
+            std::string journal_mode = "wal";
+            std::string synchronous = "normal";
+            int64_t     mmap_size = 0;
+            int64_t     cache_size = 0;
+            uint32_t    busy_timeout = 5000;
+            uint32_t    read_connections = 4;
+            bool        read_uncommitted = false;
+        };
+
+        // a transaction begins immediate, so its writes never wait on a lock halfway through
+        class SQLiteConnection : public TransactionConnection
+        {
+            public:
+                SQLiteConnection();
+                virtual ~SQLiteConnection();
+
+                bool initialize(const std::string &file_name, bool read_only, const SQLiteSettings &settings);
+
+                sqlite3 *getHandle() const { return m_p_db; }
+                SQLiteStatementSPtr acquire(const std::string &query) { return m_pStatementCache->acquire(query); }
+                void release(SQLiteStatementSPtr &pStatement) { m_pStatementCache->release(pStatement); }
+
+                // writes made through these are repeated on the mirror, when there is one
+                void setMirror(std::shared_ptr<SQLiteConnection> pMirror) { m_pMirror = pMirror; }
+                std::shared_ptr<SQLiteConnection> getMirror() const { return m_pMirror; }
+                bool execute(const std::string &command);
+                bool execute(const std::string &query, const StatementValues &values);
+                bool mirror(const std::string &query, const StatementValues &values);
+
+                // any sql at all, rows come back in their text form
+                bool query(const std::string &query, QueryResult &result);
+
+            protected:
+                virtual bool on_begin(bool read_only) override;
+                virtual bool on_commit() override;
+                virtual bool on_rollback() override;
+                virtual bool on_execute(const std::string &command) override { return execute(command); }
+
+            private:
+                bool apply_pragma(const std::string &pragma, const std::string &value);
+                bool execute_statement(const std::string &query, const StatementValues &values);
+
+                sqlite3                             *m_p_db = nullptr;
+                SQLiteStatementCacheSPtr            m_pStatementCache = nullptr;
+                std::shared_ptr<SQLiteConnection>   m_pMirror = nullptr;
+        };
+
+        using SQLiteConnectionSPtr = std::shared_ptr<SQLiteConnection>;
+        using SQLiteConnectionPool = ConnectionPool<SQLiteConnection>;
+        using SQLiteConnectionPoolSPtr = std::shared_ptr<SQLiteConnectionPool>;
+    }
+}
+#endif
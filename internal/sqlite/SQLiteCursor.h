@@ -0,0 +1,40 @@
+/**
+ * SQLiteCursor.h
+ * 
+ * @brief - SQLite cursor stepping a prepared statement
+ */
+
+#ifndef _H_SQLITE_CURSOR
+#define _H_SQLITE_CURSOR
+
+#include "Cursor.h"
+#include "sqlite/SQLiteConnection.h"
+
+namespace afm {
+    namespace database {
+
+        class SQLiteCursor : public Cursor
+        {
+            public:
+                SQLiteCursor(TableConstSPtr pTable, SQLiteConnectionSPtr pConnection, SQLiteStatementSPtr pStatement, const Projection &projection = Projection());
+
+                // over a query of its own, no statement leaves it with no rows
+                SQLiteCursor(SQLiteConnectionSPtr pConnection, SQLiteStatementSPtr pStatement);
+                virtual ~SQLiteCursor();
+
+                // runs the query to its first row and describes the columns from it
+                bool initialize();
+
+            protected:
+                virtual bool on_next(IRowSPtr &pRow) override;
+                virtual void on_close() override;
+                virtual IColumnSPtr on_create_column() const override;
+
+            private:
+                SQLiteConnectionSPtr        m_pConnection = nullptr;
+                SQLiteStatementSPtr         m_pStatement = nullptr;
+                int                         m_pending = SQLITE_OK;
+        };
+    }
+}
+#endif
@@ -10,6 +10,8 @@
 #include <sqlite3.h>
 
 #include "Database.h"
+#include "sqlite/SQLiteConnection.h"
+#include "sqlite/SQLiteReplica.h"
 #include "sqlite/SQLiteTable.h"
 
 namespace afm {
@@ -21,6 +23,7 @@ namespace afm {
                 SQLiteDatabase();
                 virtual ~SQLiteDatabase();
 
+                using Database::initialize;
                 virtual bool initialize(const std::string &connection, const std::string &database_name) override;
 
                 virtual ITableSPtr getTable(const std::string &name) override;
@@ -29,12 +32,24 @@ namespace afm {
 
                 virtual bool test_database() override;
 
+                // writes an in memory replica back to its file, false when there is none
+                bool synchronize();
+
             protected:
                 virtual void load_tables() override;
                 virtual bool on_drop_table(const std::string &query) override;
+                virtual void on_query_batch(const std::vector<std::string> &queries, std::vector<QueryResult> &results) override;
+                virtual ICursorSPtr on_query(const std::string &query, const StatementValues &values) override;
+                virtual TransactionConnectionSPtr get_transaction_connection() override;
+                virtual bool get_schema_version(std::string &version) override;
+                void parse_settings(const DatabaseOptions &options);
 
             private:
-                sqlite3     *m_p_db = nullptr;
+                SQLiteSettings              m_settings;
+                SQLiteReplicaSettings       m_replica_settings;
+                SQLiteReplicaSPtr           m_pReplica = nullptr;
+                SQLiteConnectionPoolSPtr    m_pWriters = nullptr;
+                SQLiteConnectionPoolSPtr    m_pReaders = nullptr;
         };
     }
 }
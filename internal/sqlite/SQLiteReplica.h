@@ -0,0 +1,74 @@
+/**
+ * SQLiteReplica.h
+ *
+ * @brief - in memory copy of an sqlite database file
+ */
+
+#ifndef _H_SQLITE_REPLICA
+#define _H_SQLITE_REPLICA
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "sqlite/SQLiteConnection.h"
+
+namespace afm {
+    namespace database {
+
+        enum class SQLiteReplicaMode {
+            None,           // work on the file directly
+            Memory,         // writes only change the copy, unless it is synchronized
+            WriteThrough,   // writes change the copy and the file together
+            EndReplicaModes
+        };
+
+        struct SQLiteReplicaSettings {
+            SQLiteReplicaMode   mode = SQLiteReplicaMode::None;
+            uint32_t            sync_interval = 0; // seconds between copies back to the file, memory mode only
+        };
+
+        /**
+         * The file is copied with the online backup api into a shared cache memory database,
+         * every connection in the pools opens that copy instead of the file.  Write through
+         * hands the writer a connection to the file which repeats each write, otherwise the
+         * copy is only written back when synchronized.
+         */
+        class SQLiteReplica
+        {
+            public:
+                SQLiteReplica(const std::string &file_name, const SQLiteReplicaSettings &settings);
+                virtual ~SQLiteReplica();
+
+                bool initialize(SQLiteConnectionPoolSPtr pWriters, const SQLiteSettings &settings);
+
+                // name to open the copy by
+                const std::string &getMemoryName() const { return m_memory_name; }
+
+                // copies the memory database back over the file
+                bool synchronize();
+
+            private:
+                bool load_copy(sqlite3 *p_db);
+                bool open_file(bool read_only);
+                void sync_thread();
+
+                std::string                 m_file_name;
+                std::string                 m_memory_name;
+                SQLiteReplicaSettings       m_settings;
+                SQLiteSettings              m_connection_settings;
+                SQLiteConnectionPoolSPtr    m_pWriters = nullptr;
+                SQLiteConnectionSPtr        m_pFile = nullptr;
+                std::mutex                  m_sync_lock;
+                std::mutex                  m_thread_lock;
+                std::condition_variable     m_stop_signal;
+                std::thread                 m_sync_thread;
+                bool                        m_stopping = false;
+        };
+
+        using SQLiteReplicaSPtr = std::shared_ptr<SQLiteReplica>;
+    }
+}
+#endif
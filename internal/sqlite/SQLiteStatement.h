@@ -0,0 +1,59 @@
+/**
+ * SQLiteStatement.h
+ *
+ * @brief - SQLite prepared statement and the per connection cache that holds them
+ */
+
+#ifndef _H_SQLITE_STATEMENT
+#define _H_SQLITE_STATEMENT
+
+#include <memory>
+#include <string>
+
+#include <sqlite3.h>
+
+#include "IDatabase.h"
+#include "IRow.h"
+#include "StatementCache.h"
+#include "Table.h"
+
+namespace afm {
+    namespace database {
+        static const std::size_t sc_default_statement_cache_size = 32;
+
+        class SQLiteStatement
+        {
+            public:
+                SQLiteStatement(sqlite3 *p_db);
+                virtual ~SQLiteStatement();
+
+                bool initialize(const std::string &query);
+                const std::string &getQuery() const { return m_query; }
+
+                bool bind(const StatementValues &values);
+                bool bind(int index, const IVariableDataSPtr &pValue);
+                int step();
+                bool getRow(IRowSPtr &pRow) const;
+                bool getValue(int index, const IVariableDataSPtr &pValue) const;
+
+                // declared types where the column has one, otherwise the type of the value the last step left
+                bool describe(ColumnDescriptions &columns) const;
+                bool isReadOnly() const { return sqlite3_stmt_readonly(m_p_statement) != 0; }
+
+                // adds the current row to the result in its text form
+                void getResult(QueryResult &result) const;
+                void reset();
+
+            private:
+                sqlite3         *m_p_db = nullptr;
+                sqlite3_stmt    *m_p_statement = nullptr;
+                std::string     m_query;
+        };
+
+        using SQLiteStatementSPtr = std::shared_ptr<SQLiteStatement>;
+
+        using SQLiteStatementCache = StatementCache<SQLiteStatement, sqlite3>;
+        using SQLiteStatementCacheSPtr = std::shared_ptr<SQLiteStatementCache>;
+    }
+}
+#endif
@@ -12,6 +12,7 @@
 #include "Table.h"
 #include "sqlite/SQLiteUtility.h"
 #include "sqlite/SQLiteColumn.h"
+#include "sqlite/SQLiteConnection.h"
 
 namespace afm {
     namespace database {
@@ -19,22 +20,36 @@ namespace afm {
         class SQLiteTable : public Table
         {
             public:
-                SQLiteTable(sqlite3 *p_db);
+                SQLiteTable(SQLiteConnectionPoolSPtr pWriters, SQLiteConnectionPoolSPtr pReaders);
                 virtual ~SQLiteTable();
 
-                virtual bool initialize(const std::string &table_name) override;
 
                 virtual IColumnSPtr createEmptyColumn() const override;
 
+                // column details for every table, or just the named ones, in a single query
+                static bool loadCatalog(sqlite3 *p_db, CatalogDetails &catalog, const TableNames &tables = TableNames());
+
             protected:
-                virtual bool on_create_row(const std::string &query) override;
-                virtual bool on_update_row(const std::string &query) override;
-                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query) override;
-                virtual bool on_get_rows(Rows &rows, const std::string &query) override;
+                virtual bool uses_bound_values() const override { return true; }
+                virtual bool on_create_row(const std::string &query, const StatementValues &values) override;
+                virtual bool on_create_rows(const Rows &rows, uint32_t batch_size) override;
+                virtual bool on_update_row(const std::string &query, const StatementValues &values) override;
+                virtual bool on_get_row(IRowSPtr &pRow, const std::string &query, const StatementValues &values) override;
+                virtual bool on_get_rows(Rows &rows, const std::string &query, const StatementValues &values, const Projection &projection) override;
+                virtual ICursorSPtr on_scan(const std::string &query, const StatementValues &values, const Projection &projection) override;
+                virtual bool on_get_values(AggregateRows &results, const std::string &query, const StatementValues &values, const DataTypes &types) override;
                 virtual IColumnSPtr on_clone_column(const Column &column) const override;
+                virtual bool on_load_columns(ColumnDetails &columns) const override;
+                virtual IBlobStreamSPtr on_read_blob(const std::string &column_name, const std::string &filter, const StatementValues &values) override;
+                virtual IBlobStreamSPtr on_write_blob(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t size) override;
+                bool execute(const std::string &query, const StatementValues &values);
+                bool locate_blob(SQLiteConnectionSPtr &pConnection, const std::string &column_name, const std::string &filter, const StatementValues &values, int64_t &row_id, uint64_t &size);
+                SQLiteConnectionSPtr get_writer() const;
+                SQLiteConnectionSPtr get_reader() const;
 
             private:
-                sqlite3     *m_p_db = nullptr;
+                SQLiteConnectionPoolSPtr    m_pWriters = nullptr;
+                SQLiteConnectionPoolSPtr    m_pReaders = nullptr;
         };
     }
 }
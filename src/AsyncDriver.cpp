@@ -0,0 +1,254 @@
+/**
+ * AsyncDriver.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "AsyncDriver.h"
+
+namespace afm {
+    namespace database {
+        static const uint32_t sc_wakeup_index = UINT32_MAX;
+        static const int sc_max_events = 64;
+        static const std::string sc_driver_stopped = "async driver stopped";
+
+        AsyncDriver::AsyncDriver()
+            : m_stopping(false)
+        {
+
+        }
+
+        AsyncDriver::~AsyncDriver()
+        {
+            if (m_thread.joinable() == true) {
+                m_stopping = true;
+                wake();
+                m_thread.join();
+            }
+
+            // anything still queued or in flight is told it will not complete
+            fail_all(sc_driver_stopped);
+
+            if (m_wakeup >= 0) {
+                close(m_wakeup);
+                m_wakeup = -1;
+            }
+            if (m_epoll >= 0) {
+                close(m_epoll);
+                m_epoll = -1;
+            }
+            m_slots.clear();
+        }
+
+        bool AsyncDriver::initialize(const AsyncConnections &connections)
+        {
+            bool success = false;
+
+            m_epoll = epoll_create1(EPOLL_CLOEXEC);
+            m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+            if ((m_epoll >= 0) && (m_wakeup >= 0) && (connections.size() > 0)) {
+                struct epoll_event event;
+
+                event.events = EPOLLIN;
+                event.data.u32 = sc_wakeup_index;
+                success = (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event) == 0);
+
+                for (auto pConnection : connections) {
+                    // registered quiet, a socket is only watched while it carries a query
+                    event.events = 0;
+                    event.data.u32 = m_slots.size();
+
+                    if ((success == true) && (pConnection->getSocket() >= 0) &&
+                        (epoll_ctl(m_epoll, EPOLL_CTL_ADD, pConnection->getSocket(), &event) == 0)) {
+                        Slot slot;
+
+                        slot.pConnection = pConnection;
+                        m_slots.push_back(slot);
+                    } else {
+                        success = false;
+                    }
+                }
+
+                if (success == true) {
+                    m_thread = std::thread(&AsyncDriver::event_loop, this);
+                }
+            }
+
+            return success;
+        }
+
+        bool AsyncDriver::submit(const std::string &query, QueryCallback callback)
+        {
+            bool success = false;
+
+            if ((m_thread.joinable() == true) && (m_stopping == false)) {
+                uint64_t id = 0;
+
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+
+                    id = ++m_next_id;
+                    m_pending.push_back({id, query, callback});
+                }
+
+                if (wake() == true) {
+                    success = true;
+                } else {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    std::deque<PendingQuery>::iterator entry = std::find_if(m_pending.begin(), m_pending.end(),
+                        [id](const PendingQuery &pending) { return pending.id == id; });
+
+                    // taken back while still queued, once the loop has it the callback reports how it went
+                    if (entry != m_pending.end()) {
+                        m_pending.erase(entry);
+                    } else {
+                        success = true;
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        bool AsyncDriver::wake()
+        {
+            uint64_t wakeup = 1;
+            ssize_t written = 0;
+
+            do {
+                written = write(m_wakeup, &wakeup, sizeof(wakeup));
+            } while ((written < 0) && (errno == EINTR));
+
+            // a counter too full to add to is already waking the loop
+            return (written == sizeof(wakeup)) || ((written < 0) && (errno == EAGAIN));
+        }
+
+        void AsyncDriver::event_loop()
+        {
+            struct epoll_event events[sc_max_events];
+
+            while (m_stopping == false) {
+                int count = epoll_wait(m_epoll, events, sc_max_events, -1);
+
+                for (int index = 0; index < count; index++) {
+                    if (events[index].data.u32 == sc_wakeup_index) {
+                        uint64_t wakeups = 0;
+
+                        // only there to wake the loop, the count is dropped.  A counter another read already
+                        // emptied fails with EAGAIN, which is just as good
+                        if (read(m_wakeup, &wakeups, sizeof(wakeups)) < 0) {
+                            wakeups = 0;
+                        }
+                    } else {
+                        advance(events[index].data.u32, events[index].events);
+                    }
+                }
+
+                if (m_stopping == false) {
+                    dispatch();
+                }
+            }
+        }
+
+        void AsyncDriver::dispatch()
+        {
+            for (uint32_t index = 0; index < m_slots.size(); index++) {
+                // a query completing as it starts frees the slot again with no socket event to come back
+                // for it, and the wakeups for the rest of the queue may have been folded into one
+                while (m_slots[index].busy == false) {
+                    PendingQuery next;
+
+                    {
+                        std::lock_guard<std::mutex> guard(m_lock);
+
+                        if (m_pending.empty() == true) {
+                            return;
+                        }
+                        next = m_pending.front();
+                        m_pending.pop_front();
+                    }
+
+                    m_slots[index].busy = true;
+                    m_slots[index].callback = next.callback;
+
+                    uint32_t events = m_slots[index].pConnection->start(next.query);
+
+                    if ((events == 0) || (watch(index, events) == false)) {
+                        complete(index);
+                    }
+                }
+            }
+        }
+
+        void AsyncDriver::advance(uint32_t index, uint32_t events)
+        {
+            if ((index < m_slots.size()) && (m_slots[index].busy == true)) {
+                uint32_t wait_events = m_slots[index].pConnection->resume(events);
+
+                if ((wait_events == 0) || (watch(index, wait_events) == false)) {
+                    complete(index);
+                }
+            }
+        }
+
+        void AsyncDriver::complete(uint32_t index)
+        {
+            Slot &slot = m_slots[index];
+            QueryResult result;
+            QueryCallback callback = slot.callback;
+
+            slot.pConnection->getResult(result);
+            slot.callback = nullptr;
+            slot.busy = false;
+            watch(index, 0);
+
+            if (callback != nullptr) {
+                callback(result);
+            }
+        }
+
+        bool AsyncDriver::watch(uint32_t index, uint32_t events)
+        {
+            struct epoll_event event;
+
+            event.events = events;
+            event.data.u32 = index;
+
+            return epoll_ctl(m_epoll, EPOLL_CTL_MOD, m_slots[index].pConnection->getSocket(), &event) == 0;
+        }
+
+        void AsyncDriver::fail_all(const std::string &error)
+        {
+            std::deque<PendingQuery> pending;
+            QueryResult result;
+
+            result.error = error;
+
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+
+                pending.swap(m_pending);
+            }
+
+            for (auto &slot : m_slots) {
+                if ((slot.busy == true) && (slot.callback != nullptr)) {
+                    slot.callback(result);
+                }
+                slot.callback = nullptr;
+                slot.busy = false;
+            }
+
+            for (auto &query : pending) {
+                if (query.callback != nullptr) {
+                    query.callback(result);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * BlobStream.cpp
+ */
+
+#include <algorithm>
+
+#include "BlobStream.h"
+
+namespace afm {
+    namespace database {
+
+        BlobStream::BlobStream(uint64_t size, bool is_writable)
+            : m_size(size)
+            , m_is_writable(is_writable)
+        {
+
+        }
+
+        BlobStream::~BlobStream()
+        {
+
+        }
+
+        bool BlobStream::read(BinaryBlob &chunk, uint32_t max_length)
+        {
+            bool success = false;
+
+            chunk.clear();
+
+            if ((m_is_open == true) && (m_is_writable == false)) {
+                uint32_t length = (uint32_t)std::min<uint64_t>(max_length, m_size - m_position);
+
+                if (length > 0) {
+                    chunk.resize(length);
+
+                    if (on_read(m_position, chunk.data(), length) == true) {
+                        m_position += length;
+                        success = true;
+                    } else {
+                        chunk.clear();
+                    }
+                }
+
+                if (success == false) {
+                    // exhausted or failed, either way we are done
+                    close();
+                }
+            }
+
+            return success;
+        }
+
+        bool BlobStream::write(const uint8_t *pData, uint32_t length)
+        {
+            bool success = false;
+
+            if ((m_is_open == true) && (m_is_writable == true) && (length <= (m_size - m_position))) {
+                if ((length == 0) || (on_write(m_position, pData, length) == true)) {
+                    m_position += length;
+                    success = true;
+                } else {
+                    // a failed write leaves a partial value, give it up now
+                    close();
+                }
+            }
+
+            return success;
+        }
+
+        bool BlobStream::close()
+        {
+            bool success = false;
+
+            if (m_is_open == true) {
+                m_is_open = false;
+                success = on_close((m_is_writable == true) && (m_position == m_size));
+
+                // an incomplete write is never a success, even if it was discarded cleanly
+                if ((m_is_writable == true) && (m_position != m_size)) {
+                    success = false;
+                }
+            }
+
+            return success;
+        }
+    }
+}
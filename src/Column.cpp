@@ -108,6 +108,58 @@ namespace afm {
             return success;
         }
 
+        bool Column::initialize(const ColumnDescription &description)
+        {
+            bool success = false;
+
+            if ((description.name.size() > 0) && (description.type != DataType::EndDataTypes)) {
+                IVariableDataSPtr pVariableData = std::make_shared<VariableData>();
+
+                pVariableData->initialize(description.type);
+                if (description.max_length > 0) {
+                    pVariableData->setMaxLength(description.max_length);
+                }
+                setValue(pVariableData);
+
+                m_name = description.name;
+                m_precision = description.precision;
+                m_isPrimary = (description.flags & sc_description_primary) != 0;
+                m_isKey = (description.flags & sc_description_key) != 0;
+                m_isUnique = (description.flags & sc_description_unique) != 0;
+                m_canBeNull = (description.flags & sc_description_null) != 0;
+                m_isAutoIncrement = (description.flags & sc_description_auto_increment) != 0;
+
+                success = true;
+            }
+
+            return success;
+        }
+
+        void Column::describe(ColumnDescription &description) const
+        {
+            description.name = m_name;
+            description.type = getType();
+            description.max_length = getMaxLength();
+            description.precision = m_precision;
+            description.flags = 0;
+
+            if (m_isPrimary == true) {
+                description.flags |= sc_description_primary;
+            }
+            if (m_isKey == true) {
+                description.flags |= sc_description_key;
+            }
+            if (m_isUnique == true) {
+                description.flags |= sc_description_unique;
+            }
+            if (m_canBeNull == true) {
+                description.flags |= sc_description_null;
+            }
+            if (m_isAutoIncrement == true) {
+                description.flags |= sc_description_auto_increment;
+            }
+        }
+
         DataType Column::getType() const
         {
             if (m_pValue != nullptr) {
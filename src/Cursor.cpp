@@ -0,0 +1,80 @@
+/**
+ * Cursor.cpp
+ */
+
+#include "Cursor.h"
+#include "Row.h"
+#include "Table.h"
+
+namespace afm {
+    namespace database {
+
+        Cursor::Cursor(TableConstSPtr pTable, const Projection &projection)
+            : m_pTable(pTable)
+            , m_projection(projection)
+        {
+
+        }
+
+        Cursor::Cursor()
+        {
+
+        }
+
+        Cursor::~Cursor()
+        {
+            m_pTable = nullptr;
+        }
+
+        bool Cursor::next(IRowSPtr &pRow)
+        {
+            bool success = false;
+
+            if (m_is_open == true) {
+                IRowSPtr pNewRow = (m_pTable != nullptr) ? m_pTable->createEmptyRow(m_projection) : create_row();
+
+                if ((pNewRow != nullptr) && (on_next(pNewRow) == true)) {
+                    pNewRow->clearDirtyFlag();
+                    pRow = pNewRow;
+                    success = true;
+                } else {
+                    if (pNewRow == nullptr) {
+                        set_failed();
+                    }
+
+                    // exhausted or failed, either way we are done
+                    close();
+                }
+            }
+
+            return success;
+        }
+
+        IRowSPtr Cursor::create_row() const
+        {
+            IRowSPtr pRow = std::make_shared<Row>();
+
+            for (auto &description : m_columns) {
+                std::shared_ptr<Column> pColumn = std::dynamic_pointer_cast<Column>(on_create_column());
+
+                if ((pColumn != nullptr) && (pColumn->initialize(description) == true)) {
+                    pRow->addColumn(pColumn);
+                } else {
+                    // a column we can't make, no row at all rather than one missing it
+                    pRow = nullptr;
+                    break;
+                }
+            }
+
+            return pRow;
+        }
+
+        void Cursor::close()
+        {
+            if (m_is_open == true) {
+                m_is_open = false;
+                on_close();
+            }
+        }
+    }
+}
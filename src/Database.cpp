@@ -2,12 +2,15 @@
  * Database.cpp
  */
 
+#include <algorithm>
 #include <sstream>
 
 #include "tools/tools.h"
 
 #include "Database.h"
 #include "Column.h"
+#include "Table.h"
+#include "VariableData.h"
 
 namespace afm {
     namespace database {
@@ -20,6 +23,20 @@ namespace afm {
         static const std::string sc_password = "pwd";
         static const std::string sc_port = "port";
         static const std::string sc_pipe = "pipe";
+        static const std::string sc_preload_tables = "preload_tables";
+        static const std::string sc_schema_cache = "schema_cache";
+        static const std::string sc_async_connections = "async_connections";
+        static const uint32_t sc_default_async_connections = 4;
+        static const std::string sc_min_connections = "min_connections";
+        static const std::string sc_max_connections = "max_connections";
+        static const std::string sc_idle_timeout = "idle_timeout";
+        static const std::string sc_health_check_interval = "health_check_interval";
+        static const uint32_t sc_default_min_connections = 1;
+        static const uint32_t sc_default_max_connections = 8;
+        static const uint32_t sc_default_idle_timeout = 300;
+        static const uint32_t sc_default_health_check_interval = 30;
+        static const std::string sc_async_unavailable = "no async connections available";
+        static const std::string sc_batch_not_run = "not run, an earlier query in the batch failed";
 
         const std::string sc_create_database = "create database %s";
         const std::string sc_database_table_drop = "drop table ";
@@ -37,9 +54,29 @@ namespace afm {
 
         Database::~Database()
         {
+            m_pAsyncDriver = nullptr;
             m_tables.clear();
         }
 
+        bool Database::initialize(const DatabaseOptions &options)
+        {
+            bool success = false;
+
+            if (options.find(sc_database_name) != options.end()) {
+                std::string connection;
+
+                if (options.find(sc_database_connection) != options.end()) {
+                    connection = options[sc_database_connection];
+                }
+
+                // kept for the backend to pick up its own settings during initialize
+                m_options = options;
+
+                success = initialize(connection, options[sc_database_name]);
+            }
+            return success;
+        }
+
         bool Database::initialize(const std::string &connection, const std::string &database_name)
         {
             bool success = false;
@@ -100,6 +137,116 @@ namespace afm {
             return success;
         }
 
+        bool Database::queryAsync(const std::string &query, QueryCallback callback)
+        {
+            bool success = false;
+            std::lock_guard<std::mutex> guard(m_async_lock);
+
+            // the connections are only opened once something is asked of them
+            if (m_pAsyncDriver == nullptr) {
+                uint32_t count = sc_default_async_connections;
+                AsyncConnections connections;
+
+                if (m_options.find(sc_async_connections) != m_options.end()) {
+                    count = m_options[sc_async_connections];
+                }
+
+                if ((count > 0) && (create_async_connections(count, connections) == true)) {
+                    AsyncDriverSPtr pDriver = std::make_shared<AsyncDriver>();
+
+                    if (pDriver->initialize(connections) == true) {
+                        m_pAsyncDriver = pDriver;
+                    }
+                }
+            }
+
+            if (m_pAsyncDriver != nullptr) {
+                success = m_pAsyncDriver->submit(query, callback);
+            }
+
+            return success;
+        }
+
+        std::future<QueryResult> Database::queryAsync(const std::string &query)
+        {
+            std::shared_ptr<std::promise<QueryResult>> pPromise = std::make_shared<std::promise<QueryResult>>();
+            std::future<QueryResult> result = pPromise->get_future();
+
+            if (queryAsync(query, [pPromise](const QueryResult &completed) { pPromise->set_value(completed); }) == false) {
+                QueryResult failed;
+
+                failed.error = sc_async_unavailable;
+                pPromise->set_value(failed);
+            }
+
+            return result;
+        }
+
+        ICursorSPtr Database::query(const std::string &query, const QueryParameters &parameters)
+        {
+            ICursorSPtr pCursor = nullptr;
+            StatementValues values;
+            bool success = (query.size() > 0) && ((parameters.is_null() == true) || (parameters.is_array() == true));
+
+            for (std::size_t index = 0; (success == true) && (index < parameters.size()); index++) {
+                // a null parameter goes to the backend as nullptr, which every binder binds as SQL NULL
+                if (parameters[index].is_null() == true) {
+                    values.push_back(nullptr);
+                } else {
+                    IVariableDataSPtr pValue = createVariableData(parameters[index]);
+
+                    success = (pValue != nullptr);
+                    values.push_back(pValue);
+                }
+            }
+
+            if (success == true) {
+                pCursor = on_query(query, values);
+            }
+
+            return pCursor;
+        }
+
+        bool Database::queryBatch(const std::vector<std::string> &queries, std::vector<QueryResult> &results)
+        {
+            bool success = true;
+
+            results.clear();
+            results.resize(queries.size());
+
+            if (queries.size() > 0) {
+                on_query_batch(queries, results);
+            }
+
+            // a batch stops at its first failure, whatever came after it never ran
+            for (auto &result : results) {
+                if (result.success == false) {
+                    if (result.error.size() == 0) {
+                        result.error = sc_batch_not_run;
+                    }
+                    success = false;
+                }
+            }
+
+            return success;
+        }
+
+        ITransactionSPtr Database::beginTransaction(bool read_only)
+        {
+            ITransactionSPtr pTransaction = nullptr;
+            TransactionConnectionSPtr pConnection = get_transaction_connection();
+
+            if (pConnection != nullptr) {
+                std::shared_ptr<Transaction> pScope = std::make_shared<Transaction>(pConnection);
+
+                if (pScope->initialize(read_only) == true) {
+                    pTransaction = pScope;
+                }
+            }
+
+            return pTransaction;
+        }
+
         std::string Database::build_table_create(ITableSPtr &pTable) const
         {
             std::stringstream query;
@@ -167,6 +314,108 @@ namespace afm {
             return "";
         }
 
+        // true when anything should be preloaded, an empty list of tables then means all of them
+        bool Database::get_preload_tables(const TableNames &available, TableNames &tables) const
+        {
+            bool preload = false;
+
+            tables.clear();
+
+            // the cache is written from a full catalog so everything has to be loaded
+            if (m_pSchemaCache != nullptr) {
+                preload = true;
+            } else if (m_options.find(sc_preload_tables) != m_options.end()) {
+                const DatabaseOptions &preload_option = m_options[sc_preload_tables];
+
+                if (preload_option.is_boolean() == true) {
+                    preload = preload_option.get<bool>();
+                } else if (preload_option.is_array() == true) {
+                    for (auto name : preload_option) {
+                        if ((name.is_string() == true) && (std::find(available.begin(), available.end(), name.get<std::string>()) != available.end())) {
+                            tables.push_back(name.get<std::string>());
+                        }
+                    }
+                    preload = (tables.size() > 0);
+                }
+            }
+
+            return preload;
+        }
+
+        ConnectionPoolSettings Database::get_pool_settings() const
+        {
+            ConnectionPoolSettings settings;
+
+            settings.min_connections = sc_default_min_connections;
+            settings.max_connections = sc_default_max_connections;
+            settings.idle_timeout = std::chrono::seconds(sc_default_idle_timeout);
+            settings.health_check_interval = std::chrono::seconds(sc_default_health_check_interval);
+
+            if (m_options.find(sc_min_connections) != m_options.end()) {
+                settings.min_connections = m_options[sc_min_connections];
+            }
+            if (m_options.find(sc_max_connections) != m_options.end()) {
+                settings.max_connections = m_options[sc_max_connections];
+            }
+            if (m_options.find(sc_idle_timeout) != m_options.end()) {
+                settings.idle_timeout = std::chrono::seconds(m_options[sc_idle_timeout].get<uint32_t>());
+            }
+            if (m_options.find(sc_health_check_interval) != m_options.end()) {
+                settings.health_check_interval = std::chrono::seconds(m_options[sc_health_check_interval].get<uint32_t>());
+            }
+
+            // at least one connection stays open, the one the database was opened with
+            if (settings.min_connections == 0) {
+                settings.min_connections = 1;
+            }
+            if (settings.max_connections < settings.min_connections) {
+                settings.max_connections = settings.min_connections;
+            }
+
+            return settings;
+        }
+
+        // true when the cache file is current, otherwise the caller loads the catalog and saves it
+        bool Database::load_schema_cache(CatalogDescriptions &catalog)
+        {
+            bool success = false;
+
+            if (m_options.find(sc_schema_cache) != m_options.end()) {
+                std::string version;
+
+                // the version is taken before the catalog is read so a change in between is caught next time
+                if (get_schema_version(version) == true) {
+                    m_schema_version = getName() + ":" + version;
+                    m_pSchemaCache = std::make_shared<SchemaCache>(m_options[sc_schema_cache]);
+
+                    success = m_pSchemaCache->load(m_schema_version, catalog);
+                }
+            }
+
+            return success;
+        }
+
+        void Database::save_schema_cache()
+        {
+            if (m_pSchemaCache != nullptr) {
+                CatalogDescriptions catalog;
+                bool success = true;
+
+                for (auto table : m_tables) {
+                    std::shared_ptr<Table> pTable = std::dynamic_pointer_cast<Table>(table);
+
+                    if ((pTable == nullptr) || (pTable->describe(catalog[pTable->getName()]) == false)) {
+                        success = false;
+                        break;
+                    }
+                }
+
+                if (success == true) {
+                    m_pSchemaCache->save(m_schema_version, catalog);
+                }
+            }
+        }
+
         std::string Database::get_column_creation(IColumnSPtr &pColumn) const
         {
             std::stringstream query;
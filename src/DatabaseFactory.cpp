@@ -15,7 +15,6 @@ namespace afm {
 
         // database types
         static const std::string sc_database_name = "name";
-        static const std::string sc_database_connection = "connection";
         static const std::string sc_database_type = "type";
 
         static const std::string sc_sqlite_db = "sqlite";
@@ -48,25 +47,40 @@ namespace afm {
             // What type and name?
             if ((options.find(sc_database_type) != options.end()) && (options.find(sc_database_name) != options.end())) {
                 std::string type = options[sc_database_type];
-                std::string connection;
                 DatabaseType database_type = DatabaseType::END_DATABASE_TYPES;
 
-                if (options.find(sc_database_connection) != options.end()) {
-                    connection = options[sc_database_connection];
-                }
-
                 auto database_iter = DatabaseMapping.find(type);
                 if (database_iter != DatabaseMapping.end()) {
                     database_type = database_iter->second;
                 }
 
-                pDatabase = createDatabase(connection, options[sc_database_name], database_type);
+                pDatabase = allocateDatabase(database_type);
+
+                if (pDatabase != nullptr) {
+                    // the full options go along so each backend can pick out its own settings
+                    if (pDatabase->initialize(options) == false) {
+                        pDatabase = nullptr;
+                    }
+                }
             }
 
             return pDatabase;
         }
 
         IDatabaseSPtr DatabaseFactory::createDatabase(const std::string &connection, const std::string &name, DatabaseType type)
+        {
+            IDatabaseSPtr pDatabase = allocateDatabase(type);
+
+            if (pDatabase != nullptr) {
+                // Initialize it and if it fails then get rid of it
+                if (pDatabase->initialize(connection, name) == false) {
+                    pDatabase = nullptr;
+                }
+            }
+            return pDatabase;
+        }
+
+        IDatabaseSPtr DatabaseFactory::allocateDatabase(DatabaseType type) const
         {
             IDatabaseSPtr pDatabase = nullptr;
 
@@ -93,12 +107,6 @@ namespace afm {
                 break;
             }
 
-            if (pDatabase != nullptr) {
-                // Initialize it and if it fails then get rid of it
-                if (pDatabase->initialize(connection, name) == false) {
-                    pDatabase = nullptr;
-                }
-            }
             return pDatabase;
         }
     } // namespace database
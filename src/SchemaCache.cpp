@@ -0,0 +1,227 @@
+/**
+ * SchemaCache.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SchemaCache.h"
+
+namespace afm {
+    namespace database {
+        static const char sc_schema_cache_magic[8] = {'A', 'F', 'M', 'S', 'C', 'H', 'M', 'A'};
+        static const uint32_t sc_schema_cache_format = 1;
+
+        // on disk layout, all records are fixed size and 8 byte aligned
+        struct SchemaCacheHeader {
+            char        magic[8];
+            uint32_t    format;
+            uint32_t    table_count;
+            uint32_t    column_count;
+            uint32_t    version_offset;
+            uint32_t    version_length;
+            uint32_t    strings_offset;
+            uint32_t    strings_length;
+            uint32_t    reserved;
+        };
+
+        struct SchemaCacheTable {
+            uint32_t    name_offset;
+            uint32_t    name_length;
+            uint32_t    first_column;
+            uint32_t    column_count;
+        };
+
+        struct SchemaCacheColumn {
+            uint64_t    max_length;
+            uint32_t    name_offset;
+            uint32_t    name_length;
+            uint8_t     type;
+            uint8_t     precision;
+            uint8_t     flags;
+            uint8_t     reserved[5];
+        };
+
+        static bool read_catalog(const uint8_t *pData, std::size_t size, const std::string &version, CatalogDescriptions &catalog);
+        static uint32_t add_string(std::string &strings, const std::string &value);
+
+        SchemaCache::SchemaCache(const std::string &file_name)
+            : m_file_name(file_name)
+        {
+
+        }
+
+        SchemaCache::~SchemaCache()
+        {
+
+        }
+
+        bool SchemaCache::load(const std::string &version, CatalogDescriptions &catalog) const
+        {
+            bool success = false;
+            int file = open(m_file_name.c_str(), O_RDONLY);
+
+            if (file >= 0) {
+                struct stat file_stat;
+
+                if ((fstat(file, &file_stat) == 0) && ((std::size_t)file_stat.st_size >= sizeof(SchemaCacheHeader))) {
+                    std::size_t size = file_stat.st_size;
+                    void *pMapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+                    if (pMapping != MAP_FAILED) {
+                        success = read_catalog((const uint8_t *)pMapping, size, version, catalog);
+                        munmap(pMapping, size);
+                    }
+                }
+                close(file);
+            }
+
+            return success;
+        }
+
+        bool SchemaCache::save(const std::string &version, const CatalogDescriptions &catalog) const
+        {
+            bool success = false;
+            SchemaCacheHeader header;
+            std::vector<SchemaCacheTable> tables;
+            std::vector<SchemaCacheColumn> columns;
+            std::string strings;
+
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, sc_schema_cache_magic, sizeof(header.magic));
+            header.format = sc_schema_cache_format;
+            header.version_length = version.size();
+            header.version_offset = add_string(strings, version);
+
+            for (auto table : catalog) {
+                SchemaCacheTable table_record;
+
+                table_record.name_length = table.first.size();
+                table_record.name_offset = add_string(strings, table.first);
+                table_record.first_column = columns.size();
+                table_record.column_count = table.second.size();
+
+                for (auto column : table.second) {
+                    SchemaCacheColumn column_record;
+
+                    memset(&column_record, 0, sizeof(column_record));
+                    column_record.max_length = column.max_length;
+                    column_record.name_length = column.name.size();
+                    column_record.name_offset = add_string(strings, column.name);
+                    column_record.type = (uint8_t)column.type;
+                    column_record.precision = column.precision;
+                    column_record.flags = column.flags;
+
+                    columns.push_back(column_record);
+                }
+                tables.push_back(table_record);
+            }
+
+            header.table_count = tables.size();
+            header.column_count = columns.size();
+            header.strings_offset = sizeof(header) + (tables.size() * sizeof(SchemaCacheTable)) + (columns.size() * sizeof(SchemaCacheColumn));
+            header.strings_length = strings.size();
+
+            // write it aside and move it into place so a reader never sees half a file
+            std::string temp_name = m_file_name + "." + std::to_string(getpid());
+            std::ofstream cache_file(temp_name, std::ios::binary | std::ios::trunc);
+
+            if (cache_file.is_open() == true) {
+                cache_file.write((const char *)&header, sizeof(header));
+                cache_file.write((const char *)tables.data(), tables.size() * sizeof(SchemaCacheTable));
+                cache_file.write((const char *)columns.data(), columns.size() * sizeof(SchemaCacheColumn));
+                cache_file.write(strings.data(), strings.size());
+                cache_file.close();
+
+                if (cache_file.fail() == false) {
+                    success = (rename(temp_name.c_str(), m_file_name.c_str()) == 0);
+                }
+                if (success == false) {
+                    remove(temp_name.c_str());
+                }
+            }
+
+            return success;
+        }
+
+        bool read_catalog(const uint8_t *pData, std::size_t size, const std::string &version, CatalogDescriptions &catalog)
+        {
+            bool success = false;
+            const SchemaCacheHeader *pHeader = (const SchemaCacheHeader *)pData;
+
+            if ((memcmp(pHeader->magic, sc_schema_cache_magic, sizeof(pHeader->magic)) == 0) && (pHeader->format == sc_schema_cache_format)) {
+                std::size_t tables_offset = sizeof(SchemaCacheHeader);
+                std::size_t columns_offset = tables_offset + ((std::size_t)pHeader->table_count * sizeof(SchemaCacheTable));
+                std::size_t strings_offset = columns_offset + ((std::size_t)pHeader->column_count * sizeof(SchemaCacheColumn));
+
+                // everything has to fit where the header says it is
+                if ((pHeader->strings_offset == strings_offset) &&
+                    ((strings_offset + pHeader->strings_length) <= size) &&
+                    (((std::size_t)pHeader->version_offset + pHeader->version_length) <= pHeader->strings_length)) {
+                    const char *pStrings = (const char *)(pData + strings_offset);
+
+                    if (version.compare(0, std::string::npos, pStrings + pHeader->version_offset, pHeader->version_length) == 0) {
+                        const SchemaCacheTable *pTables = (const SchemaCacheTable *)(pData + tables_offset);
+                        const SchemaCacheColumn *pColumns = (const SchemaCacheColumn *)(pData + columns_offset);
+
+                        success = true;
+
+                        for (uint32_t table_index = 0; (success == true) && (table_index < pHeader->table_count); table_index++) {
+                            const SchemaCacheTable &table = pTables[table_index];
+
+                            if ((((std::size_t)table.name_offset + table.name_length) <= pHeader->strings_length) &&
+                                (((std::size_t)table.first_column + table.column_count) <= pHeader->column_count)) {
+                                ColumnDescriptions &descriptions = catalog[std::string(pStrings + table.name_offset, table.name_length)];
+
+                                for (uint32_t column_index = 0; column_index < table.column_count; column_index++) {
+                                    const SchemaCacheColumn &column = pColumns[table.first_column + column_index];
+
+                                    if ((((std::size_t)column.name_offset + column.name_length) <= pHeader->strings_length) &&
+                                        (column.type < (uint8_t)DataType::EndDataTypes)) {
+                                        ColumnDescription description;
+
+                                        description.name.assign(pStrings + column.name_offset, column.name_length);
+                                        description.type = (DataType)column.type;
+                                        description.max_length = column.max_length;
+                                        description.precision = column.precision;
+                                        description.flags = column.flags;
+
+                                        descriptions.push_back(description);
+                                    } else {
+                                        success = false;
+                                        break;
+                                    }
+                                }
+                            } else {
+                                success = false;
+                            }
+                        }
+
+                        if (success == false) {
+                            catalog.clear();
+                        }
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        uint32_t add_string(std::string &strings, const std::string &value)
+        {
+            uint32_t offset = strings.size();
+
+            strings += value;
+
+            return offset;
+        }
+    }
+}
@@ -4,27 +4,150 @@
 
 #include <sstream>
 
+#include "tools/tools.h"
+
 #include "Row.h"
 #include "Table.h"
+#include "VariableData.h"
 
 namespace afm {
     namespace database {
         // should be common across different databases though the internal methods can be
         // overridden as desired.
         static const std::string sc_table_load = "select * from ";
+        static const std::string sc_select_start = "select ";
+        static const std::string sc_select_from = " from ";
         static const std::string sc_table_where_clause = " where ";
         static const std::string sc_table_and_clause = " and ";
+        static const std::string sc_table_or_clause = " or ";
+        static const std::string sc_order_by_clause = " order by ";
+        static const std::string sc_limit_clause = " limit ";
+        static const std::string sc_offset_clause = " offset ";
+        static const std::string sc_match_nothing = "1=0";
+        static const std::string sc_match_everything = "1=1";
+
+        // reserved query option keys, anything else names a column
+        static const char sc_reserved_prefix = '$';
+        static const std::string sc_or_groups = "$or";
+        static const std::string sc_and_groups = "$and";
+        static const std::string sc_order_by = "$order_by";
+        static const std::string sc_limit = "$limit";
+        static const std::string sc_offset = "$offset";
+
+        // condition operators
+        static const std::map<std::string, std::string> sc_comparisons = {
+            {"=", "="}, {"!=", "<>"}, {"<>", "<>"}, {"<", "<"}, {"<=", "<="}, {">", ">"}, {">=", ">="},
+            {"like", " like "}, {"not like", " not like "}
+        };
+        static const std::string sc_in = "in";
+        static const std::string sc_not_in = "not in";
+        static const std::string sc_between = "between";
+        static const std::string sc_not_between = "not between";
+        static const std::string sc_is_null = "is null";
+        static const std::string sc_group_by_clause = " group by ";
+        static const std::string sc_count_rows = "count(*)";
+        static const std::map<AggregateFunction, std::string> sc_aggregate_functions = {
+            {AggregateFunction::Count, "count"}, {AggregateFunction::Sum, "sum"}, {AggregateFunction::Minimum, "min"},
+            {AggregateFunction::Maximum, "max"}, {AggregateFunction::Average, "avg"}
+        };
+        static const std::string sc_ascending = "asc";
+        static const std::string sc_descending = "desc";
 
         static const std::string sc_insert_row_start = "insert into %s (";
-        static const std::string sc_insert_row_middle = ") values (";
+        static const std::string sc_insert_row_middle = ") values ";
+        static const std::string sc_insert_values_start = "(";
         static const std::string sc_insert_row_end = ")";
 
         static const std::string sc_update_row_start = "update %s set ";
 
+        // distinct column sets kept per statement kind, past this they are built each time
+        static const std::size_t sc_max_statement_templates = 16;
+
         // table schema
         static const std::string sc_table_name = "name";
         static const std::string sc_columns = "columns";
 
+        // a template matches on the names of the row columns in order, the caller holds the template lock
+        static bool find_template(const StatementTemplates &templates, const Columns &columns, StatementTemplate &statement)
+        {
+            bool found = false;
+
+            for (auto &entry : templates) {
+                if (entry.columns.size() == columns.size()) {
+                    found = true;
+                    for (std::size_t index = 0; (found == true) && (index < columns.size()); index++) {
+                        found = (entry.columns[index] == columns[index]->getName());
+                    }
+                    if (found == true) {
+                        statement.columns_text = entry.columns_text;
+                        statement.values_text = entry.values_text;
+                        statement.anonymous_markers = entry.anonymous_markers;
+                        break;
+                    }
+                }
+            }
+
+            return found;
+        }
+
+        // column=value for every option, nothing reserved, no operators and no nulls
+        static bool is_plain_filter(const QueryOptions &options)
+        {
+            bool success = (options.size() == 0) || (options.is_object() == true);
+
+            for (QueryOptions::const_iterator iter = options.begin(); (success == true) && (iter != options.end()); iter++) {
+                success = (iter.key()[0] != sc_reserved_prefix) && (iter.value().is_primitive() == true) && (iter.value().is_null() == false);
+            }
+
+            return success;
+        }
+
+        // limits and offsets are whole numbers, json keeps a literal 5 as signed
+        static bool is_count(const nlohmann::json &value)
+        {
+            return (value.is_number_integer() == true) && (value.get<int64_t>() >= 0);
+        }
+
+        // a null value leaves no marker behind, so a template can't take it
+        static bool all_values_bound(StatementValues &values, std::size_t first)
+        {
+            bool success = true;
+
+            for (std::size_t index = first; (success == true) && (index < values.size()); index++) {
+                success = (values[index] != nullptr);
+            }
+            if (success == false) {
+                values.resize(first);
+            }
+
+            return success;
+        }
+
+        // a select matches on the names it filters by, options iterate in key order
+        static bool find_template(const StatementTemplates &templates, const QueryOptions &options, StatementTemplate &statement)
+        {
+            bool found = false;
+
+            for (auto &entry : templates) {
+                if (entry.columns.size() == options.size()) {
+                    std::size_t index = 0;
+
+                    found = true;
+                    for (nlohmann::json::const_iterator iter = options.begin(); (found == true) && (iter != options.end()); iter++) {
+                        found = (entry.columns[index++] == iter.key());
+                    }
+                    if (found == true) {
+                        statement.columns_text = entry.columns_text;
+                        statement.values_text = entry.values_text;
+                        statement.anonymous_markers = entry.anonymous_markers;
+                        break;
+                    }
+                }
+            }
+
+            return found;
+        }
+
         Table::~Table()
         {
             m_columns.clear();
@@ -52,6 +175,7 @@ namespace afm {
                             break;
                         }
                     }
+                    m_columns_loaded = true;
                 }
             }
 
@@ -62,18 +186,79 @@ namespace afm {
         {
             bool success = true;
 
+            // only named for now, the columns are looked up on first use
             m_table_name = table_name;
 
             return success;
         }
 
+        bool Table::initialize(const std::string &table_name, const ColumnDetails &columns)
+        {
+            bool success = Table::initialize(table_name);
+
+            if (success == true) {
+                std::lock_guard<std::mutex> guard(m_column_lock);
+
+                m_columns.clear();
+                add_columns(columns);
+                m_columns_loaded = true;
+            }
+
+            return success;
+        }
+
+        bool Table::initialize(const std::string &table_name, const ColumnDescriptions &columns)
+        {
+            bool success = Table::initialize(table_name);
+
+            if (success == true) {
+                std::lock_guard<std::mutex> guard(m_column_lock);
+
+                m_columns.clear();
+                for (auto column : columns) {
+                    std::shared_ptr<Column> pColumn = std::dynamic_pointer_cast<Column>(createEmptyColumn());
+
+                    if ((pColumn != nullptr) && (pColumn->initialize(column) == true)) {
+                        m_columns.push_back(pColumn);
+                    }
+                }
+                m_columns_loaded = true;
+            }
+
+            return success;
+        }
+
+        bool Table::describe(ColumnDescriptions &columns) const
+        {
+            bool success = true;
+
+            columns.clear();
+
+            for (auto column : get_columns()) {
+                std::shared_ptr<Column> pColumn = std::dynamic_pointer_cast<Column>(column);
+
+                if (pColumn != nullptr) {
+                    ColumnDescription description;
+
+                    pColumn->describe(description);
+                    columns.push_back(description);
+                } else {
+                    success = false;
+                    break;
+                }
+            }
+
+            return success;
+        }
+
         bool Table::get(IRowSPtr &pRow, const QueryOptions &options)
         {
             bool success = false;
-            std::string query = build_select(options);
+            StatementValues values;
+            std::string query = build_select(options, values, Projection());
 
             if (query.size() > 0) {
-                success = on_get_row(pRow, query);
+                success = on_get_row(pRow, query, values);
             }
 
             return success;
@@ -86,7 +271,12 @@ namespace afm {
             // we will need to have the row tells us what needs to be done
             if (pRow->isDirty() == true) {
                 // we shouldn't just blindly write
-                success = on_update_row(build_update(pRow, options));
+                StatementValues values;
+                std::string query = build_update(pRow, options, values);
+
+                if (query.size() > 0) {
+                    success = on_update_row(query, values);
+                }
             }
 
             return success;
@@ -95,12 +285,33 @@ namespace afm {
         bool Table::get(Rows &rows, const QueryOptions &options)
         {
             bool success = false;
-            std::string query = build_select(options);
+            StatementValues values;
+            std::string query = build_select(options, values, Projection());
 
             rows.clear();
 
             if (query.size() > 0) {
-                success = on_get_rows(rows, query);
+                success = on_get_rows(rows, query, values, Projection());
+            }
+
+            return success;
+        }
+
+        bool Table::get(Rows &rows, const ColumnNames &columns, const QueryOptions &options)
+        {
+            bool success = false;
+            Projection projection;
+
+            rows.clear();
+
+            // positions are worked out once here, each row is then built and filled by position
+            if (resolve_projection(columns, projection) == true) {
+                StatementValues values;
+                std::string query = build_select(options, values, projection);
+
+                if (query.size() > 0) {
+                    success = on_get_rows(rows, query, values, projection);
+                }
             }
 
             return success;
@@ -108,7 +319,245 @@ namespace afm {
 
         bool Table::create(IRowSPtr &pRow)
         {
-            return on_create_row(build_insert(pRow));
+            StatementValues values;
+            std::string query = build_insert(pRow, values);
+
+            return on_create_row(query, values);
+        }
+
+        bool Table::createMany(const Rows &rows, uint32_t batch_size)
+        {
+            bool success = true;
+
+            if (rows.size() > 0) {
+                success = on_create_rows(rows, batch_size > 0 ? batch_size : sc_default_batch_size);
+            }
+
+            return success;
+        }
+
+        ICursorSPtr Table::scan(const QueryOptions &options)
+        {
+            ICursorSPtr pCursor = nullptr;
+            StatementValues values;
+            std::string query = build_select(options, values, Projection());
+
+            if (query.size() > 0) {
+                pCursor = on_scan(query, values, Projection());
+            }
+
+            return pCursor;
+        }
+
+        ICursorSPtr Table::scan(const ColumnNames &columns, const QueryOptions &options)
+        {
+            ICursorSPtr pCursor = nullptr;
+            Projection projection;
+
+            if (resolve_projection(columns, projection) == true) {
+                StatementValues values;
+                std::string query = build_select(options, values, projection);
+
+                if (query.size() > 0) {
+                    pCursor = on_scan(query, values, projection);
+                }
+            }
+
+            return pCursor;
+        }
+
+        bool Table::page(Rows &rows, PageToken &token, uint32_t page_size, PageOrder order, const QueryOptions &options, const ColumnNames &key)
+        {
+            bool success = false;
+            Projection key_columns;
+            QueryOptions page_options;
+
+            rows.clear();
+
+            if (key.size() > 0) {
+                // an unknown name leaves no key to page on
+                if (resolve_projection(key, key_columns) == false) {
+                    key_columns.clear();
+                }
+            } else {
+                // the primary key by default, in column order when there is more than one
+                const Columns &columns = get_columns();
+
+                for (std::size_t index = 0; index < columns.size(); index++) {
+                    if (columns[index]->isPrimary() == true) {
+                        key_columns.push_back(index);
+                    }
+                }
+            }
+
+            if ((page_size > 0) && (key_columns.size() > 0) &&
+                (build_page_options(token, page_size, order, options, key_columns, page_options) == true)) {
+                StatementValues values;
+                std::string query = build_select(page_options, values, Projection());
+
+                if (query.size() > 0) {
+                    // an empty page is still a success, a failure here is a failed read and not the end of the table
+                    success = on_get_rows(rows, query, values, Projection());
+                }
+            }
+
+            if (success == true) {
+                PageToken next = nullptr;
+
+                // a short page is the last one
+                if (rows.size() == page_size) {
+                    const Columns &last = rows.back()->getColumns();
+
+                    next = nlohmann::json::array();
+                    for (auto index : key_columns) {
+                        nlohmann::json value;
+
+                        success = (index < last.size()) && (getJsonValue(last[index]->getValue(), value) == true);
+                        if (success == false) {
+                            break;
+                        }
+                        next.push_back(value);
+                    }
+                }
+
+                if (success == true) {
+                    token = next;
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::aggregate(AggregateRows &results, const Aggregates &aggregates, const ColumnNames &group_by, const QueryOptions &options)
+        {
+            bool success = false;
+            Projection groups;
+
+            results.clear();
+
+            if ((aggregates.size() > 0) && (resolve_projection(group_by, groups) == true)) {
+                const Columns &columns = get_columns();
+                std::stringstream query_string;
+                std::stringstream group_string;
+                StatementValues values;
+                DataTypes types;
+
+                success = true;
+
+                // the grouping columns lead so each result says which group it is
+                query_string << sc_select_start;
+                for (std::size_t index = 0; index < groups.size(); index++) {
+                    const IColumnSPtr &pColumn = columns[groups[index]];
+
+                    group_string << (index > 0 ? "," : "") << pColumn->getName();
+                    types.push_back(pColumn->getType());
+                }
+                query_string << group_string.str();
+
+                for (auto &aggregate : aggregates) {
+                    DataType type = DataType::EndDataTypes;
+
+                    query_string << (types.size() > 0 ? "," : "");
+                    success = build_aggregate(query_string, aggregate, type);
+                    if (success == false) {
+                        break;
+                    }
+                    types.push_back(type);
+                }
+                query_string << sc_select_from << m_table_name;
+
+                if ((success == true) && (process_table_options(query_string, options, values) == true)) {
+                    if (groups.size() > 0) {
+                        query_string << sc_group_by_clause << group_string.str();
+                    }
+
+                    success = (process_query_modifiers(query_string, options) == true) &&
+                              (on_get_values(results, query_string.str(), values, types) == true);
+                } else {
+                    success = false;
+                }
+            }
+
+            return success;
+        }
+
+        IBlobStreamSPtr Table::readBlob(const std::string &column_name, const QueryOptions &options)
+        {
+            IBlobStreamSPtr pStream = nullptr;
+
+            // a stream covers exactly one value so the row has to be picked out
+            if ((options.size() > 0) && (is_blob_column(column_name) == true)) {
+                std::stringstream filter;
+                StatementValues values;
+
+                // a filter that picks nothing out would cover every row
+                if ((process_table_options(filter, options, values) == true) && (filter.str().size() > 0)) {
+                    pStream = on_read_blob(column_name, filter.str(), values);
+                }
+            }
+
+            return pStream;
+        }
+
+        IBlobStreamSPtr Table::writeBlob(const std::string &column_name, const QueryOptions &options, uint64_t size)
+        {
+            IBlobStreamSPtr pStream = nullptr;
+
+            if ((options.size() > 0) && (is_blob_column(column_name) == true)) {
+                std::stringstream filter;
+                StatementValues values;
+
+                // a filter that picks nothing out would cover every row
+                if ((process_table_options(filter, options, values) == true) && (filter.str().size() > 0)) {
+                    pStream = on_write_blob(column_name, filter.str(), values, size);
+                }
+            }
+
+            return pStream;
+        }
+
+        bool Table::exportRows(const std::string &file_name, BulkFormat format)
+        {
+            bool success = false;
+
+            if ((file_name.size() > 0) && (format != BulkFormat::EndBulkFormats)) {
+                success = on_export_rows(file_name, format);
+            }
+
+            return success;
+        }
+
+        bool Table::exportRows(RowCallback callback)
+        {
+            bool success = false;
+
+            if (callback != nullptr) {
+                success = on_export_rows(callback);
+            }
+
+            return success;
+        }
+
+        bool Table::importRows(const std::string &file_name, BulkFormat format)
+        {
+            bool success = false;
+
+            if ((file_name.size() > 0) && (format != BulkFormat::EndBulkFormats)) {
+                success = on_import_rows(file_name, format);
+            }
+
+            return success;
+        }
+
+        bool Table::importRows(RowSource source, uint32_t batch_size)
+        {
+            bool success = false;
+
+            if (source != nullptr) {
+                success = on_import_rows(source, batch_size > 0 ? batch_size : sc_default_batch_size);
+            }
+
+            return success;
         }
 
         std::string Table::getColumnNames() const
@@ -117,10 +566,10 @@ namespace afm {
 
             uint32_t columnCount = 0;
 
-            for (auto column : m_columns) {
+            for (auto column : get_columns()) {
                 header << "[" << column->getName() << "]";
 
-                if (++columnCount < m_columns.size() - 1) {
+                if (++columnCount < get_columns().size() - 1) {
                     header << " ";
                 }
             }
@@ -146,98 +595,797 @@ namespace afm {
             return pRow;
         }
 
-        // internal
-        void Table::process_table_options(std::stringstream &output, const QueryOptions &options) const
+        IRowSPtr Table::createEmptyRow(const Projection &projection) const
         {
-            if (options.size() > 0) {
-                std::size_t option_index = 1;
+            IRowSPtr pRow = nullptr;
 
-                output << sc_table_where_clause;
-                for (nlohmann::json::const_iterator iter = options.begin(); iter != options.end(); iter++) {
-                    output << iter.key() << "=";
-                    if (iter->is_string() == true) {
-                        output << "'" << iter.value() << "'";
+            if (projection.size() == 0) {
+                pRow = createEmptyRow();
+            } else {
+                const Columns &columns = get_columns();
+
+                pRow = std::make_shared<Row>();
+
+                // only the projected columns, in the order the query selects them
+                for (auto index : projection) {
+                    std::shared_ptr<Column> pColumn = std::dynamic_pointer_cast<Column>(columns[index]);
+                    if (pColumn != nullptr) {
+                        pRow->addColumn(on_clone_column(*pColumn));
                     } else {
-                        output << iter.value();
-                    }
-                    // we need to use an and after each additional option past the first one
-                    if (option_index < options.size()) {
-                        output << sc_table_and_clause;
+                        // error
+                        break;
                     }
-                    option_index++;
                 }
             }
+
+            return pRow;
         }
 
-        std::string Table::build_select(const QueryOptions &options)
+        AggregateRow Table::create_values(const DataTypes &types)
         {
-            std::stringstream query_string;
+            AggregateRow row;
 
-            query_string << sc_table_load << m_table_name;
+            row.reserve(types.size());
+            for (auto type : types) {
+                IVariableDataSPtr pValue = std::make_shared<VariableData>();
 
-            process_table_options(query_string, options);
+                pValue->initialize(type);
+                row.push_back(pValue);
+            }
 
-            return query_string.str();
+            return row;
         }
 
-        std::string Table::build_insert(const IRowSPtr &pRow) const
+        // internal
+        const Columns &Table::get_columns() const
         {
-            std::stringstream insert_string;
-            std::stringstream values;
-            bool is_first = true;
-
-            std::string query = sc_insert_row_start;
-
-            // replace table with my table name
-            query.replace(query.find("%s"), 2, m_table_name);
-
-            insert_string << query;
+            if (m_columns_loaded == false) {
+                std::lock_guard<std::mutex> guard(m_column_lock);
 
-            for (auto column : pRow->getColumns()) {
-                bool add_column = true;
-
-                if (column->isPrimary() == true) {
-                    if (column->isAutoIncrement() == true) {
-                        // skip it
-                        add_column = false; // auto increment, let db take care of it
-                    }
-                }
+                // someone else may have loaded them while we waited
+                if (m_columns_loaded == false) {
+                    ColumnDetails columns;
 
-                if (add_column == true) {
-                    // don't tack a comma on for the first time in, and don't add
-                    // one until we know for sure there is more than one entry
-                    // this will ensure the last value doesn't have a trailing comma
-                    if (is_first == false) {
-                        insert_string << ",";
-                        values << ",";
-                    } else {
-                        is_first = false;
-                    }
-                    insert_string << column->getName();
-                    IVariableDataSPtr pValue = column->getValue();
-                    if (pValue != nullptr) {
-                        if (pValue->isCharacterData() == true) {
-                            values << "'" << pValue->getValue() << "'";
-                        } else {
-                            values << pValue->getValue();
-                        }
+                    if (on_load_columns(columns) == true) {
+                        add_columns(columns);
+                        m_columns_loaded = true;
                     }
                 }
             }
 
-            insert_string << sc_insert_row_middle;
-            insert_string << values.str();
-            insert_string << sc_insert_row_end;
-
-            return insert_string.str();
+            return m_columns;
         }
 
-        std::string Table::build_update(const IRowSPtr &pRow, const QueryOptions &options) const
+        void Table::add_columns(const ColumnDetails &columns) const
         {
-            std::stringstream update_string;
+            for (auto column : columns) {
+                IColumnSPtr pColumn = createEmptyColumn();
+
+                if (pColumn->initialize(column) == true) {
+                    m_columns.push_back(pColumn);
+                }
+            }
+        }
+
+        bool Table::on_export_rows(RowCallback callback)
+        {
+            bool success = false;
+            ICursorSPtr pCursor = scan();
+
+            if (pCursor != nullptr) {
+                IRowSPtr pRow = nullptr;
+
+                while (pCursor->next(pRow) == true) {
+                    if (callback(pRow) == false) {
+                        break;
+                    }
+                }
+
+                // running out of rows ends the export, a failed fetch fails it
+                success = (pCursor->hasFailed() == false);
+                pCursor->close();
+            }
+
+            return success;
+        }
+
+        bool Table::on_import_rows(RowSource source, uint32_t batch_size)
+        {
+            bool success = true;
+            bool more = true;
+
+            while ((success == true) && (more == true)) {
+                Rows rows;
+
+                rows.reserve(batch_size);
+                while ((rows.size() < batch_size) && (more == true)) {
+                    IRowSPtr pRow = createEmptyRow();
+
+                    more = source(pRow);
+                    if (more == true) {
+                        rows.push_back(pRow);
+                    }
+                }
+
+                if (rows.size() > 0) {
+                    success = on_create_rows(rows, batch_size);
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::is_blob_column(const std::string &column_name) const
+        {
+            bool is_blob = false;
+
+            for (auto column : get_columns()) {
+                if (column->getName() == column_name) {
+                    DataType type = column->getType();
+
+                    is_blob = (type == DataType::BINARY_T) ||
+                              (type == DataType::VARBINARY_T) ||
+                              (type == DataType::VARBINARY_MAX_T) ||
+                              (type == DataType::IMAGE_T) ||
+                              (type == DataType::BLOB_T);
+                    break;
+                }
+            }
+
+            return is_blob;
+        }
+
+        std::string Table::build_name_list(const TableNames &names)
+        {
+            std::stringstream name_list;
             bool is_first = true;
+
+            for (auto name : names) {
+                if (is_first == false) {
+                    name_list << ",";
+                } else {
+                    is_first = false;
+                }
+                name_list << "'" << name << "'";
+            }
+
+            return name_list.str();
+        }
+
+        bool Table::resolve_projection(const ColumnNames &columns, Projection &projection) const
+        {
+            bool success = true;
+            const Columns &table_columns = get_columns();
+
+            projection.clear();
+
+            // names are matched the way the order by matches them, they have to be ours
+            for (auto &name : columns) {
+                std::string lower_name = tools::to_lower(name);
+                bool found = false;
+
+                for (std::size_t index = 0; index < table_columns.size(); index++) {
+                    if (tools::to_lower(table_columns[index]->getName()) == lower_name) {
+                        projection.push_back(index);
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (found == false) {
+                    success = false;
+                    break;
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::build_aggregate(std::stringstream &output, const Aggregate &aggregate, DataType &type) const
+        {
+            bool success = false;
+            std::map<AggregateFunction, std::string>::const_iterator function = sc_aggregate_functions.find(aggregate.function);
+
+            if (function == sc_aggregate_functions.end()) {
+                // not one we know
+            } else if (aggregate.column.size() == 0) {
+                // only rows can be counted without a column
+                if (aggregate.function == AggregateFunction::Count) {
+                    output << sc_count_rows;
+                    type = DataType::BIG_INT_T;
+                    success = true;
+                }
+            } else {
+                Projection column;
+
+                if (resolve_projection(ColumnNames{aggregate.column}, column) == true) {
+                    const IColumnSPtr &pColumn = get_columns()[column[0]];
+                    DataType column_type = pColumn->getType();
+                    bool is_integer = (column_type <= DataType::BIG_INT_T) || (column_type == DataType::TIMESTAMP_T);
+                    bool is_number = (column_type <= DataType::REAL_T) || (column_type == DataType::TIMESTAMP_T);
+                    bool is_binary = ((column_type >= DataType::BINARY_T) && (column_type <= DataType::IMAGE_T)) ||
+                                     (column_type == DataType::BLOB_T);
+
+                    switch (aggregate.function)
+                    {
+                        case AggregateFunction::Count:
+                        {
+                            type = DataType::BIG_INT_T;
+                            success = true;
+                        }
+                        break;
+                        case AggregateFunction::Sum:
+                        {
+                            type = (is_integer == true ? DataType::BIG_INT_T : DataType::FLOAT_T);
+                            success = is_number;
+                        }
+                        break;
+                        case AggregateFunction::Average:
+                        {
+                            type = DataType::FLOAT_T;
+                            success = is_number;
+                        }
+                        break;
+                        default:
+                        {
+                            // minimum and maximum
+                            type = column_type;
+                            success = (is_binary == false);
+                        }
+                        break;
+                    }
+
+                    if (success == true) {
+                        output << function->second << "(" << pColumn->getName() << ")";
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::build_page_options(const PageToken &token, uint32_t page_size, PageOrder order, const QueryOptions &options,
+                                       const Projection &key, QueryOptions &page_options) const
+        {
+            bool success = ((options.size() == 0) || (options.is_object() == true)) &&
+                           ((token.is_null() == true) || ((token.is_array() == true) && (token.size() == key.size()))) &&
+                           (order < PageOrder::EndPageOrders);
+
+            // the page owns the ordering and the limit
+            if ((success == true) && (options.size() > 0)) {
+                success = (options.find(sc_order_by) == options.end()) && (options.find(sc_limit) == options.end()) &&
+                          (options.find(sc_offset) == options.end());
+            }
+
+            if (success == true) {
+                const Columns &columns = get_columns();
+                const std::string &direction = (order == PageOrder::Ascending ? sc_ascending : sc_descending);
+                const std::string &comparison = (order == PageOrder::Ascending ? ">" : "<");
+                nlohmann::json filters = nlohmann::json::array();
+                nlohmann::json order_by = nlohmann::json::array();
+
+                if (options.size() > 0) {
+                    filters.push_back(options);
+                }
+
+                // past the token on the first key column, or level with it and past it on a later one,
+                // so an index on the key serves the page straight from where the last one ended
+                if (token.is_null() == false) {
+                    nlohmann::json after = nlohmann::json::array();
+
+                    for (std::size_t depth = 0; depth < key.size(); depth++) {
+                        nlohmann::json group = nlohmann::json::object();
+
+                        for (std::size_t index = 0; index < depth; index++) {
+                            group[columns[key[index]]->getName()] = token[index];
+                        }
+                        group[columns[key[depth]]->getName()] = {{comparison, token[depth]}};
+                        after.push_back(group);
+                    }
+                    filters.push_back({{sc_or_groups, after}});
+                }
+
+                for (auto index : key) {
+                    order_by.push_back(columns[index]->getName() + " " + direction);
+                }
+
+                page_options = nlohmann::json::object();
+                if (filters.size() > 0) {
+                    page_options[sc_and_groups] = filters;
+                }
+                page_options[sc_order_by] = order_by;
+                page_options[sc_limit] = page_size;
+            }
+
+            return success;
+        }
+
+        bool Table::process_table_options(std::stringstream &output, const QueryOptions &options, StatementValues &values) const
+        {
+            bool success = true;
+
+            if (options.size() > 0) {
+                std::stringstream filter;
+
+                success = build_filter(filter, options, values);
+
+                // ordering and paging alone leave no where clause behind
+                if ((success == true) && (filter.str().size() > 0)) {
+                    output << sc_table_where_clause << filter.str();
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::process_query_modifiers(std::stringstream &output, const QueryOptions &options) const
+        {
+            bool success = true;
+
+            if ((options.is_object() == true) && (options.find(sc_order_by) != options.end())) {
+                const nlohmann::json &order_by = options[sc_order_by];
+                nlohmann::json terms = (order_by.is_array() == true) ? order_by : nlohmann::json::array({order_by});
+                bool is_first = true;
+
+                for (auto &term : terms) {
+                    std::string column;
+                    std::string direction;
+
+                    success = (term.is_string() == true) && (parse_order_term(term.get<std::string>(), column, direction) == true);
+                    if (success == false) {
+                        break;
+                    }
+
+                    output << (is_first == true ? sc_order_by_clause : ",") << column;
+                    if (direction.size() > 0) {
+                        output << " " << direction;
+                    }
+                    is_first = false;
+                }
+            }
+
+            if ((success == true) && (options.is_object() == true)) {
+                QueryOptions::const_iterator limit = options.find(sc_limit);
+                QueryOptions::const_iterator offset = options.find(sc_offset);
+
+                if ((limit != options.end()) && (is_count(*limit) == false)) {
+                    success = false;
+                } else if ((offset != options.end()) && (is_count(*offset) == false)) {
+                    success = false;
+                } else {
+                    if (limit != options.end()) {
+                        output << sc_limit_clause << limit->get<uint64_t>();
+                    }
+                    if (offset != options.end()) {
+                        // most dialects only take an offset behind a limit
+                        if (limit == options.end()) {
+                            output << sc_limit_clause << get_unbounded_limit();
+                        }
+                        output << sc_offset_clause << offset->get<uint64_t>();
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::build_filter(std::stringstream &output, const QueryOptions &options, StatementValues &values) const
+        {
+            bool success = options.is_object();
+            bool is_first = true;
+
+            for (QueryOptions::const_iterator iter = options.begin(); (success == true) && (iter != options.end()); iter++) {
+                std::stringstream term;
+
+                if (iter.key() == sc_or_groups) {
+                    success = build_groups(term, iter.value(), sc_table_or_clause, values);
+                } else if (iter.key() == sc_and_groups) {
+                    success = build_groups(term, iter.value(), sc_table_and_clause, values);
+                } else if (iter.key()[0] != sc_reserved_prefix) {
+                    success = build_condition(term, iter.key(), iter.value(), values);
+                } else {
+                    // ordering and paging are for process_query_modifiers, anything else is a mistake
+                    success = (iter.key() == sc_order_by) || (iter.key() == sc_limit) || (iter.key() == sc_offset);
+                }
+
+                // each condition is anded on to the ones before it
+                if ((success == true) && (term.str().size() > 0)) {
+                    if (is_first == false) {
+                        output << sc_table_and_clause;
+                    }
+                    output << term.str();
+                    is_first = false;
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::build_groups(std::stringstream &output, const nlohmann::json &groups, const std::string &conjunction, StatementValues &values) const
+        {
+            bool success = (groups.is_array() == true) && (groups.size() > 0);
+            bool is_first = true;
+
+            output << "(";
+            for (auto &group : groups) {
+                std::stringstream filter;
+
+                success = build_filter(filter, group, values);
+                if (success == false) {
+                    break;
+                }
+
+                if (is_first == false) {
+                    output << conjunction;
+                }
+                // an empty group has nothing to rule a row out
+                output << "(" << (filter.str().size() > 0 ? filter.str() : sc_match_everything) << ")";
+                is_first = false;
+            }
+            output << ")";
+
+            return success;
+        }
+
+        bool Table::build_condition(std::stringstream &output, const std::string &name, const nlohmann::json &condition, StatementValues &values) const
+        {
+            std::string column;
+            bool success = resolve_column(name, column);
+
+            if (success == false) {
+                // the key goes in as is, anything that is not one of our columns is refused
+            } else if (condition.is_object() == true) {
+                // {"op": operand, ...}, every operator given has to hold
+                bool is_first = true;
+
+                success = (condition.size() > 0);
+                for (nlohmann::json::const_iterator iter = condition.begin(); (success == true) && (iter != condition.end()); iter++) {
+                    if (is_first == false) {
+                        output << sc_table_and_clause;
+                    }
+                    success = build_comparison(output, column, tools::to_lower(iter.key()), iter.value(), values);
+                    is_first = false;
+                }
+            } else if (condition.is_array() == true) {
+                success = build_comparison(output, column, sc_in, condition, values);
+            } else {
+                success = build_comparison(output, column, "=", condition, values);
+            }
+
+            return success;
+        }
+
+        bool Table::build_comparison(std::stringstream &output, const std::string &name, const std::string &op, const nlohmann::json &operand, StatementValues &values) const
+        {
+            bool success = true;
+            std::map<std::string, std::string>::const_iterator comparison = sc_comparisons.find(op);
+
+            if (comparison != sc_comparisons.end()) {
+                if (operand.is_null() == true) {
+                    // nothing compares equal to null, the only sensible reading is a null test
+                    if (op == "=") {
+                        output << name << " is null";
+                    } else if (comparison->second == "<>") {
+                        output << name << " is not null";
+                    } else {
+                        success = false;
+                    }
+                } else if ((operand.is_object() == false) && (operand.is_array() == false)) {
+                    output << name << comparison->second;
+                    append_value(output, createVariableData(operand), values);
+                } else {
+                    success = false;
+                }
+            } else if ((op == sc_in) || (op == sc_not_in)) {
+                success = (operand.is_array() == true);
+
+                if (success == true) {
+                    if (operand.size() == 0) {
+                        // an empty list, nothing is in it and everything is not
+                        output << (op == sc_in ? sc_match_nothing : sc_match_everything);
+                    } else {
+                        bool is_first = true;
+
+                        output << name << " " << op << " (";
+                        for (auto &item : operand) {
+                            IVariableDataSPtr pValue = createVariableData(item);
+
+                            success = (pValue != nullptr);
+                            if (success == false) {
+                                break;
+                            }
+                            if (is_first == false) {
+                                output << ",";
+                            }
+                            append_value(output, pValue, values);
+                            is_first = false;
+                        }
+                        output << ")";
+                    }
+                }
+            } else if ((op == sc_between) || (op == sc_not_between)) {
+                IVariableDataSPtr pLow = nullptr;
+                IVariableDataSPtr pHigh = nullptr;
+
+                if ((operand.is_array() == true) && (operand.size() == 2)) {
+                    pLow = createVariableData(operand[0]);
+                    pHigh = createVariableData(operand[1]);
+                }
+
+                success = (pLow != nullptr) && (pHigh != nullptr);
+                if (success == true) {
+                    output << name << " " << op << " ";
+                    append_value(output, pLow, values);
+                    output << sc_table_and_clause;
+                    append_value(output, pHigh, values);
+                }
+            } else if (op == sc_is_null) {
+                success = operand.is_boolean();
+                if (success == true) {
+                    output << name << (operand.get<bool>() == true ? " is null" : " is not null");
+                }
+            } else {
+                success = false;
+            }
+
+            return success;
+        }
+
+        bool Table::parse_order_term(const std::string &term, std::string &column, std::string &direction) const
+        {
+            bool success = false;
+            tools::StringTokens tokens;
+
+            // "column" or "column asc|desc", the column has to be one of ours as it goes in as is
+            if ((tools::split_string(tokens, tools::trim_string(term), ' ') > 0) && (tokens.size() <= 2)) {
+                success = resolve_column(tokens[0], column);
+
+                direction.clear();
+                if ((success == true) && (tokens.size() == 2)) {
+                    direction = tools::to_lower(tokens[1]);
+                    success = (direction == sc_ascending) || (direction == sc_descending);
+                }
+            }
+
+            return success;
+        }
+
+        bool Table::resolve_column(const std::string &name, std::string &column) const
+        {
+            bool success = false;
+            std::string lower_name = tools::to_lower(name);
+
+            // matched without case, the name written out is the one the table reported
+            for (auto pColumn : get_columns()) {
+                if (tools::to_lower(pColumn->getName()) == lower_name) {
+                    column = pColumn->getName();
+                    success = true;
+                    break;
+                }
+            }
+
+            return success;
+        }
+
+        void Table::append_value(std::stringstream &output, const IVariableDataSPtr &pValue, StatementValues &values) const
+        {
+            if (pValue != nullptr) {
+                if (uses_bound_values() == true) {
+                    // the backend binds it, we only leave a placeholder behind
+                    values.push_back(pValue);
+                    output << get_parameter_marker(values.size());
+                } else if (pValue->isCharacterData() == true) {
+                    output << "'" << pValue->getValue() << "'";
+                } else {
+                    output << pValue->getValue();
+                }
+            }
+        }
+
+        std::string Table::build_select(const QueryOptions &options, StatementValues &values, const Projection &projection)
+        {
+            std::string query;
+            StatementTemplate statement;
+
+            // templates are kept for whole rows only
+            if ((values.size() == 0) && (projection.size() == 0) && (get_select_template(options, statement) == true)) {
+                for (nlohmann::json::const_iterator iter = options.begin(); iter != options.end(); iter++) {
+                    values.push_back(createVariableData(iter.value()));
+                }
+                if (all_values_bound(values, 0) == true) {
+                    query = statement.columns_text;
+                }
+            }
+
+            if (query.size() == 0) {
+                std::stringstream query_string;
+
+                if (projection.size() == 0) {
+                    query_string << sc_table_load << m_table_name;
+                } else {
+                    const Columns &columns = get_columns();
+
+                    query_string << sc_select_start;
+                    for (std::size_t index = 0; index < projection.size(); index++) {
+                        if (index > 0) {
+                            query_string << ",";
+                        }
+                        query_string << columns[projection[index]]->getName();
+                    }
+                    query_string << sc_select_from << m_table_name;
+                }
+
+                // a malformed filter fails the query, an empty one would return the whole table
+                if ((process_table_options(query_string, options, values) == true) &&
+                    (process_query_modifiers(query_string, options) == true)) {
+                    query = query_string.str();
+                } else {
+                    values.clear();
+                }
+            }
+
+            return query;
+        }
+
+        bool Table::is_insert_column(const IColumnSPtr &pColumn) const
+        {
+            bool add_column = true;
+
+            if (pColumn->isPrimary() == true) {
+                if (pColumn->isAutoIncrement() == true) {
+                    // skip it
+                    add_column = false; // auto increment, let db take care of it
+                }
+            }
+
+            return add_column;
+        }
+
+        std::string Table::build_insert(const IRowSPtr &pRow, StatementValues &values) const
+        {
+            std::string query;
+            StatementTemplate statement;
+
+            if ((values.size() == 0) && (get_insert_template(pRow, statement) == true)) {
+                collect_insert_values(pRow, values);
+                if (all_values_bound(values, 0) == true) {
+                    query = statement.columns_text + statement.values_text;
+                }
+            }
+
+            if (query.size() == 0) {
+                query = build_insert_columns(pRow) + build_insert_values(pRow, values);
+            }
+
+            return query;
+        }
+
+        std::string Table::build_insert_columns(const IRowSPtr &pRow) const
+        {
+            std::stringstream insert_string;
+            bool is_first = true;
+
+            std::string query = sc_insert_row_start;
+
+            // replace table with my table name
+            query.replace(query.find("%s"), 2, m_table_name);
+
+            insert_string << query;
+
+            for (auto column : pRow->getColumns()) {
+                if (is_insert_column(column) == true) {
+                    // don't tack a comma on for the first time in, and don't add
+                    // one until we know for sure there is more than one entry
+                    // this will ensure the last value doesn't have a trailing comma
+                    if (is_first == false) {
+                        insert_string << ",";
+                    } else {
+                        is_first = false;
+                    }
+                    insert_string << column->getName();
+                }
+            }
+
+            insert_string << sc_insert_row_middle;
+
+            return insert_string.str();
+        }
+
+        std::string Table::build_insert_values(const IRowSPtr &pRow, StatementValues &values) const
+        {
+            std::string query;
+            StatementTemplate statement;
+
+            // further rows of a multi row insert only reuse the text when markers don't carry their position
+            std::size_t first = values.size();
+
+            if ((get_insert_template(pRow, statement) == true) && ((first == 0) || (statement.anonymous_markers == true))) {
+                collect_insert_values(pRow, values);
+                if (all_values_bound(values, first) == true) {
+                    query = statement.values_text;
+                }
+            }
+
+            if (query.size() == 0) {
+                query = build_insert_values_text(pRow, values);
+            }
+
+            return query;
+        }
+
+        std::string Table::build_insert_values_text(const IRowSPtr &pRow, StatementValues &values) const
+        {
+            std::stringstream value_string;
+            bool is_first = true;
+
+            value_string << sc_insert_values_start;
+
+            for (auto column : pRow->getColumns()) {
+                if (is_insert_column(column) == true) {
+                    if (is_first == false) {
+                        value_string << ",";
+                    } else {
+                        is_first = false;
+                    }
+                    append_value(value_string, column->getValue(), values);
+                }
+            }
+
+            value_string << sc_insert_row_end;
+
+            return value_string.str();
+        }
+
+        std::string Table::build_update(const IRowSPtr &pRow, const QueryOptions &options, StatementValues &values) const
+        {
+            std::string query;
+            StatementTemplate statement;
             IColumnSPtr pKeyColumn = nullptr;
 
+            if ((values.size() == 0) && (get_update_template(pRow, statement) == true)) {
+                pKeyColumn = collect_update_values(pRow, values);
+                if ((options.size() == 0) && (pKeyColumn != nullptr)) {
+                    values.push_back(pKeyColumn->getValue());
+                }
+
+                if (all_values_bound(values, 0) == true) {
+                    query = statement.columns_text;
+                    if ((options.size() == 0) && (pKeyColumn != nullptr)) {
+                        query += statement.values_text;
+                    }
+                }
+            }
+
+            if (query.size() == 0) {
+                pKeyColumn = nullptr;
+                query = build_update_set(pRow, values, pKeyColumn);
+
+                if ((options.size() == 0) && (pKeyColumn != nullptr)) {
+                    query += build_key_filter(pKeyColumn, values);
+                }
+            }
+
+            if (options.size() > 0) {
+                std::stringstream filter;
+
+                // a malformed filter, or one that is only ordering and paging, fails the update rather
+                // than widening it to every row
+                if ((process_table_options(filter, options, values) == true) && (filter.str().size() > 0)) {
+                    query += filter.str();
+                } else {
+                    query.clear();
+                    values.clear();
+                }
+            }
+
+            return query;
+        }
+
+        std::string Table::build_update_set(const IRowSPtr &pRow, StatementValues &values, IColumnSPtr &pKeyColumn) const
+        {
+            std::stringstream update_string;
+            bool is_first = true;
+
             std::string query = sc_update_row_start;
 
             // replace table with my table name
@@ -267,32 +1415,185 @@ namespace afm {
                         is_first = false;
                     }
                     update_string << column->getName() << "=";
+                    append_value(update_string, column->getValue(), values);
+                }
+            }
 
-                    IVariableDataSPtr pValue = column->getValue();
-                    if (pValue != nullptr) {
-                        if (pValue->isCharacterData() == true) {
-                            update_string << "'" << pValue->getValue() << "'";
-                        } else {
-                            update_string << pValue->getValue();
-                        }
+            return update_string.str();
+        }
+
+        std::string Table::build_key_filter(const IColumnSPtr &pKeyColumn, StatementValues &values) const
+        {
+            std::stringstream filter;
+
+            filter << sc_table_where_clause << pKeyColumn->getName() << "=";
+            append_value(filter, pKeyColumn->getValue(), values);
+
+            return filter.str();
+        }
+
+        bool Table::get_insert_template(const IRowSPtr &pRow, StatementTemplate &statement) const
+        {
+            bool found = false;
+
+            if (uses_bound_values() == true) {
+                const Columns &columns = pRow->getColumns();
+
+                {
+                    std::lock_guard<std::mutex> guard(m_template_lock);
+
+                    found = find_template(m_insert_templates, columns, statement);
+                }
+
+                if (found == false) {
+                    StatementValues compiled;
+                    StatementValues expected;
+
+                    statement.columns.clear();
+                    for (auto column : columns) {
+                        statement.columns.push_back(column->getName());
+                    }
+                    statement.columns_text = build_insert_columns(pRow);
+
+                    // built the long way once with nothing bound ahead, so the markers count from 1
+                    statement.values_text = build_insert_values_text(pRow, compiled);
+                    collect_insert_values(pRow, expected);
+
+                    // a missing value leaves no marker behind, that text is no good for another row
+                    if (compiled.size() == expected.size()) {
+                        save_template(m_insert_templates, statement);
+                        found = true;
                     }
                 }
             }
 
-            if (options.size() > 0) {
-                process_table_options(update_string, options);
-            } else if (pKeyColumn != nullptr) {
-                update_string << sc_table_where_clause << pKeyColumn->getName() << "=";
-                IVariableDataSPtr pValue = pKeyColumn->getValue();
-                if (pValue != nullptr) {
-                    if (pValue->isCharacterData() == true) {
-                        update_string << "'" << pValue->getValue() << "'";
-                    } else {
-                        update_string << pValue->getValue();
+            return found;
+        }
+
+        bool Table::get_update_template(const IRowSPtr &pRow, StatementTemplate &statement) const
+        {
+            bool found = false;
+
+            if (uses_bound_values() == true) {
+                const Columns &columns = pRow->getColumns();
+
+                {
+                    std::lock_guard<std::mutex> guard(m_template_lock);
+
+                    found = find_template(m_update_templates, columns, statement);
+                }
+
+                if (found == false) {
+                    StatementValues compiled;
+                    StatementValues expected;
+                    IColumnSPtr pKeyColumn = nullptr;
+
+                    statement.columns.clear();
+                    for (auto column : columns) {
+                        statement.columns.push_back(column->getName());
+                    }
+
+                    // the key filter follows the set list, its marker numbers on from there
+                    statement.columns_text = build_update_set(pRow, compiled, pKeyColumn);
+                    statement.values_text.clear();
+                    if (pKeyColumn != nullptr) {
+                        statement.values_text = build_key_filter(pKeyColumn, compiled);
+                    }
+
+                    pKeyColumn = collect_update_values(pRow, expected);
+                    if (pKeyColumn != nullptr) {
+                        expected.push_back(pKeyColumn->getValue());
+                    }
+
+                    if (compiled.size() == expected.size()) {
+                        save_template(m_update_templates, statement);
+                        found = true;
                     }
                 }
             }
-            return update_string.str();
+
+            return found;
+        }
+
+        bool Table::get_select_template(const QueryOptions &options, StatementTemplate &statement) const
+        {
+            bool found = false;
+
+            // only equality filters of plain values, the template is keyed on the column names alone
+            if ((uses_bound_values() == true) && (is_plain_filter(options) == true)) {
+                {
+                    std::lock_guard<std::mutex> guard(m_template_lock);
+
+                    found = find_template(m_select_templates, options, statement);
+                }
+
+                if (found == false) {
+                    std::stringstream query_string;
+                    StatementValues compiled;
+
+                    statement.columns.clear();
+                    for (nlohmann::json::const_iterator iter = options.begin(); iter != options.end(); iter++) {
+                        statement.columns.push_back(iter.key());
+                    }
+
+                    query_string << sc_table_load << m_table_name;
+                    process_table_options(query_string, options, compiled);
+                    statement.columns_text = query_string.str();
+                    statement.values_text.clear();
+
+                    if (compiled.size() == options.size()) {
+                        save_template(m_select_templates, statement);
+                        found = true;
+                    }
+                }
+            }
+
+            return found;
+        }
+
+        void Table::save_template(StatementTemplates &templates, StatementTemplate &statement) const
+        {
+            std::lock_guard<std::mutex> guard(m_template_lock);
+
+            statement.anonymous_markers = (get_parameter_marker(1) == get_parameter_marker(2));
+
+            bool exists = false;
+
+            // another thread may have compiled the same one meanwhile
+            for (auto &entry : templates) {
+                if (entry.columns == statement.columns) {
+                    exists = true;
+                    break;
+                }
+            }
+
+            if ((exists == false) && (templates.size() < sc_max_statement_templates)) {
+                templates.push_back(statement);
+            }
+        }
+
+        void Table::collect_insert_values(const IRowSPtr &pRow, StatementValues &values) const
+        {
+            for (auto column : pRow->getColumns()) {
+                if (is_insert_column(column) == true) {
+                    values.push_back(column->getValue());
+                }
+            }
+        }
+
+        IColumnSPtr Table::collect_update_values(const IRowSPtr &pRow, StatementValues &values) const
+        {
+            IColumnSPtr pKeyColumn = nullptr;
+
+            for (auto column : pRow->getColumns()) {
+                if (column->isAutoIncrement() == false) {
+                    values.push_back(column->getValue());
+                } else if (column->isPrimary() == true) {
+                    pKeyColumn = column;
+                }
+            }
+
+            return pKeyColumn;
         }
     }
 }
\ No newline at end of file
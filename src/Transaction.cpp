@@ -0,0 +1,152 @@
+/**
+ * Transaction.cpp
+ */
+
+#include "Transaction.h"
+
+namespace afm {
+    namespace database {
+        static const std::string sc_savepoint_prefix = "afm_savepoint_";
+        static const std::string sc_savepoint = "savepoint ";
+        static const std::string sc_release_savepoint = "release savepoint ";
+        static const std::string sc_rollback_to_savepoint = "rollback to savepoint ";
+
+        uint32_t TransactionConnection::beginScope(bool read_only)
+        {
+            uint32_t depth = 0;
+            bool success = false;
+
+            if (m_scopes.size() == 0) {
+                success = on_begin(read_only);
+            } else {
+                success = on_execute(sc_savepoint + get_savepoint(m_scopes.size() + 1));
+            }
+
+            if (success == true) {
+                m_scopes.push_back(m_next_scope++);
+                depth = m_scopes.size();
+            }
+
+            return depth;
+        }
+
+        bool TransactionConnection::commitScope(uint32_t depth)
+        {
+            bool success = false;
+
+            // a scope already ended by an enclosing one has nothing left to commit
+            if ((depth > 0) && (depth <= m_scopes.size())) {
+                if (depth == 1) {
+                    success = on_commit();
+                } else {
+                    success = on_execute(sc_release_savepoint + get_savepoint(depth));
+                }
+
+                // a failed commit leaves the scope open for a rollback
+                if (success == true) {
+                    m_scopes.resize(depth - 1);
+                }
+            }
+
+            return success;
+        }
+
+        bool TransactionConnection::rollbackScope(uint32_t depth)
+        {
+            bool success = false;
+
+            if ((depth > 0) && (depth <= m_scopes.size())) {
+                if (depth == 1) {
+                    success = on_rollback();
+                } else {
+                    // rolling back to a savepoint keeps it, it still has to be released
+                    success = on_execute(sc_rollback_to_savepoint + get_savepoint(depth));
+                    if (success == true) {
+                        success = on_execute(sc_release_savepoint + get_savepoint(depth));
+                    }
+                }
+                m_scopes.resize(depth - 1);
+            }
+
+            return success;
+        }
+
+        uint64_t TransactionConnection::getScope(uint32_t depth) const
+        {
+            uint64_t scope = 0;
+
+            if ((depth > 0) && (depth <= m_scopes.size())) {
+                scope = m_scopes[depth - 1];
+            }
+
+            return scope;
+        }
+
+        std::string TransactionConnection::get_savepoint(uint32_t depth) const
+        {
+            return sc_savepoint_prefix + std::to_string(depth);
+        }
+
+        Transaction::Transaction(TransactionConnectionSPtr pConnection)
+            : m_pConnection(pConnection)
+        {
+
+        }
+
+        Transaction::~Transaction()
+        {
+            if (isActive() == true) {
+                rollback();
+            }
+
+            // the lease goes back to its pool
+            m_pConnection = nullptr;
+        }
+
+        bool Transaction::initialize(bool read_only)
+        {
+            if (m_pConnection != nullptr) {
+                m_depth = m_pConnection->beginScope(read_only);
+                m_scope = m_pConnection->getScope(m_depth);
+            }
+
+            return m_depth > 0;
+        }
+
+        bool Transaction::commit()
+        {
+            bool success = false;
+
+            if (isActive() == true) {
+                success = m_pConnection->commitScope(m_depth);
+            }
+
+            // still active after a failed commit, so it rolls back when released
+            if (isActive() == false) {
+                m_depth = 0;
+                m_scope = 0;
+            }
+
+            return success;
+        }
+
+        bool Transaction::rollback()
+        {
+            bool success = false;
+
+            if (isActive() == true) {
+                success = m_pConnection->rollbackScope(m_depth);
+            }
+            m_depth = 0;
+            m_scope = 0;
+
+            return success;
+        }
+
+        bool Transaction::isActive() const
+        {
+            // an enclosing scope ending first takes this one with it
+            return (m_scope > 0) && (m_pConnection != nullptr) && (m_pConnection->getScope(m_depth) == m_scope);
+        }
+    }
+}
@@ -4,6 +4,8 @@
 
 #include <cstring>
 #include <cwchar>
+#include <iomanip>
+#include <limits>
 #include <sstream>
 
 #include "tools/tools.h"
@@ -165,7 +167,7 @@ namespace afm {
                     case DataType::DECIMAL_T:
                     case DataType::NUMERIC_T:                    
                     {
-                        float value = std::stof(pValue);
+                        double value = std::stod(pValue);
 
                         setValue(value);
                     }
@@ -272,7 +274,8 @@ namespace afm {
                     case DataType::NVARCHAR_MAX_T:
                     case DataType::NTEXT_T:
                     {
-                        setValue(std::wstring((wchar_t *)pValue));
+                        // incoming text is utf-8, widen it rather than reinterpreting the bytes
+                        setValue(tools::utf8_to_wide(pValue));
                     }
                     break;
                     case DataType::BINARY_T:
@@ -281,7 +284,8 @@ namespace afm {
                     case DataType::IMAGE_T:
                     case DataType::BLOB_T:
                     {
-                        // binary data, we will need to use the length to store it properly
+                        // binary data, only the length says where it ends
+                        success = set_binary((const uint8_t *)pValue, length);
                     }
                     break;
                     case DataType::EndDataTypes:
@@ -340,7 +344,8 @@ namespace afm {
                 case DataType::DECIMAL_T:
                 case DataType::NUMERIC_T:                    
                 {
-                    value << m_values.decimal;
+                    // enough digits that the text reads back as the same double
+                    value << std::setprecision(std::numeric_limits<double>::digits10) << m_values.bigdecimal;
                 }
                 break;
                 case DataType::FLOAT_T:
@@ -390,9 +395,8 @@ namespace afm {
                 case DataType::NVARCHAR_MAX_T:
                 case DataType::NTEXT_T:
                 {
-                    // will need to fix this later
                     if (m_values.wvarchar != nullptr) {
-                        value << (char *)m_values.wvarchar;
+                        value << tools::wide_to_utf8(m_values.wvarchar);
                     } else {
                         value << "NULL";
                     }
@@ -668,7 +672,7 @@ namespace afm {
             bool success = false;
 
             if ((m_type == DataType::DECIMAL_T)  || (m_type == DataType::NUMERIC_T)) {
-                value = m_values.decimal;
+                value = static_cast<float>(m_values.bigdecimal);
                 success = true;
             }
 
@@ -680,11 +684,11 @@ namespace afm {
             bool success = false;
 
             if ((m_type == DataType::DECIMAL_T)  || (m_type == DataType::NUMERIC_T)) {
-                if (m_values.decimal != value) {
-                    m_values.decimal = value;
-                    m_is_dirty = true;
-                }
-                success = true;
+                // a float only carries six good digits, keep those rather than its binary tail
+                std::stringstream text;
+
+                text << value;
+                success = setValue(std::stod(text.str()));
             }
 
             return success;
@@ -694,7 +698,8 @@ namespace afm {
         {
             bool success = false;
 
-            if ((m_type == DataType::FLOAT_T)  || (m_type == DataType::REAL_T)) {
+            if ((m_type == DataType::FLOAT_T)  || (m_type == DataType::REAL_T) ||
+                (m_type == DataType::DECIMAL_T)  || (m_type == DataType::NUMERIC_T)) {
                 value = m_values.bigdecimal;
                 success = true;
             }
@@ -706,7 +711,8 @@ namespace afm {
         {
             bool success = false;
 
-            if ((m_type == DataType::FLOAT_T)  || (m_type == DataType::REAL_T)) {
+            if ((m_type == DataType::FLOAT_T)  || (m_type == DataType::REAL_T) ||
+                (m_type == DataType::DECIMAL_T)  || (m_type == DataType::NUMERIC_T)) {
                 if (m_values.bigdecimal != value) {
                     m_values.bigdecimal = value;
                     m_is_dirty = true;
@@ -818,7 +824,7 @@ namespace afm {
                     (m_type == DataType::TEXT_T) ||
                     (m_type == DataType::XML_T) ||
                     (m_type == DataType::JSON_T)) {
-                    if ((m_length != value.size()) || (strcmp(m_values.varchar, value.c_str()) != 0)) {
+                    if ((m_values.varchar == nullptr) || (m_length != value.size()) || (strcmp(m_values.varchar, value.c_str()) != 0)) {
                         m_length = value.size();
                         if (m_values.varchar != nullptr) {
                             delete [] m_values.varchar;
@@ -862,7 +868,7 @@ namespace afm {
                     (m_type == DataType::NVARCHAR_T) ||
                     (m_type == DataType::NVARCHAR_MAX_T) ||
                     (m_type == DataType::NTEXT_T)) {
-                    if ((m_length != value.size()) || (wcscmp(m_values.wvarchar, value.c_str()) != 0)) {
+                    if ((m_values.wvarchar == nullptr) || (m_length != value.size()) || (wcscmp(m_values.wvarchar, value.c_str()) != 0)) {
                         m_length = value.size();
                         if (m_values.wvarchar != nullptr) {
                             delete [] m_values.wvarchar;
@@ -900,22 +906,27 @@ namespace afm {
         }
 
         bool VariableData::setValue(BinaryBlob &value)
+        {
+            return set_binary(value.data(), value.size());
+        }
+
+        bool VariableData::set_binary(const uint8_t *pValue, uint64_t length)
         {
             bool success = false;
 
-            if (value.size() <= m_max_length) {
+            if (length <= m_max_length) {
                 if ((m_type == DataType::BINARY_T) ||
                     (m_type == DataType::VARBINARY_T) ||
                     (m_type == DataType::VARBINARY_MAX_T) ||
                     (m_type == DataType::IMAGE_T) ||
                     (m_type == DataType::BLOB_T)) {
-                    if ((m_length != value.size()) || (memcmp(m_values.varbinary, value.data(), m_length) != 0)) {
-                        m_length = value.size();
+                    if ((m_length != length) || (memcmp(m_values.varbinary, pValue, m_length) != 0)) {
+                        m_length = length;
                         if (m_values.varbinary != nullptr) {
                             delete [] m_values.varbinary;
                         }
                         m_values.varbinary = new uint8_t[m_length];
-                        memcpy(m_values.varbinary, value.data(), m_length);
+                        memcpy(m_values.varbinary, pValue, m_length);
                         m_is_dirty = true;
                     }
                     success = true;
@@ -924,5 +935,80 @@ namespace afm {
 
             return success;
         }
+
+        IVariableDataSPtr createVariableData(const nlohmann::json &value)
+        {
+            IVariableDataSPtr pValue = nullptr;
+
+            if (value.is_string() == true) {
+                pValue = std::make_shared<VariableData>();
+                pValue->initialize(DataType::TEXT_T);
+                pValue->setValue(value.get<std::string>());
+            } else if (value.is_boolean() == true) {
+                pValue = std::make_shared<VariableData>();
+                pValue->initialize(DataType::BIT_T);
+                pValue->setValue(value.get<bool>());
+            } else if (value.is_number_float() == true) {
+                pValue = std::make_shared<VariableData>();
+                pValue->initialize(DataType::FLOAT_T);
+                pValue->setValue(value.get<double>());
+            } else if (value.is_number() == true) {
+                pValue = std::make_shared<VariableData>();
+                pValue->initialize(DataType::BIG_INT_T);
+                pValue->setValue(value.get<int64_t>());
+            }
+
+            return pValue;
+        }
+
+        bool getJsonValue(const IVariableDataSPtr &pValue, nlohmann::json &value)
+        {
+            bool success = (pValue != nullptr);
+
+            if (success == true) {
+                switch (pValue->getType())
+                {
+                    case DataType::BIT_T:
+                    {
+                        value = (pValue->getValue() == "true");
+                    }
+                    break;
+                    case DataType::TINY_INT_T:
+                    case DataType::SMALL_INT_T:
+                    case DataType::INT_T:
+                    case DataType::BIG_INT_T:
+                    case DataType::TIMESTAMP_T:
+                    {
+                        value = (int64_t)strtoll(pValue->getValue().c_str(), nullptr, 10);
+                    }
+                    break;
+                    case DataType::DECIMAL_T:
+                    case DataType::NUMERIC_T:
+                    case DataType::FLOAT_T:
+                    case DataType::REAL_T:
+                    {
+                        value = strtod(pValue->getValue().c_str(), nullptr);
+                    }
+                    break;
+                    case DataType::BINARY_T:
+                    case DataType::VARBINARY_T:
+                    case DataType::VARBINARY_MAX_T:
+                    case DataType::IMAGE_T:
+                    case DataType::BLOB_T:
+                    case DataType::EndDataTypes:
+                    {
+                        success = false;
+                    }
+                    break;
+                    default:
+                    {
+                        value = pValue->getValue();
+                    }
+                    break;
+                }
+            }
+
+            return success;
+        }
     }
 }
@@ -0,0 +1,129 @@
+/**
+ * MariaAsyncConnection.cpp
+ */
+
+#include <sys/epoll.h>
+
+#include "maria/MariaAsyncConnection.h"
+#include "maria/MariaUtility.h"
+
+namespace afm {
+    namespace database {
+
+        MariaAsyncConnection::MariaAsyncConnection()
+        {
+
+        }
+
+        MariaAsyncConnection::~MariaAsyncConnection()
+        {
+            if (m_pResults != nullptr) {
+                mysql_free_result(m_pResults);
+                m_pResults = nullptr;
+            }
+            if (m_p_db != nullptr) {
+                mysql_close(m_p_db);
+                m_p_db = nullptr;
+            }
+        }
+
+        bool MariaAsyncConnection::initialize(const ConnectionDetails &details, uint32_t port, const std::string &database_name)
+        {
+            bool success = false;
+
+            m_p_db = mysql_init(nullptr);
+
+            if (m_p_db != nullptr) {
+                const char *pPipeName = nullptr;
+
+                if (details.named_pipe.size() > 0) {
+                    pPipeName = details.named_pipe.c_str();
+                }
+
+                // no multi statements, a second result set would leave the connection out of step
+                if (mysql_options(m_p_db, MYSQL_OPT_NONBLOCK, 0) == 0) {
+                    success = (mysql_real_connect(m_p_db, details.server_name.c_str(), details.user_id.c_str(),
+                                    details.user_password.c_str(), database_name.c_str(), port, pPipeName, 0) != nullptr);
+                }
+            }
+
+            return success;
+        }
+
+        uint32_t MariaAsyncConnection::start(const std::string &query)
+        {
+            if (m_pResults != nullptr) {
+                mysql_free_result(m_pResults);
+                m_pResults = nullptr;
+            }
+            m_error = 0;
+            m_phase = Phase::Query;
+
+            return advance(mysql_real_query_start(&m_error, m_p_db, query.c_str(), query.size()));
+        }
+
+        uint32_t MariaAsyncConnection::resume(uint32_t events)
+        {
+            int status = 0;
+
+            if ((events & EPOLLIN) != 0) {
+                status |= MYSQL_WAIT_READ;
+            }
+            if ((events & EPOLLOUT) != 0) {
+                status |= MYSQL_WAIT_WRITE;
+            }
+            if ((events & (EPOLLPRI | EPOLLERR | EPOLLHUP)) != 0) {
+                status |= MYSQL_WAIT_EXCEPT;
+            }
+
+            if (m_phase == Phase::Query) {
+                status = mysql_real_query_cont(&m_error, m_p_db, status);
+            } else if (m_phase == Phase::Store) {
+                status = mysql_store_result_cont(&m_pResults, m_p_db, status);
+            } else {
+                status = 0;
+            }
+
+            return advance(status);
+        }
+
+        void MariaAsyncConnection::getResult(QueryResult &result)
+        {
+            if (m_error == 0) {
+                // the whole result was stored without blocking, walking it is local
+                database::getResult(m_p_db, m_pResults, result);
+                m_pResults = nullptr;
+            } else {
+                result.error = mysql_error(m_p_db);
+            }
+        }
+
+        uint32_t MariaAsyncConnection::advance(int status)
+        {
+            uint32_t events = 0;
+
+            // each step that finishes right away leads straight into the next
+            while ((status == 0) && (m_phase != Phase::Idle)) {
+                if ((m_phase == Phase::Query) && (m_error == 0)) {
+                    m_phase = Phase::Store;
+                    status = mysql_store_result_start(&m_pResults, m_p_db);
+                } else {
+                    m_phase = Phase::Idle;
+                }
+            }
+
+            // no read or write timeouts are set on the connection so it never asks to wait on one
+            if ((status & MYSQL_WAIT_READ) != 0) {
+                events |= EPOLLIN;
+            }
+            if ((status & MYSQL_WAIT_WRITE) != 0) {
+                events |= EPOLLOUT;
+            }
+            if ((status & MYSQL_WAIT_EXCEPT) != 0) {
+                events |= EPOLLPRI;
+            }
+
+            return events;
+        }
+    }
+}
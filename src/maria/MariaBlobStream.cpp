@@ -0,0 +1,130 @@
+/**
+ * MariaBlobStream.cpp
+ */
+
+#include <cstring>
+
+#include "VariableData.h"
+#include "maria/MariaBlobStream.h"
+
+namespace afm {
+    namespace database {
+        // substring counts from 1, each read only carries its own chunk over the wire
+        static const std::string sc_blob_read = "select substring(%c, ?, ?) from %t";
+        static const std::string sc_blob_write = "update %t set %c=?";
+
+        static IVariableDataSPtr create_value(DataType type);
+
+        MariaBlobStream::MariaBlobStream(MariaConnectionSPtr pConnection, uint64_t size, bool is_writable)
+            : BlobStream(size, is_writable)
+            , m_pConnection(pConnection)
+        {
+
+        }
+
+        MariaBlobStream::~MariaBlobStream()
+        {
+            close();
+            m_pConnection = nullptr;
+        }
+
+        bool MariaBlobStream::initialize(const std::string &table_name, const std::string &column_name, const std::string &filter, const StatementValues &values)
+        {
+            bool success = false;
+            std::string query = is_writable() == true ? sc_blob_write : sc_blob_read;
+
+            query.replace(query.find("%t"), 2, table_name);
+            query.replace(query.find("%c"), 2, column_name);
+            query += filter;
+
+            if (m_pConnection != nullptr) {
+                m_pStatement = m_pConnection->getStatementCache()->acquire(query);
+            }
+
+            if (m_pStatement != nullptr) {
+                if (is_writable() == true) {
+                    // the value goes up as long data on the first parameter and is applied on execute
+                    m_values.push_back(create_value(DataType::BLOB_T));
+                    m_values.insert(m_values.end(), values.begin(), values.end());
+
+                    success = m_pStatement->bind(m_values);
+                } else {
+                    // offset and length lead, each read binds them again ahead of the filter values
+                    m_values.push_back(create_value(DataType::BIG_INT_T));
+                    m_values.push_back(create_value(DataType::INT_T));
+                    m_values.insert(m_values.end(), values.begin(), values.end());
+
+                    success = true;
+                }
+            }
+
+            if (success == false) {
+                close();
+            }
+
+            return success;
+        }
+
+        bool MariaBlobStream::on_read(uint64_t offset, uint8_t *pBuffer, uint32_t length)
+        {
+            bool success = false;
+            IVariableDataSPtr pChunk = create_value(DataType::BLOB_T);
+
+            m_values[0]->setValue((int64_t)(offset + 1));
+            m_values[1]->setValue((int32_t)length);
+
+            if ((m_pStatement->bind(m_values) == true) && (m_pStatement->execute() == true)) {
+                if (m_pStatement->fetch(StatementValues{pChunk}) == true) {
+                    BinaryBlob chunk;
+
+                    // anything shorter means the value changed under us
+                    if ((pChunk->getValue(chunk) == true) && (chunk.size() == length)) {
+                        memcpy(pBuffer, chunk.data(), length);
+                        success = true;
+                    }
+                }
+            }
+            m_pStatement->reset();
+
+            return success;
+        }
+
+        bool MariaBlobStream::on_write(uint64_t offset, const uint8_t *pData, uint32_t length)
+        {
+            return m_pStatement->sendLongData(0, pData, length);
+        }
+
+        bool MariaBlobStream::on_close(bool complete)
+        {
+            bool success = true;
+
+            if (m_pStatement != nullptr) {
+                if (is_writable() == true) {
+                    if (complete == true) {
+                        // an empty value never sent any long data, give it an empty chunk to bind
+                        if (getSize() == 0) {
+                            m_pStatement->sendLongData(0, (const uint8_t *)"", 0);
+                        }
+                        success = m_pStatement->execute();
+                    } else {
+                        // the reset on release drops the long data sent so far
+                        success = false;
+                    }
+                }
+                m_pConnection->getStatementCache()->release(m_pStatement);
+            }
+            m_values.clear();
+
+            return success;
+        }
+
+        IVariableDataSPtr create_value(DataType type)
+        {
+            IVariableDataSPtr pValue = std::make_shared<VariableData>();
+
+            pValue->initialize(type);
+
+            return pValue;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * MariaConnection.cpp
+ */
+
+#include "maria/MariaConnection.h"
+#include "maria/MariaUtility.h"
+
+namespace afm {
+    namespace database {
+        static const std::string sc_start_transaction = "start transaction";
+        static const std::string sc_start_read_only_transaction = "start transaction with consistent snapshot, read only";
+        static const std::string sc_commit_transaction = "commit";
+        static const std::string sc_rollback_transaction = "rollback";
+
+        MariaConnection::MariaConnection()
+        {
+
+        }
+
+        MariaConnection::~MariaConnection()
+        {
+            // prepared statements go before the connection they were prepared on
+            m_pStatementCache = nullptr;
+
+            if (m_p_db != nullptr) {
+                mysql_close(m_p_db);
+                m_p_db = nullptr;
+            }
+        }
+
+        bool MariaConnection::initialize(const ConnectionDetails &details, uint32_t port, const std::string &database_name)
+        {
+            bool success = false;
+
+            m_p_db = mysql_init(nullptr);
+
+            if (m_p_db != nullptr) {
+                const char *pPipeName = nullptr;
+                const char *pDatabaseName = nullptr;
+
+                if (details.named_pipe.size() > 0) {
+                    pPipeName = details.named_pipe.c_str();
+                }
+                if (database_name.size() > 0) {
+                    pDatabaseName = database_name.c_str();
+                }
+
+                // multi statements so a query batch goes over in one packet
+                if (mysql_real_connect(m_p_db, details.server_name.c_str(), details.user_id.c_str(),
+                                      details.user_password.c_str(), pDatabaseName, port,
+                                      pPipeName, CLIENT_MULTI_STATEMENTS) != nullptr) {
+                    m_pStatementCache = std::make_shared<MariaStatementCache>(m_p_db, sc_default_maria_statement_cache_size);
+                    success = true;
+                }
+            }
+
+            return success;
+        }
+
+        bool MariaConnection::isAlive()
+        {
+            return (m_p_db != nullptr) && (mysql_ping(m_p_db) == 0);
+        }
+
+        bool MariaConnection::execute(const std::string &command)
+        {
+            MYSQL_RES *pResults = nullptr;
+
+            bool success = (m_p_db != nullptr) && (issueCommand(m_p_db, command, &pResults) == true);
+            if (pResults != nullptr) {
+                mysql_free_result(pResults);
+            }
+            return success;
+        }
+
+        bool MariaConnection::on_begin(bool read_only)
+        {
+            return execute((read_only == true) ? sc_start_read_only_transaction : sc_start_transaction);
+        }
+
+        bool MariaConnection::on_commit()
+        {
+            return execute(sc_commit_transaction);
+        }
+
+        bool MariaConnection::on_rollback()
+        {
+            return execute(sc_rollback_transaction);
+        }
+
+        MariaConnectionSPtr acquireCursorConnection(const MariaConnectionPoolSPtr &pPool, bool &buffered)
+        {
+            MariaConnectionSPtr pConnection = pPool->getLease();
+
+            buffered = (pConnection != nullptr) && (pConnection->inTransaction() == true);
+            if (buffered == false) {
+                // an idle lease let go first, so it is not one the thread still holds
+                pConnection = nullptr;
+                pConnection = pPool->acquireExclusive();
+
+                // only when this thread holds the last connection itself
+                if (pConnection == nullptr) {
+                    pConnection = pPool->acquire();
+                    buffered = true;
+                }
+            }
+
+            return pConnection;
+        }
+    }
+}
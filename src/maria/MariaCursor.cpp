@@ -0,0 +1,59 @@
+/**
+ * MariaCursor.cpp
+ */
+
+#include "maria/MariaColumn.h"
+#include "maria/MariaCursor.h"
+
+namespace afm {
+    namespace database {
+
+        MariaCursor::MariaCursor(TableConstSPtr pTable, MariaConnectionSPtr pConnection, MariaStatementSPtr pStatement, const Projection &projection)
+            : Cursor(pTable, projection)
+            , m_pConnection(pConnection)
+            , m_pStatement(pStatement)
+        {
+
+        }
+
+        MariaCursor::MariaCursor(MariaConnectionSPtr pConnection, MariaStatementSPtr pStatement)
+            : Cursor()
+            , m_pConnection(pConnection)
+            , m_pStatement(pStatement)
+        {
+            ColumnDescriptions columns;
+
+            m_pStatement->describe(columns);
+            set_columns(columns);
+        }
+
+        MariaCursor::~MariaCursor()
+        {
+            close();
+        }
+
+        bool MariaCursor::on_next(IRowSPtr &pRow)
+        {
+            bool success = m_pStatement->fetch(pRow);
+
+            if ((success == false) && (m_pStatement->fetchFailed() == true)) {
+                set_failed();
+            }
+
+            return success;
+        }
+
+        void MariaCursor::on_close()
+        {
+            // the reset on release drains whatever the server has not sent yet so the connection is usable again
+            // and the lease goes back to the pool after it
+            m_pConnection->getStatementCache()->release(m_pStatement);
+            m_pConnection = nullptr;
+        }
+
+        IColumnSPtr MariaCursor::on_create_column() const
+        {
+            return std::make_shared<MariaColumn>();
+        }
+    }
+}
@@ -4,6 +4,8 @@
 
 #include <iostream>
 #include "maria/MariaDB.h"
+#include "maria/MariaAsyncConnection.h"
+#include "maria/MariaCursor.h"
 #include "maria/MariaTable.h"
 #include "maria/MariaUtility.h"
 
@@ -42,7 +44,10 @@ namespace afm {
         };
 
         static const std::string sc_show_tables = "show tables";
+        static const std::string sc_schema_version_query = "select sum(crc32(concat_ws(',', table_name, ordinal_position, column_name, column_type, "
+            "is_nullable, column_key, extra))) from information_schema.columns where table_schema = database()";
         static const std::string sc_use_database = "use %s";
+        static const std::string sc_no_connection = "no connection available";
 
         MariaDatabase::MariaDatabase()
         {
@@ -51,10 +56,8 @@ namespace afm {
 
         MariaDatabase::~MariaDatabase()
         {
-            if (m_p_db != nullptr) {
-                free(m_p_db);
-                m_p_db = nullptr;
-            }
+            // leased connections close as their tables, cursors and streams let go of them
+            m_pPool = nullptr;
         }
 
         bool MariaDatabase::initialize(const std::string &connection, const std::string &database_name)
@@ -62,38 +65,45 @@ namespace afm {
             bool success = false;
 
             if (Database::initialize(connection, database_name) == true) {
-                m_p_db = mysql_init(nullptr);
-
-                if (m_p_db != nullptr) {
-                    // now connect
-                    const ConnectionDetails &details = getConnectionDetails();
-                    const char *pPipeName = nullptr;
-
-                    if (details.named_pipe.size() > 0) {
-                        pPipeName = details.named_pipe.c_str();
+                const ConnectionDetails &details = getConnectionDetails();
+                MariaConnection bootstrap;
+
+                // connect w/o database name and then select database if it exists
+                // if it doesn't then create it and then select it
+                if (bootstrap.initialize(details, m_port, "") == true) {
+                    success = true;
+
+                    if (select_database(bootstrap.getHandle(), database_name) == false) {
+                        if (create_database(bootstrap.getHandle(), database_name) == true) {
+                            success = select_database(bootstrap.getHandle(), database_name);
+                        } else {
+                            // unable to create database, fail.
+                            success = false;
+                        }
                     }
+                }
 
-                    // connect w/o database name and then select database if it exists
-                    // if it doesn't then create it and then select it
-                    if (mysql_real_connect(m_p_db, details.server_name.c_str(), details.user_id.c_str(),
-                                          details.user_password.c_str(), nullptr, m_port,
-                                          pPipeName, CLIENT_MULTI_STATEMENTS) != nullptr) {
-
-                        success = true;
+                if (success == true) {
+                    ConnectionPoolSettings settings = get_pool_settings();
+                    uint32_t port = m_port;
 
-                        // try and select it, if it fails, try and create it
-                        if (select_database(database_name) == false) {
-                            if (create_database(database_name) == true) {
-                                success = select_database(database_name);
-                            } else {
-                                // unable to create database, fail.
-                                success = false;
-                            }
-                        }
+                    // the database now exists, so pooled connections go straight to it
+                    m_pPool = std::make_shared<MariaConnectionPool>([details, port, database_name]() {
+                        MariaConnectionSPtr pConnection = std::make_shared<MariaConnection>();
 
-                        if (success == true) {
-                            load_tables();
+                        if (pConnection->initialize(details, port, database_name) == false) {
+                            pConnection = nullptr;
                         }
+                        return pConnection;
+                    }, settings, [](const MariaConnectionSPtr &pConnection) {
+                        return pConnection->isAlive();
+                    });
+
+                    success = m_pPool->reserve(settings.min_connections);
+                    if (success == true) {
+                        load_tables();
+                    } else {
+                        m_pPool = nullptr;
                     }
                 }
             }
@@ -106,7 +116,7 @@ namespace afm {
 
             // if not found in the base class then go see if we can find it
             if (pTable == nullptr) {
-                pTable = std::make_shared<MariaTable>(m_p_db);
+                pTable = std::make_shared<MariaTable>(m_pPool);
 
                 if (pTable->initialize(name) == true) {
                     addTable(pTable);
@@ -117,13 +127,14 @@ namespace afm {
 
         ITableSPtr MariaDatabase::createTable(const TableOptions &details)
         {
-            ITableSPtr pTable = std::make_shared<MariaTable>(m_p_db);
+            ITableSPtr pTable = std::make_shared<MariaTable>(m_pPool);
 
             if (pTable->initialize(details) == true) {
                 std::string create_query = build_table_create(pTable);
+                MariaConnectionSPtr pConnection = m_pPool->acquire();
                 MYSQL_RES *pResults = nullptr;
 
-                if (issueCommand(m_p_db, create_query, &pResults) == true) {
+                if ((pConnection != nullptr) && (issueCommand(pConnection->getHandle(), create_query, &pResults) == true)) {
                     if (pResults != nullptr) {
                         mysql_free_result(pResults);
                     }
@@ -145,26 +156,95 @@ namespace afm {
 
         void MariaDatabase::load_tables()
         {
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
             MYSQL_RES *pResults = nullptr;
+            CatalogDescriptions cached;
 
-            if (issueCommand(m_p_db, sc_show_tables, &pResults) == true) {
+            if (load_schema_cache(cached) == true) {
+                // nothing to parse, the columns come straight from the cache
+                for (auto table : cached) {
+                    std::shared_ptr<MariaTable> pMariaTable = std::make_shared<MariaTable>(m_pPool);
+
+                    if (pMariaTable->initialize(table.first, table.second) == true) {
+                        ITableSPtr pTable = pMariaTable;
+
+                        addTable(pTable);
+                    }
+                }
+            } else if ((pConnection != nullptr) && (issueCommand(pConnection->getHandle(), sc_show_tables, &pResults) == true)) {
                 if (pResults != nullptr) {
                     RowData tables;
+                    TableNames preload;
 
+                    // just named handles, the columns are looked up on first use
                     if (getRows(pResults, tables) > 0) {
                         for (auto table_name : tables) {
-                            ITableSPtr pTable = std::make_shared<MariaTable>(m_p_db);
+                            ITableSPtr pTable = std::make_shared<MariaTable>(m_pPool);
                             if (pTable->initialize(table_name) == true) {
                                 addTable(pTable);
                             }
                         }
                     }
                     mysql_free_result(pResults);
+
+                    // unless asked for up front, then one round trip covers all of them
+                    if (get_preload_tables(tables, preload) == true) {
+                        CatalogDetails catalog;
+
+                        if (MariaTable::loadCatalog(pConnection->getHandle(), catalog, preload) == true) {
+                            for (auto table : catalog) {
+                                std::shared_ptr<MariaTable> pTable = std::dynamic_pointer_cast<MariaTable>(Database::getTable(table.first));
+
+                                if (pTable != nullptr) {
+                                    pTable->initialize(table.first, table.second);
+                                }
+                            }
+                        }
+                    }
+                    save_schema_cache();
+                }
+            }
+        }
+
+        bool MariaDatabase::get_schema_version(std::string &version)
+        {
+            bool success = false;
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
+            MYSQL_RES *pResults = nullptr;
+
+            if ((pConnection != nullptr) && (issueCommand(pConnection->getHandle(), sc_schema_version_query, &pResults) == true)) {
+                if (pResults != nullptr) {
+                    RowData values;
+
+                    if (getRows(pResults, values) > 0) {
+                        version = values[0];
+                        success = true;
+                    }
+                    mysql_free_result(pResults);
+                }
+            }
+
+            return success;
+        }
+
+        bool MariaDatabase::create_async_connections(uint32_t count, AsyncConnections &connections)
+        {
+            bool success = true;
+
+            for (uint32_t index = 0; (success == true) && (index < count); index++) {
+                std::shared_ptr<MariaAsyncConnection> pConnection = std::make_shared<MariaAsyncConnection>();
+
+                if (pConnection->initialize(getConnectionDetails(), m_port, getName()) == true) {
+                    connections.push_back(pConnection);
+                } else {
+                    success = false;
                 }
             }
+
+            return success;
         }
 
-        bool MariaDatabase::select_database(const std::string &name)
+        bool MariaDatabase::select_database(MYSQL *p_db, const std::string &name)
         {
             bool success = false;
             MYSQL_RES *pResults = nullptr;
@@ -173,7 +253,7 @@ namespace afm {
 
             query.replace(query.find("%s"), 2, name);
 
-            success = issueCommand(m_p_db, query, &pResults);
+            success = issueCommand(p_db, query, &pResults);
             if (pResults != nullptr) {
                 mysql_free_result(pResults);                
             }
@@ -181,7 +261,7 @@ namespace afm {
             return success;
         }
 
-        bool MariaDatabase::create_database(const std::string &name)
+        bool MariaDatabase::create_database(MYSQL *p_db, const std::string &name)
         {
             bool success = false;
             MYSQL_RES *pResults = nullptr;
@@ -190,7 +270,7 @@ namespace afm {
 
             query.replace(query.find("%s"), 2, name);
 
-            success = issueCommand(m_p_db, query, &pResults);
+            success = issueCommand(p_db, query, &pResults);
             if (pResults != nullptr) {
                 mysql_free_result(pResults);
             }
@@ -201,10 +281,10 @@ namespace afm {
         bool MariaDatabase::on_drop_table(const std::string &query)
         {
             bool success = false;
-
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
             MYSQL_RES *pResults = nullptr;
 
-            if (issueCommand(m_p_db, query, &pResults) == true) {
+            if ((pConnection != nullptr) && (issueCommand(pConnection->getHandle(), query, &pResults) == true)) {
                 if (pResults != nullptr) {
                     mysql_free_result(pResults);                
                 }
@@ -213,5 +293,64 @@ namespace afm {
 
             return success;
         }
+
+        ICursorSPtr MariaDatabase::on_query(const std::string &query, const StatementValues &values)
+        {
+            ICursorSPtr pCursor = nullptr;
+            bool buffered = false;
+            MariaConnectionSPtr pConnection = (m_pPool != nullptr) ? acquireCursorConnection(m_pPool, buffered) : nullptr;
+            MariaStatementSPtr pStatement = (pConnection != nullptr) ? pConnection->getStatementCache()->acquire(query) : nullptr;
+
+            if (pStatement != nullptr) {
+                // like a scan, unbuffered where it can be
+                if ((pStatement->bind(values) == true) && (pStatement->execute(buffered) == true)) {
+                    pCursor = std::make_shared<MariaCursor>(pConnection, pStatement);
+                } else {
+                    pConnection->getStatementCache()->release(pStatement);
+                }
+            }
+
+            return pCursor;
+        }
+
+        TransactionConnectionSPtr MariaDatabase::get_transaction_connection()
+        {
+            // held by the transaction until it ends, the thread's table calls lease the same one
+            return m_pPool != nullptr ? m_pPool->acquire() : nullptr;
+        }
+
+        void MariaDatabase::on_query_batch(const std::vector<std::string> &queries, std::vector<QueryResult> &results)
+        {
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
+            MYSQL *p_db = pConnection != nullptr ? pConnection->getHandle() : nullptr;
+            std::string batch;
+
+            // the connection takes multi statements, so the whole batch goes over as one packet
+            for (auto query : queries) {
+                if (batch.size() > 0) {
+                    batch += ";";
+                }
+                batch += query;
+            }
+
+            if (p_db == nullptr) {
+                results[0].error = sc_no_connection;
+            } else if (mysql_real_query(p_db, batch.c_str(), batch.size()) == 0) {
+                std::size_t index = 0;
+                int status = 0;
+
+                // the server stops at the first statement that fails
+                do {
+                    getResult(p_db, mysql_store_result(p_db), results[index++]);
+                    status = mysql_next_result(p_db);
+                } while ((status == 0) && (index < results.size()));
+
+                if ((status > 0) && (index < results.size())) {
+                    results[index].error = mysql_error(p_db);
+                }
+            } else {
+                results[0].error = mysql_error(p_db);
+            }
+        }
     }
 }
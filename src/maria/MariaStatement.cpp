@@ -0,0 +1,577 @@
+/**
+ * MariaStatement.cpp
+ */
+
+#include <cstring>
+
+#include "tools/tools.h"
+#include "maria/MariaStatement.h"
+
+namespace afm {
+    namespace database {
+        // text and binary results start here and grow to fit, one more byte keeps text terminated
+        static const unsigned long sc_initial_buffer_size = 256;
+        static const unsigned int sc_binary_charset = 63;
+
+        // the type a field is read into, decimals come over as doubles
+        static DataType get_field_type(const MYSQL_FIELD &field)
+        {
+            DataType type = DataType::TEXT_T;
+            bool is_binary = (field.charsetnr == sc_binary_charset);
+
+            switch (field.type) {
+                case MYSQL_TYPE_TINY:
+                {
+                    type = DataType::TINY_INT_T;
+                }
+                break;
+                case MYSQL_TYPE_SHORT:
+                case MYSQL_TYPE_YEAR:
+                {
+                    type = DataType::SMALL_INT_T;
+                }
+                break;
+                case MYSQL_TYPE_LONG:
+                case MYSQL_TYPE_INT24:
+                {
+                    type = DataType::INT_T;
+                }
+                break;
+                case MYSQL_TYPE_LONGLONG:
+                {
+                    type = DataType::BIG_INT_T;
+                }
+                break;
+                case MYSQL_TYPE_FLOAT:
+                {
+                    type = DataType::REAL_T;
+                }
+                break;
+                case MYSQL_TYPE_DOUBLE:
+                case MYSQL_TYPE_DECIMAL:
+                case MYSQL_TYPE_NEWDECIMAL:
+                {
+                    type = DataType::FLOAT_T;
+                }
+                break;
+                case MYSQL_TYPE_BIT:
+                {
+                    type = DataType::BIT_T;
+                }
+                break;
+                case MYSQL_TYPE_DATE:
+                {
+                    type = DataType::DATE_T;
+                }
+                break;
+                case MYSQL_TYPE_TIME:
+                {
+                    type = DataType::TIME_T;
+                }
+                break;
+                case MYSQL_TYPE_DATETIME:
+                case MYSQL_TYPE_TIMESTAMP:
+                {
+                    type = DataType::DATE_TIME_T;
+                }
+                break;
+                case MYSQL_TYPE_STRING:
+                case MYSQL_TYPE_VAR_STRING:
+                case MYSQL_TYPE_VARCHAR:
+                {
+                    type = (is_binary == true) ? DataType::VARBINARY_T : DataType::VARCHAR_T;
+                }
+                break;
+                case MYSQL_TYPE_TINY_BLOB:
+                case MYSQL_TYPE_BLOB:
+                case MYSQL_TYPE_MEDIUM_BLOB:
+                case MYSQL_TYPE_LONG_BLOB:
+                {
+                    type = (is_binary == true) ? DataType::BLOB_T : DataType::TEXT_T;
+                }
+                break;
+                default:
+                {
+                    // text covers what is left, null and json included
+                }
+                break;
+            }
+
+            return type;
+        }
+
+        MariaStatement::MariaStatement(MYSQL *p_db)
+            : m_p_db(p_db)
+        {
+
+        }
+
+        MariaStatement::~MariaStatement()
+        {
+            if (m_p_statement != nullptr) {
+                mysql_stmt_close(m_p_statement);
+                m_p_statement = nullptr;
+            }
+        }
+
+        bool MariaStatement::initialize(const std::string &query)
+        {
+            bool success = false;
+
+            m_query = query;
+            m_p_statement = mysql_stmt_init(m_p_db);
+
+            if (m_p_statement != nullptr) {
+                if (mysql_stmt_prepare(m_p_statement, query.c_str(), query.size()) == 0) {
+                    MYSQL_RES *pMetadata = mysql_stmt_result_metadata(m_p_statement);
+
+                    // only statements returning rows carry metadata
+                    if (pMetadata != nullptr) {
+                        MYSQL_FIELD *pFields = mysql_fetch_fields(pMetadata);
+
+                        m_field_count = mysql_num_fields(pMetadata);
+                        for (uint32_t index = 0; index < m_field_count; index++) {
+                            ColumnDescription column;
+
+                            column.name = pFields[index].name;
+                            column.type = get_field_type(pFields[index]);
+                            column.max_length = pFields[index].length;
+                            column.flags = (pFields[index].flags & NOT_NULL_FLAG) != 0 ? 0 : sc_description_null;
+
+                            m_unsigned_fields.push_back((pFields[index].flags & UNSIGNED_FLAG) != 0);
+                            m_columns.push_back(column);
+                        }
+                        mysql_free_result(pMetadata);
+                    }
+                    success = true;
+                } else {
+                    mysql_stmt_close(m_p_statement);
+                    m_p_statement = nullptr;
+                }
+            }
+
+            return success;
+        }
+
+        bool MariaStatement::bind(const StatementValues &values)
+        {
+            bool success = false;
+            std::size_t parameter_count = mysql_stmt_param_count(m_p_statement);
+
+            if (values.size() == parameter_count) {
+                MYSQL_BIND empty;
+
+                memset(&empty, 0, sizeof(empty));
+
+                // the buffers only grow, a value bound before leaves room for the next
+                m_parameters.assign(parameter_count, empty);
+                m_parameter_buffers.resize(parameter_count);
+
+                for (std::size_t index = 0; index < parameter_count; index++) {
+                    bind_parameter(m_parameters[index], m_parameter_buffers[index], values[index]);
+                }
+
+                success = (parameter_count == 0) || (mysql_stmt_bind_param(m_p_statement, m_parameters.data()) == 0);
+            }
+
+            return success;
+        }
+
+        bool MariaStatement::sendLongData(uint32_t index, const uint8_t *pData, uint32_t length)
+        {
+            return mysql_stmt_send_long_data(m_p_statement, index, (const char *)pData, length) == 0;
+        }
+
+        bool MariaStatement::execute(bool buffered)
+        {
+            bool success = (mysql_stmt_execute(m_p_statement) == 0);
+
+            if ((success == true) && (buffered == true) && (m_field_count > 0)) {
+                success = (mysql_stmt_store_result(m_p_statement) == 0);
+            }
+
+            return success;
+        }
+
+        uint64_t MariaStatement::getRowCount() const
+        {
+            return mysql_stmt_num_rows(m_p_statement);
+        }
+
+        bool MariaStatement::fetch(const IRowSPtr &pRow)
+        {
+            bool success = false;
+            StatementValues values;
+
+            for (auto column : pRow->getColumns()) {
+                values.push_back(column->getValue());
+            }
+
+            if (fetch(values) == true) {
+                pRow->clearDirtyFlag();
+                success = true;
+            }
+
+            return success;
+        }
+
+        bool MariaStatement::fetch(const StatementValues &values)
+        {
+            bool success = false;
+            int result = 1;
+
+            if ((m_results_bound == true) || (bind_results(values) == true)) {
+                result = mysql_stmt_fetch(m_p_statement);
+
+                if ((result == 0) || (result == MYSQL_DATA_TRUNCATED)) {
+                    bool rebind = false;
+
+                    success = true;
+
+                    for (std::size_t index = 0; index < m_field_count; index++) {
+                        MYSQL_BIND &bind = m_results[index];
+                        Buffer &buffer = m_result_buffers[index];
+
+                        // the value was cut short, make room and pull the rest of this column again
+                        if ((buffer.is_null == 0) && (bind.buffer == buffer.data.data()) && (buffer.length > bind.buffer_length)) {
+                            buffer.data.resize(buffer.length + 1);
+                            bind.buffer = buffer.data.data();
+                            bind.buffer_length = buffer.length;
+
+                            if (mysql_stmt_fetch_column(m_p_statement, &bind, index, 0) != 0) {
+                                success = false;
+                            }
+                            rebind = true;
+                        }
+
+                        if ((success == true) && (get_value(index, values[index]) == false)) {
+                            success = false;
+                        }
+                    }
+
+                    // the larger buffers only count from the next fetch on once bound again
+                    if (rebind == true) {
+                        mysql_stmt_bind_result(m_p_statement, m_results.data());
+                    }
+                }
+            }
+            m_fetch_failed = (success == false) && (result != MYSQL_NO_DATA);
+
+            return success;
+        }
+
+        void MariaStatement::reset()
+        {
+            mysql_stmt_free_result(m_p_statement);
+            mysql_stmt_reset(m_p_statement);
+            m_results_bound = false;
+        }
+
+        void MariaStatement::bind_parameter(MYSQL_BIND &bind, Buffer &buffer, const IVariableDataSPtr &pValue)
+        {
+            DataType type = pValue != nullptr ? pValue->getType() : DataType::EndDataTypes;
+
+            bind.buffer = &buffer.number;
+            bind.is_null = &buffer.is_null;
+            buffer.is_null = 0;
+
+            switch (type) {
+                case DataType::BIT_T:
+                {
+                    bool value = false;
+
+                    pValue->getValue(value);
+                    buffer.number.tiny = value == true ? 1 : 0;
+                    bind.buffer_type = MYSQL_TYPE_TINY;
+                }
+                break;
+                case DataType::TINY_INT_T:
+                {
+                    pValue->getValue(buffer.number.tiny);
+                    bind.buffer_type = MYSQL_TYPE_TINY;
+                }
+                break;
+                case DataType::SMALL_INT_T:
+                {
+                    pValue->getValue(buffer.number.small);
+                    bind.buffer_type = MYSQL_TYPE_SHORT;
+                }
+                break;
+                case DataType::INT_T:
+                {
+                    pValue->getValue(buffer.number.integer);
+                    bind.buffer_type = MYSQL_TYPE_LONG;
+                }
+                break;
+                case DataType::BIG_INT_T:
+                {
+                    pValue->getValue(buffer.number.big);
+                    bind.buffer_type = MYSQL_TYPE_LONGLONG;
+                }
+                break;
+                case DataType::DECIMAL_T:
+                case DataType::NUMERIC_T:
+                {
+                    pValue->getValue(buffer.number.single);
+                    bind.buffer_type = MYSQL_TYPE_FLOAT;
+                }
+                break;
+                case DataType::FLOAT_T:
+                case DataType::REAL_T:
+                {
+                    pValue->getValue(buffer.number.real);
+                    bind.buffer_type = MYSQL_TYPE_DOUBLE;
+                }
+                break;
+                case DataType::CHAR_T:
+                case DataType::VARCHAR_T:
+                case DataType::VARCHAR_MAX_T:
+                case DataType::TEXT_T:
+                case DataType::XML_T:
+                case DataType::JSON_T:
+                case DataType::CLOB_T:
+                {
+                    std::string value;
+
+                    pValue->getValue(value);
+                    buffer.data.assign(value.begin(), value.end());
+                    bind.buffer_type = MYSQL_TYPE_STRING;
+                }
+                break;
+                case DataType::BINARY_T:
+                case DataType::VARBINARY_T:
+                case DataType::VARBINARY_MAX_T:
+                case DataType::IMAGE_T:
+                case DataType::BLOB_T:
+                {
+                    BinaryBlob value;
+
+                    pValue->getValue(value);
+                    buffer.data.assign(value.begin(), value.end());
+                    bind.buffer_type = MYSQL_TYPE_BLOB;
+                }
+                break;
+                case DataType::EndDataTypes:
+                {
+                    bind.buffer_type = MYSQL_TYPE_NULL;
+                    buffer.is_null = 1;
+                }
+                break;
+                default:
+                {
+                    // dates, times and wide text go across in their text form
+                    std::string value = pValue->getValue();
+
+                    buffer.data.assign(value.begin(), value.end());
+                    bind.buffer_type = MYSQL_TYPE_STRING;
+                }
+                break;
+            }
+
+            if ((bind.buffer_type == MYSQL_TYPE_STRING) || (bind.buffer_type == MYSQL_TYPE_BLOB)) {
+                buffer.length = buffer.data.size();
+                bind.buffer = buffer.data.data();
+                bind.buffer_length = buffer.length;
+                bind.length = &buffer.length;
+            }
+        }
+
+        bool MariaStatement::bind_results(const StatementValues &values)
+        {
+            bool success = false;
+
+            if (values.size() >= m_field_count) {
+                MYSQL_BIND empty;
+
+                memset(&empty, 0, sizeof(empty));
+
+                m_results.assign(m_field_count, empty);
+                m_result_buffers.resize(m_field_count);
+                m_result_types.assign(m_field_count, DataType::EndDataTypes);
+
+                for (std::size_t index = 0; index < m_field_count; index++) {
+                    MYSQL_BIND &bind = m_results[index];
+                    Buffer &buffer = m_result_buffers[index];
+                    DataType type = values[index] != nullptr ? values[index]->getType() : DataType::EndDataTypes;
+
+                    bind.buffer = &buffer.number;
+                    bind.is_null = &buffer.is_null;
+                    bind.error = &buffer.error;
+                    bind.length = &buffer.length;
+                    bind.is_unsigned = m_unsigned_fields[index] == true ? 1 : 0;
+                    m_result_types[index] = type;
+
+                    switch (type) {
+                        case DataType::TINY_INT_T:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_TINY;
+                        }
+                        break;
+                        case DataType::SMALL_INT_T:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_SHORT;
+                        }
+                        break;
+                        case DataType::INT_T:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_LONG;
+                        }
+                        break;
+                        case DataType::BIG_INT_T:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_LONGLONG;
+                        }
+                        break;
+                        case DataType::DECIMAL_T:
+                        case DataType::NUMERIC_T:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_FLOAT;
+                        }
+                        break;
+                        case DataType::FLOAT_T:
+                        case DataType::REAL_T:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_DOUBLE;
+                        }
+                        break;
+                        case DataType::BIT_T:
+                        case DataType::BINARY_T:
+                        case DataType::VARBINARY_T:
+                        case DataType::VARBINARY_MAX_T:
+                        case DataType::IMAGE_T:
+                        case DataType::BLOB_T:
+                        {
+                            // bit columns come back as their raw bytes whatever the buffer type
+                            bind.buffer_type = MYSQL_TYPE_BLOB;
+                        }
+                        break;
+                        case DataType::EndDataTypes:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_NULL;
+                        }
+                        break;
+                        default:
+                        {
+                            bind.buffer_type = MYSQL_TYPE_STRING;
+                        }
+                        break;
+                    }
+
+                    if ((bind.buffer_type == MYSQL_TYPE_STRING) || (bind.buffer_type == MYSQL_TYPE_BLOB)) {
+                        if (buffer.data.size() == 0) {
+                            buffer.data.resize(sc_initial_buffer_size + 1);
+                        }
+                        bind.buffer = buffer.data.data();
+                        bind.buffer_length = buffer.data.size() - 1;
+                    }
+                }
+
+                m_results_bound = (mysql_stmt_bind_result(m_p_statement, m_results.data()) == 0);
+                success = m_results_bound;
+            }
+
+            return success;
+        }
+
+        bool MariaStatement::get_value(std::size_t index, const IVariableDataSPtr &pValue)
+        {
+            bool success = true;
+            Buffer &buffer = m_result_buffers[index];
+
+            // a NULL leaves the value as it was
+            if ((pValue != nullptr) && (buffer.is_null == 0)) {
+                switch (m_result_types[index]) {
+                    case DataType::BIT_T:
+                    {
+                        bool value = false;
+
+                        // raw bits from a bit column or the text of a number from anything else
+                        for (unsigned long offset = 0; offset < buffer.length; offset++) {
+                            if ((buffer.data[offset] != 0) && (buffer.data[offset] != '0')) {
+                                value = true;
+                            }
+                        }
+                        success = pValue->setValue(value);
+                    }
+                    break;
+                    case DataType::TINY_INT_T:
+                    {
+                        success = pValue->setValue(buffer.number.tiny);
+                    }
+                    break;
+                    case DataType::SMALL_INT_T:
+                    {
+                        success = pValue->setValue(buffer.number.small);
+                    }
+                    break;
+                    case DataType::INT_T:
+                    {
+                        success = pValue->setValue(buffer.number.integer);
+                    }
+                    break;
+                    case DataType::BIG_INT_T:
+                    {
+                        success = pValue->setValue(buffer.number.big);
+                    }
+                    break;
+                    case DataType::DECIMAL_T:
+                    case DataType::NUMERIC_T:
+                    {
+                        success = pValue->setValue(buffer.number.single);
+                    }
+                    break;
+                    case DataType::FLOAT_T:
+                    case DataType::REAL_T:
+                    {
+                        success = pValue->setValue(buffer.number.real);
+                    }
+                    break;
+                    case DataType::CHAR_T:
+                    case DataType::VARCHAR_T:
+                    case DataType::VARCHAR_MAX_T:
+                    case DataType::TEXT_T:
+                    case DataType::XML_T:
+                    case DataType::JSON_T:
+                    case DataType::CLOB_T:
+                    {
+                        success = pValue->setValue(std::string(buffer.data.data(), buffer.length));
+                    }
+                    break;
+                    case DataType::NCHAR_T:
+                    case DataType::NVARCHAR_T:
+                    case DataType::NVARCHAR_MAX_T:
+                    case DataType::NTEXT_T:
+                    {
+                        success = pValue->setValue(tools::utf8_to_wide(std::string(buffer.data.data(), buffer.length)));
+                    }
+                    break;
+                    case DataType::BINARY_T:
+                    case DataType::VARBINARY_T:
+                    case DataType::VARBINARY_MAX_T:
+                    case DataType::IMAGE_T:
+                    case DataType::BLOB_T:
+                    {
+                        BinaryBlob value(buffer.data.data(), buffer.data.data() + buffer.length);
+
+                        success = pValue->setValue(value);
+                    }
+                    break;
+                    case DataType::EndDataTypes:
+                    {
+                        // nothing was bound to take it
+                    }
+                    break;
+                    default:
+                    {
+                        // dates and times arrive as text, let the value parse them
+                        buffer.data[buffer.length] = 0;
+                        success = pValue->setValue(buffer.data.data(), buffer.length);
+                    }
+                    break;
+                }
+            }
+
+            return success;
+        }
+    }
+}
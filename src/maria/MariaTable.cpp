@@ -5,27 +5,40 @@
 #include <iostream>
 #include <sstream>
 #include "Row.h"
+#include "VariableData.h"
 
-#include "tools/tools.h"
 #include "maria/MariaTable.h"
+#include "maria/MariaBlobStream.h"
 #include "maria/MariaColumn.h"
+#include "maria/MariaCursor.h"
 #include "maria/MariaUtility.h"
 
 namespace afm {
     namespace database {
 
-        static const std::string sc_table_describe = "describe %s";
+        // same fields, in the same order, as describe returns them
+        static const std::string sc_catalog_query = "select table_name, column_name, column_type, is_nullable, column_key, column_default, extra "
+            "from information_schema.columns where table_schema = database()";
+        static const std::string sc_catalog_table_filter = " and table_name in (%s)";
+        static const std::string sc_catalog_order = " order by table_name, ordinal_position";
+        static const std::string sc_blob_size = "select length(%c) from %t";
+        static const std::size_t sc_max_parameters = 65535;
 
-        MariaTable::MariaTable(MYSQL *p_db)
+        static MariaStatementSPtr acquire_statement(const MariaConnectionSPtr &pConnection, const std::string &query)
+        {
+            return pConnection != nullptr ? pConnection->getStatementCache()->acquire(query) : nullptr;
+        }
+
+        MariaTable::MariaTable(MariaConnectionPoolSPtr pPool)
             : Table()
-            , m_p_db(p_db)
+            , m_pPool(pPool)
         {
 
         }
 
         MariaTable::~MariaTable()
         {
-
+            m_pPool = nullptr;
         }
 
         /*
@@ -38,179 +51,327 @@ Row: time_stamp timestamp NO current_timestamp() on update current_timestamp()
 Row: active smallint(6) YES 1 
          */
 
-        bool MariaTable::initialize(const std::string &table_name)
+        bool MariaTable::loadCatalog(MYSQL *p_db, CatalogDetails &catalog, const TableNames &tables)
         {
-            bool success = Table::initialize(table_name);
+            bool success = false;
+            MYSQL_RES *pResults = nullptr;
+            std::string query = sc_catalog_query;
 
-            if (success == true) {
-                MYSQL_RES *pResults = nullptr;
-                std::string query = sc_table_describe;
+            if (tables.size() > 0) {
+                std::string filter = sc_catalog_table_filter;
 
-                query.replace(query.find("%s"), 2, table_name);
+                filter.replace(filter.find("%s"), 2, build_name_list(tables));
+                query += filter;
+            }
+            query += sc_catalog_order;
 
-                if (issueCommand(m_p_db, query, &pResults) == true) {
-                    if (pResults != nullptr) {
-                        RowData columns;
+            if (issueCommand(p_db, query, &pResults) == true) {
+                if (pResults != nullptr) {
+                    uint32_t field_count = mysql_num_fields(pResults);
+                    MYSQL_ROW row;
 
-                        if (getRows(pResults, columns, ' ') > 0) {
-                            for (auto column : columns) {
-                                IColumnSPtr pColumn = createEmptyColumn();
+                    while ((row = mysql_fetch_row(pResults)) != nullptr) {
+                        unsigned long *pLengths = mysql_fetch_lengths(pResults);
+                        std::stringstream column;
 
-                                if (pColumn->initialize(column) == true) {
-                                    add_column(pColumn);
-                                }
+                        // the column parser expects the describe row, space separated with empty fields kept in place
+                        for (uint32_t index = 1; index < field_count; index++) {
+                            if (row[index] != nullptr) {
+                                column.write(row[index], pLengths[index]);
                             }
+                            column << " ";
                         }
-                        mysql_free_result(pResults);
-                    } else {
-                        success = false;
+                        catalog[std::string(row[0], pLengths[0])].push_back(column.str());
                     }
+                    mysql_free_result(pResults);
+                    success = true;
                 }
             }
 
             return success;
         }
 
-        bool MariaTable::get(IRowSPtr &pRow, const QueryOptions &options)
+        IColumnSPtr MariaTable::createEmptyColumn() const
         {
-            bool success = false;
-            std::string query = build_select(options);
-
-            if (query.size() > 0) {
-                MYSQL_RES *pResults = nullptr;
-                if (issueCommand(m_p_db, query, &pResults) == true) {
-                    if (pResults != nullptr) {
-                        RowData row_data;
-
-                        if (getRows(pResults, row_data, ',', true) > 0) {
-                            tools::StringTokens column_data;
-                            if (tools::split_string(column_data, row_data[0], ',', true) > 0) {
-                                pRow = createEmptyRow();
-                                pRow->setValues(column_data);
-                            }
+            return std::make_shared<MariaColumn>();
+        }
+
+        bool MariaTable::on_create_row(const std::string &query, const StatementValues &values)
+        {
+            return execute(m_pPool->acquire(), query, values);
+        }
+
+        bool MariaTable::on_create_rows(const Rows &rows, uint32_t batch_size)
+        {
+            // the transactions have to stay on the one connection, inside an open one each batch is a savepoint
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
+            uint32_t scope = 0;
+
+            if (pConnection != nullptr) {
+                scope = pConnection->beginScope();
+            }
+
+            bool success = (scope > 0);
+
+            if (success == true) {
+                // one multi row insert per batch, the column list is shared by every row
+                // so every full batch runs the same prepared statement
+                std::string insert_columns = build_insert_columns(rows[0]);
+                std::stringstream query;
+                StatementValues values;
+                uint32_t batch_count = 0;
+
+                for (auto pRow : rows) {
+                    if (batch_count == 0) {
+                        query.str("");
+                        query << insert_columns;
+                        values.clear();
+                    } else {
+                        query << ",";
+                    }
+                    query << build_insert_values(pRow, values);
+                    batch_count++;
+
+                    // a statement takes only so many parameters, end the batch before another row would go over
+                    if ((batch_count >= batch_size) || (((values.size() / batch_count) * (batch_count + 1)) > sc_max_parameters)) {
+                        success = execute(pConnection, query.str(), values);
+                        if (success == true) {
+                            success = pConnection->commitScope(scope);
                         }
-                        mysql_free_result(pResults);
-                        success = true;
+                        if (success == true) {
+                            scope = pConnection->beginScope();
+                            success = (scope > 0);
+                        }
+                        batch_count = 0;
                     }
+
+                    if (success == false) {
+                        break;
+                    }
+                }
+
+                if ((success == true) && (batch_count > 0)) {
+                    success = execute(pConnection, query.str(), values);
+                }
+
+                if (success == true) {
+                    success = pConnection->commitScope(scope);
+                }
+                if (success == false) {
+                    // only the batch in flight is lost, earlier batches are already committed
+                    pConnection->rollbackScope(scope);
                 }
             }
 
             return success;
         }
 
-        bool MariaTable::get(Rows &rows, const QueryOptions &options)
+        bool MariaTable::on_update_row(const std::string &query, const StatementValues &values)
+        {
+            return execute(m_pPool->acquire(), query, values);
+        }
+
+        bool MariaTable::on_get_row(IRowSPtr &pRow, const std::string &query, const StatementValues &values)
         {
             bool success = false;
-            std::string query = build_select(options);
-
-            rows.clear();
-
-            if (query.size() > 0) {
-                MYSQL_RES *pResults = nullptr;
-                if (issueCommand(m_p_db, query, &pResults) == true) {
-                    if (pResults != nullptr) {
-                        RowData row_data;
-
-                        if (getRows(pResults, row_data, ',', true) > 0) {
-                            for (auto row : row_data) {
-                                tools::StringTokens column_data;
-                                if (tools::split_string(column_data, row, ',', true) > 0) {
-                                    IRowSPtr pRow = createEmptyRow();
-                                    pRow->setValues(column_data);
-                                    rows.push_back(pRow);
-                                }
-                            }
-                        }
-                        mysql_free_result(pResults);
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
+            MariaStatementSPtr pStatement = acquire_statement(pConnection, query);
+
+            if (pStatement != nullptr) {
+                if ((pStatement->bind(values) == true) && (pStatement->execute() == true)) {
+                    IRowSPtr pNewRow = createEmptyRow();
+
+                    // we should warn when more than one row is returned
+                    if (pStatement->fetch(pNewRow) == true) {
+                        pRow = pNewRow;
                         success = true;
                     }
                 }
+                pConnection->getStatementCache()->release(pStatement);
             }
 
             return success;
         }
 
-        IColumnSPtr MariaTable::createEmptyColumn() const
+        bool MariaTable::on_get_rows(Rows &rows, const std::string &query, const StatementValues &values, const Projection &projection)
         {
-            return std::make_shared<MariaColumn>();
+            bool success = false;
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
+            MariaStatementSPtr pStatement = acquire_statement(pConnection, query);
+
+            if (pStatement != nullptr) {
+                if ((pStatement->bind(values) == true) && (pStatement->execute() == true)) {
+                    IRowSPtr pRow = createEmptyRow(projection);
+
+                    rows.reserve(pStatement->getRowCount());
+
+                    // each field lands in a buffer of its column type, nothing is parsed from text
+                    while (pStatement->fetch(pRow) == true) {
+                        rows.push_back(pRow);
+                        pRow = createEmptyRow(projection);
+                    }
+                    success = (pStatement->fetchFailed() == false);
+                }
+                pConnection->getStatementCache()->release(pStatement);
+            }
+
+            return success;
         }
 
-        bool MariaTable::on_create_row(const std::string &query)
+        bool MariaTable::on_get_values(AggregateRows &results, const std::string &query, const StatementValues &values, const DataTypes &types)
         {
-            MYSQL_RES *pResults = nullptr;
+            bool success = false;
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
+            MariaStatementSPtr pStatement = acquire_statement(pConnection, query);
 
-            bool success = issueCommand(m_p_db, query, &pResults);
-            if (pResults != nullptr) {
-                mysql_free_result(pResults);                
+            if (pStatement != nullptr) {
+                if ((pStatement->bind(values) == true) && (pStatement->execute() == true)) {
+                    AggregateRow row = create_values(types);
+
+                    results.reserve(pStatement->getRowCount());
+
+                    while (pStatement->fetch(row) == true) {
+                        results.push_back(row);
+                        row = create_values(types);
+                    }
+                    success = (pStatement->fetchFailed() == false);
+                }
+                pConnection->getStatementCache()->release(pStatement);
             }
+
             return success;
         }
 
-        bool MariaTable::on_update_row(const std::string &query)
+        ICursorSPtr MariaTable::on_scan(const std::string &query, const StatementValues &values, const Projection &projection)
         {
-            MYSQL_RES *pResults = nullptr;
+            ICursorSPtr pCursor = nullptr;
+            bool buffered = false;
+            MariaConnectionSPtr pConnection = acquireCursorConnection(m_pPool, buffered);
+            MariaStatementSPtr pStatement = acquire_statement(pConnection, query);
+
+            if (pStatement != nullptr) {
+                // unbuffered where it can be, the rows come over as the cursor asks for them
+                if ((pStatement->bind(values) == true) && (pStatement->execute(buffered) == true)) {
+                    pCursor = std::make_shared<MariaCursor>(shared_from_this(), pConnection, pStatement, projection);
+                } else {
+                    pConnection->getStatementCache()->release(pStatement);
+                }
+            }
 
-            bool success = issueCommand(m_p_db, query, &pResults);
-            if (pResults != nullptr) {
-                mysql_free_result(pResults);
+            return pCursor;
+        }
+
+        IColumnSPtr MariaTable::on_clone_column(const Column &column) const
+        {
+            return std::make_shared<MariaColumn>(column);
+        }
+
+        IBlobStreamSPtr MariaTable::on_read_blob(const std::string &column_name, const std::string &filter, const StatementValues &values)
+        {
+            IBlobStreamSPtr pStream = nullptr;
+            uint64_t size = 0;
+
+            if (get_blob_size(column_name, filter, values, size) == true) {
+                std::shared_ptr<MariaBlobStream> pBlobStream = std::make_shared<MariaBlobStream>(m_pPool->acquire(), size, false);
+
+                if (pBlobStream->initialize(getName(), column_name, filter, values) == true) {
+                    pStream = pBlobStream;
+                }
             }
-            return success;
+
+            return pStream;
         }
 
-        bool MariaTable::on_get_row(IRowSPtr &pRow, const std::string &query)
+        IBlobStreamSPtr MariaTable::on_write_blob(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t size)
+        {
+            IBlobStreamSPtr pStream = nullptr;
+            uint64_t current_size = 0;
+
+            // only for the row to exist, the update would quietly match nothing otherwise
+            if (get_blob_size(column_name, filter, values, current_size) == true) {
+                std::shared_ptr<MariaBlobStream> pBlobStream = std::make_shared<MariaBlobStream>(m_pPool->acquire(), size, true);
+
+                if (pBlobStream->initialize(getName(), column_name, filter, values) == true) {
+                    pStream = pBlobStream;
+                }
+            }
+
+            return pStream;
+        }
+
+        bool MariaTable::get_blob_size(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t &size)
         {
             bool success = false;
-            MYSQL_RES *pResults = nullptr;
+            std::string query = sc_blob_size;
+            MariaConnectionSPtr pConnection = nullptr;
+            MariaStatementSPtr pStatement = nullptr;
 
-            if (issueCommand(m_p_db, query, &pResults) == true) {
-                if (pResults != nullptr) {
-                    RowData row_data;
+            query.replace(query.find("%c"), 2, column_name);
+            query.replace(query.find("%t"), 2, getName());
+            query += filter;
 
-                    if (getRows(pResults, row_data, ',', true) > 0) {
-                        tools::StringTokens column_data;
-                        if (tools::split_string(column_data, row_data[0], ',', true) > 0) {
-                            pRow = createEmptyRow();
-                            pRow->setValues(column_data);
-                        }
+            pConnection = m_pPool->acquire();
+            pStatement = acquire_statement(pConnection, query);
+
+            if (pStatement != nullptr) {
+                if ((pStatement->bind(values) == true) && (pStatement->execute() == true)) {
+                    IVariableDataSPtr pSize = std::make_shared<VariableData>();
+
+                    // a null value streams as empty
+                    pSize->initialize(DataType::BIG_INT_T);
+                    pSize->setValue((int64_t)0);
+
+                    if (pStatement->fetch(StatementValues{pSize}) == true) {
+                        int64_t length = 0;
+
+                        pSize->getValue(length);
+                        size = length;
+                        success = true;
                     }
-                    mysql_free_result(pResults);
-                    success = true;
                 }
+                pConnection->getStatementCache()->release(pStatement);
             }
 
             return success;
         }
 
-        bool MariaTable::on_get_rows(Rows &rows, const std::string &query)
+        bool MariaTable::on_load_columns(ColumnDetails &columns) const
         {
             bool success = false;
+            CatalogDetails catalog;
 
-            MYSQL_RES *pResults = nullptr;
-            if (issueCommand(m_p_db, query, &pResults) == true) {
-                if (pResults != nullptr) {
-                    RowData row_data;
-
-                    if (getRows(pResults, row_data, ',', true) > 0) {
-                        for (auto row : row_data) {
-                            tools::StringTokens column_data;
-                            if (tools::split_string(column_data, row, ',', true) > 0) {
-                                IRowSPtr pRow = createEmptyRow();
-                                pRow->setValues(column_data);
-                                rows.push_back(pRow);
-                            }
-                        }
-                    }
-                    mysql_free_result(pResults);
-                    success = true;
-                }
+            MariaConnectionSPtr pConnection = m_pPool->acquire();
+
+            if ((pConnection != nullptr) && (loadCatalog(pConnection->getHandle(), catalog, {getName()}) == true)) {
+                columns = catalog[getName()];
+                success = true;
             }
 
             return success;
         }
 
-        IColumnSPtr MariaTable::on_clone_column(const Column &column) const
+        bool MariaTable::execute(const MariaConnectionSPtr &pConnection, const std::string &query)
         {
-            return std::make_shared<MariaColumn>(column);
+            MYSQL_RES *pResults = nullptr;
+
+            bool success = (pConnection != nullptr) && (issueCommand(pConnection->getHandle(), query, &pResults) == true);
+            if (pResults != nullptr) {
+                mysql_free_result(pResults);
+            }
+            return success;
+        }
+
+        bool MariaTable::execute(const MariaConnectionSPtr &pConnection, const std::string &query, const StatementValues &values)
+        {
+            bool success = false;
+            MariaStatementSPtr pStatement = acquire_statement(pConnection, query);
+
+            if (pStatement != nullptr) {
+                success = (pStatement->bind(values) == true) && (pStatement->execute() == true);
+                pConnection->getStatementCache()->release(pStatement);
+            }
+
+            return success;
         }
     }
 }
\ No newline at end of file
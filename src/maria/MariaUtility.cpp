@@ -20,6 +20,19 @@ namespace afm {
             return success;
         }
 
+        bool issueStreamingCommand(MYSQL *p_db, const std::string &command, MYSQL_RES **ppResults)
+        {
+            bool success = false;
+
+            if (mysql_real_query(p_db, command.c_str(), command.size()) == 0) {
+                // rows stay on the server side of the socket until fetched
+                *ppResults = mysql_use_result(p_db);
+                success = true;
+            }
+
+            return success;
+        }
+
         std::size_t getRows(MYSQL_RES *pResults, RowData &data, char delimiter, bool include_empty)
         {
             data.clear();
@@ -58,5 +71,61 @@ namespace afm {
             }
             return data.size();
         }
+
+        bool fetchRow(MYSQL_RES *pResults, const IRowSPtr &pRow)
+        {
+            bool success = false;
+            MYSQL_ROW row = mysql_fetch_row(pResults);
+
+            if (row != nullptr) {
+                unsigned long *pLengths = mysql_fetch_lengths(pResults);
+                uint32_t field_count = mysql_num_fields(pResults);
+
+                for (uint32_t index = 0; index < field_count; index++) {
+                    // NULL leaves the column untouched
+                    if (row[index] != nullptr) {
+                        pRow->setValue(index, row[index], pLengths[index]);
+                    }
+                }
+                pRow->clearDirtyFlag();
+                success = true;
+            }
+
+            return success;
+        }
+
+        void getResult(MYSQL *p_db, MYSQL_RES *pResults, QueryResult &result)
+        {
+            if (pResults != nullptr) {
+                uint32_t field_count = mysql_num_fields(pResults);
+                MYSQL_FIELD *pFields = mysql_fetch_fields(pResults);
+                MYSQL_ROW row;
+
+                for (uint32_t index = 0; index < field_count; index++) {
+                    result.columns.push_back(pFields[index].name);
+                }
+
+                result.rows.reserve(mysql_num_rows(pResults));
+
+                while ((row = mysql_fetch_row(pResults)) != nullptr) {
+                    unsigned long *pLengths = mysql_fetch_lengths(pResults);
+                    RowData values(field_count);
+
+                    for (uint32_t index = 0; index < field_count; index++) {
+                        if (row[index] != nullptr) {
+                            values[index].assign(row[index], pLengths[index]);
+                        }
+                    }
+                    result.rows.push_back(values);
+                }
+                mysql_free_result(pResults);
+                result.success = true;
+            } else if (mysql_field_count(p_db) == 0) {
+                result.affected_rows = mysql_affected_rows(p_db);
+                result.success = true;
+            } else {
+                result.error = mysql_error(p_db);
+            }
+        }
     }
 }
\ No newline at end of file
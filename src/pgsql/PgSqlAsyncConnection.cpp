@@ -0,0 +1,160 @@
+/**
+ * PgSqlAsyncConnection.cpp
+ */
+
+#include <sys/epoll.h>
+
+#include "pgsql/PgSqlAsyncConnection.h"
+
+namespace afm {
+    namespace database {
+
+        PgSqlAsyncConnection::PgSqlAsyncConnection()
+        {
+
+        }
+
+        PgSqlAsyncConnection::~PgSqlAsyncConnection()
+        {
+            clear_result();
+            if (m_pConnection != nullptr) {
+                PQfinish(m_pConnection);
+                m_pConnection = nullptr;
+            }
+        }
+
+        bool PgSqlAsyncConnection::initialize(const std::string &connection)
+        {
+            bool success = false;
+
+            m_pConnection = PQconnectdb(connection.c_str());
+
+            if ((m_pConnection != nullptr) && (PQstatus(m_pConnection) == CONNECTION_OK)) {
+                success = (PQsetnonblocking(m_pConnection, 1) == 0);
+            }
+
+            return success;
+        }
+
+        uint32_t PgSqlAsyncConnection::start(const std::string &query)
+        {
+            uint32_t events = 0;
+
+            clear_result();
+            m_error.clear();
+
+            if (PQsendQuery(m_pConnection, query.c_str()) == 1) {
+                // a non blocking connection may not have sent all of it yet
+                m_flushing = true;
+                events = advance();
+            } else {
+                m_error = PQerrorMessage(m_pConnection);
+            }
+
+            return events;
+        }
+
+        uint32_t PgSqlAsyncConnection::resume(uint32_t events)
+        {
+            uint32_t wait_events = 0;
+
+            // the server may answer before the query is fully sent, read whatever is there either way
+            if (((events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) && (PQconsumeInput(m_pConnection) == 0)) {
+                m_error = PQerrorMessage(m_pConnection);
+            } else {
+                wait_events = advance();
+            }
+
+            return wait_events;
+        }
+
+        void PgSqlAsyncConnection::getResult(QueryResult &result)
+        {
+            ExecStatusType status = m_pResult != nullptr ? PQresultStatus(m_pResult) : PGRES_FATAL_ERROR;
+
+            result.success = (m_error.size() == 0) && ((status == PGRES_TUPLES_OK) || (status == PGRES_COMMAND_OK));
+
+            if (result.success == true) {
+                int field_count = PQnfields(m_pResult);
+                int row_count = PQntuples(m_pResult);
+                std::string affected = PQcmdTuples(m_pResult);
+
+                for (int index = 0; index < field_count; index++) {
+                    result.columns.push_back(PQfname(m_pResult, index));
+                }
+
+                result.rows.reserve(row_count);
+
+                for (int row = 0; row < row_count; row++) {
+                    RowData values(field_count);
+
+                    for (int index = 0; index < field_count; index++) {
+                        if (PQgetisnull(m_pResult, row, index) == 0) {
+                            values[index].assign(PQgetvalue(m_pResult, row, index), PQgetlength(m_pResult, row, index));
+                        }
+                    }
+                    result.rows.push_back(values);
+                }
+
+                if (affected.size() > 0) {
+                    result.affected_rows = std::stoull(affected);
+                }
+            } else if (m_error.size() > 0) {
+                result.error = m_error;
+            } else if (m_pResult != nullptr) {
+                result.error = PQresultErrorMessage(m_pResult);
+            }
+            clear_result();
+        }
+
+        uint32_t PgSqlAsyncConnection::advance()
+        {
+            uint32_t events = 0;
+
+            if (m_flushing == true) {
+                int flushed = PQflush(m_pConnection);
+
+                if (flushed == 1) {
+                    events = EPOLLIN | EPOLLOUT;
+                } else if (flushed == 0) {
+                    m_flushing = false;
+                } else {
+                    m_error = PQerrorMessage(m_pConnection);
+                }
+            }
+
+            if ((m_flushing == false) && (m_error.size() == 0)) {
+                bool done = false;
+
+                // every result has to be taken off before the connection takes another query
+                while ((done == false) && (PQisBusy(m_pConnection) == 0)) {
+                    PGresult *pResult = PQgetResult(m_pConnection);
+
+                    if (pResult == nullptr) {
+                        done = true;
+                    } else if ((m_pResult == nullptr) || (PQresultStatus(m_pResult) != PGRES_FATAL_ERROR)) {
+                        // the last result stands unless an earlier one failed
+                        clear_result();
+                        m_pResult = pResult;
+                    } else {
+                        PQclear(pResult);
+                    }
+                }
+
+                if (done == false) {
+                    events = EPOLLIN;
+                }
+            }
+
+            return events;
+        }
+
+        void PgSqlAsyncConnection::clear_result()
+        {
+            if (m_pResult != nullptr) {
+                PQclear(m_pResult);
+                m_pResult = nullptr;
+            }
+        }
+    }
+}
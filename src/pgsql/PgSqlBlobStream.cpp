@@ -0,0 +1,163 @@
+/**
+ * PgSqlBlobStream.cpp
+ */
+
+#include <atomic>
+#include <cstring>
+
+#include "pgsql/PgSqlBlobStream.h"
+#include "pgsql/PgSqlUtility.h"
+
+namespace afm {
+    namespace database {
+        // substring on bytea counts from 1, each read only carries its own chunk over the wire
+        static const std::string sc_blob_read = "select substring(%c from %o for %l) from %t";
+
+        // written chunks wait server side and are put together once, rather than appended to the value one by one
+        static const std::string sc_chunk_prefix = "afm_blob_";
+        static const std::string sc_chunk_create = "create temporary table %s (seq integer, chunk bytea) on commit drop";
+        static const std::string sc_chunk_insert = "insert into %s values (%d, %v)";
+        static const std::string sc_blob_write = "update %t set %c=coalesce((select string_agg(chunk, ''::bytea order by seq) from %s), ''::bytea)";
+
+        static std::atomic<uint64_t> s_blob_id(0);
+
+        PgSqlBlobStream::PgSqlBlobStream(PgSqlSessionSPtr pSession, uint64_t size, bool is_writable)
+            : BlobStream(size, is_writable)
+            , m_pSession(pSession)
+        {
+            m_chunk_table = sc_chunk_prefix + std::to_string(s_blob_id++);
+        }
+
+        PgSqlBlobStream::~PgSqlBlobStream()
+        {
+            close();
+            m_pSession = nullptr;
+        }
+
+        bool PgSqlBlobStream::initialize(const std::string &table_name, const std::string &column_name, const std::string &filter, const StatementValues &values)
+        {
+            bool success = false;
+
+            m_query = is_writable() == true ? sc_blob_write : sc_blob_read;
+
+            m_query.replace(m_query.find("%t"), 2, table_name);
+            m_query.replace(m_query.find("%c"), 2, column_name);
+            if (is_writable() == true) {
+                m_query.replace(m_query.find("%s"), 2, m_chunk_table);
+            }
+            m_query += filter;
+            m_values = values;
+
+            try {
+                // reads see one version of the value, writes only land on commit
+                m_pTransaction = m_pSession->getTransaction();
+                if (m_pTransaction == nullptr) {
+                    m_pWork = std::make_unique<pqxx::work>(*m_pSession->getConnection());
+                    m_pTransaction = m_pWork.get();
+                } else {
+                    // the session ends its transaction, this has to be closed before it does
+                    m_user_id = m_pSession->attach([this]() { close(); });
+                }
+
+                if (is_writable() == true) {
+                    std::string create = sc_chunk_create;
+
+                    create.replace(create.find("%s"), 2, m_chunk_table);
+                    m_pTransaction->exec(create);
+                }
+                success = true;
+            }
+            catch (const std::exception &db_error) {
+                m_pWork = nullptr;
+                m_pTransaction = nullptr;
+                close();
+            }
+
+            return success;
+        }
+
+        bool PgSqlBlobStream::on_read(uint64_t offset, uint8_t *pBuffer, uint32_t length)
+        {
+            bool success = false;
+            std::string query = m_query;
+
+            query.replace(query.find("%o"), 2, std::to_string(offset + 1));
+            query.replace(query.find("%l"), 2, std::to_string(length));
+
+            try {
+                pqxx::result results = m_pTransaction->exec_params(query, getParameters(m_values));
+
+                if ((results.size() > 0) && (results[0][0].is_null() == false)) {
+                    pqxx::binarystring chunk(results[0][0]);
+
+                    // anything shorter means the value changed under us
+                    if (chunk.size() == length) {
+                        memcpy(pBuffer, chunk.data(), length);
+                        success = true;
+                    }
+                }
+            }
+            catch (const std::exception &db_error) {
+                success = false;
+            }
+
+            return success;
+        }
+
+        bool PgSqlBlobStream::on_write(uint64_t offset, const uint8_t *pData, uint32_t length)
+        {
+            bool success = false;
+            std::string query = sc_chunk_insert;
+
+            try {
+                query.replace(query.find("%s"), 2, m_chunk_table);
+                query.replace(query.find("%d"), 2, std::to_string(m_chunk_count));
+                query.replace(query.find("%v"), 2, m_pTransaction->quote_raw(pData, length));
+
+                m_pTransaction->exec(query);
+                m_chunk_count++;
+                success = true;
+            }
+            catch (const std::exception &db_error) {
+                success = false;
+            }
+
+            return success;
+        }
+
+        bool PgSqlBlobStream::on_close(bool complete)
+        {
+            bool success = false;
+
+            if (m_pTransaction != nullptr) {
+                try {
+                    // a borrowed transaction is left for the session to end, an unfinished
+                    // value there simply never reaches the column
+                    if ((is_writable() == false) || (complete == true)) {
+                        if (is_writable() == true) {
+                            m_pTransaction->exec_params(m_query, getParameters(m_values));
+                        }
+                        if (m_pWork != nullptr) {
+                            m_pWork->commit();
+                        }
+                        success = true;
+                    } else if (m_pWork != nullptr) {
+                        m_pWork->abort();
+                    }
+                }
+                catch (const std::exception &db_error) {
+                    // nothing more to do, the transaction is rolled back on destruction
+                }
+                m_pTransaction = nullptr;
+                m_pWork = nullptr;
+            }
+
+            if (m_user_id != 0) {
+                m_pSession->detach(m_user_id);
+                m_user_id = 0;
+            }
+
+            return success;
+        }
+    }
+}
@@ -14,6 +14,7 @@ namespace afm {
         static const std::string sc_cannotBeNull = "NO";
         static const std::string sc_isIdentity = "YES";
         static const std::string sc_isNotIdentity = "NO";
+        static const std::string sc_bytea_type = "BYTEA";
 
         PgSqlColumn::PgSqlColumn()
             : Column()
@@ -344,12 +345,13 @@ namespace afm {
 
             static const std::string sc_blob_type = "BLOB";
             static const std::string sc_binary_type  = "BINARY";
+            static const std::string sc_bytea_type = "BYTEA";
         */
         DataType PgSqlColumn::is_binary(const std::string &type, bool is_unsigned)
         {
             DataType DataType = DataType::EndDataTypes;
 
-            if (type.find(sc_blob_type) != std::string::npos) {
+            if ((type.find(sc_blob_type) != std::string::npos) || (type.find(sc_bytea_type) != std::string::npos)) {
                 DataType = DataType::BLOB_T;
             } else if (type.find(sc_binary_type) != std::string::npos) {
                 DataType = DataType::BINARY_T;
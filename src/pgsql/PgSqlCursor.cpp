@@ -0,0 +1,146 @@
+/**
+ * PgSqlCursor.cpp
+ */
+
+#include <atomic>
+
+#include "pgsql/PgSqlColumn.h"
+#include "pgsql/PgSqlCursor.h"
+#include "pgsql/PgSqlUtility.h"
+
+namespace afm {
+    namespace database {
+        static const std::string sc_cursor_prefix = "afm_cursor_";
+        static const std::string sc_cursor_declare = "declare %s no scroll cursor for ";
+        static const std::string sc_cursor_fetch = "fetch %d from %s";
+        static const std::string sc_cursor_close = "close ";
+
+        static std::atomic<uint64_t> s_cursor_id(0);
+
+        PgSqlCursor::PgSqlCursor(TableConstSPtr pTable, PgSqlSessionSPtr pSession, const Projection &projection, uint32_t fetch_size)
+            : Cursor(pTable, projection)
+            , m_pSession(pSession)
+            , m_fetch_size(fetch_size)
+        {
+            m_name = sc_cursor_prefix + std::to_string(s_cursor_id++);
+        }
+
+        PgSqlCursor::PgSqlCursor(PgSqlSessionSPtr pSession, uint32_t fetch_size)
+            : Cursor()
+            , m_pSession(pSession)
+            , m_fetch_size(fetch_size)
+            , m_describe(true)
+        {
+            m_name = sc_cursor_prefix + std::to_string(s_cursor_id++);
+        }
+
+        PgSqlCursor::~PgSqlCursor()
+        {
+            close();
+            m_pSession = nullptr;
+        }
+
+        bool PgSqlCursor::initialize(const std::string &query, const StatementValues &values)
+        {
+            bool success = false;
+            std::string declare = sc_cursor_declare;
+
+            declare.replace(declare.find("%s"), 2, m_name);
+
+            try {
+                // a cursor only lives as long as the transaction around it, the session's when it has one open
+                m_pTransaction = m_pSession->getTransaction();
+                if (m_pTransaction == nullptr) {
+                    m_pWork = std::make_unique<pqxx::work>(*m_pSession->getConnection());
+                    m_pTransaction = m_pWork.get();
+                } else {
+                    // the session ends its transaction, this has to be closed before it does
+                    m_user_id = m_pSession->attach([this]() { close(); });
+                }
+                m_pTransaction->exec_params(declare + query, getParameters(values));
+                success = true;
+            }
+            catch (const std::exception &db_error) {
+                m_pWork = nullptr;
+                m_pTransaction = nullptr;
+                close();
+            }
+
+            // a query's rows are described by its first batch, even an empty one carries the columns
+            if ((success == true) && (m_describe == true)) {
+                ColumnDescriptions columns;
+
+                fetch();
+                describe(m_results, columns);
+                set_columns(columns);
+            }
+
+            return success;
+        }
+
+        IColumnSPtr PgSqlCursor::on_create_column() const
+        {
+            return std::make_shared<PgSqlColumn>();
+        }
+
+        bool PgSqlCursor::on_next(IRowSPtr &pRow)
+        {
+            bool success = false;
+
+            if ((m_position < m_results.size()) || (fetch() == true)) {
+                success = getRow(m_results[m_position++], pRow);
+                if (success == false) {
+                    set_failed();
+                }
+            }
+
+            return success;
+        }
+
+        void PgSqlCursor::on_close()
+        {
+            if (m_pTransaction != nullptr) {
+                try {
+                    m_pTransaction->exec(sc_cursor_close + m_name);
+
+                    // a borrowed transaction is left for the session to end
+                    if (m_pWork != nullptr) {
+                        m_pWork->commit();
+                    }
+                }
+                catch (const std::exception &db_error) {
+                    // nothing more to do, the transaction is rolled back on destruction
+                }
+                m_pTransaction = nullptr;
+                m_pWork = nullptr;
+            }
+
+            if (m_user_id != 0) {
+                m_pSession->detach(m_user_id);
+                m_user_id = 0;
+            }
+        }
+
+        bool PgSqlCursor::fetch()
+        {
+            bool success = false;
+            std::string query = sc_cursor_fetch;
+
+            query.replace(query.find("%d"), 2, std::to_string(m_fetch_size));
+            query.replace(query.find("%s"), 2, m_name);
+
+            try {
+                // only one batch is ever held in memory
+                m_results = m_pTransaction->exec(query);
+                m_position = 0;
+                success = (m_results.size() > 0);
+            }
+            catch (const std::exception &db_error) {
+                set_failed();
+                success = false;
+            }
+
+            return success;
+        }
+    }
+}
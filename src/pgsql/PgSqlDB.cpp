@@ -6,6 +6,8 @@
 #include <sstream>
 #include <cstring>
 #include "pgsql/PgSqlDB.h"
+#include "pgsql/PgSqlAsyncConnection.h"
+#include "pgsql/PgSqlCursor.h"
 #include "pgsql/PgSqlTable.h"
 #include "pgsql/PgSqlUtility.h"
 
@@ -17,12 +19,16 @@ namespace afm {
         static const std::string sc_conneciton_host_address = "hostaddr";
         static const std::string sc_connection_port = "port";
         static const std::string sc_default_db = "postgres";
-        static const std::string sc_list_tables = "select * from pg_catalog.pg_tables";
-        static const std::string sc_ignore_schema1 = "pg_catalog";
-        static const std::string sc_ignore_schema2 = "information_schema";
-        static const uint8_t sc_schema_name_position = 0;
-        static const uint8_t sc_table_name_position = 1;
+        static const std::string sc_list_tables = "select tablename from pg_catalog.pg_tables where schemaname not in ('pg_catalog', 'information_schema')";
         static const std::string sc_serial_field = "serial";
+        static const std::string sc_no_connection = "no connection available";
+
+        // any change to a user table's columns rewrites its pg_attribute rows and so their xmin
+        static const std::string sc_schema_version_query = "select md5(string_agg(a.attrelid::text || '.' || a.attnum::text || '.' || a.xmin::text, ',' "
+            "order by a.attrelid, a.attnum)) from pg_catalog.pg_attribute a "
+            "join pg_catalog.pg_class c on c.oid = a.attrelid "
+            "join pg_catalog.pg_namespace n on n.oid = c.relnamespace "
+            "where c.relkind = 'r' and a.attnum > 0 and n.nspname not in ('pg_catalog', 'information_schema')";
 
         PgSqlDatabase::PgSqlDatabase()
             : Database()
@@ -33,9 +39,7 @@ namespace afm {
 
         PgSqlDatabase::~PgSqlDatabase()
         {
-            if (m_pConnection != nullptr) {
-                delete m_pConnection;
-            }
+            m_pPool = nullptr;
         }
 
         bool PgSqlDatabase::initialize(const std::string &connection, const std::string &database_name)
@@ -64,7 +68,7 @@ namespace afm {
 
             // if not found in the base class then go see if we can find it
             if (pTable == nullptr) {
-                pTable = std::make_shared<PgSqlTable>(m_pConnection);
+                pTable = std::make_shared<PgSqlTable>(m_pPool, m_connection_string);
 
                 if (pTable->initialize(name) == true) {
                     addTable(pTable);
@@ -75,16 +79,17 @@ namespace afm {
 
         ITableSPtr PgSqlDatabase::createTable(const TableOptions &details)
         {
-            ITableSPtr pTable = std::make_shared<PgSqlTable>(m_pConnection);
+            ITableSPtr pTable = std::make_shared<PgSqlTable>(m_pPool, m_connection_string);
 
             if (pTable->initialize(details) == true) {
 
                 std::string create_query = build_table_create(pTable);
+                PgSqlSessionSPtr pSession = m_pPool->acquire();
                 pqxx::result results;
 
                 std::cout << "Query: " << create_query << "\n";
 
-                if (issueCommand(m_pConnection, create_query, results) == true) {
+                if ((pSession != nullptr) && (pSession->execute(create_query, results) == true)) {
                     addTable(pTable);
                 } else {
                     pTable = nullptr;
@@ -111,22 +116,85 @@ orville=> select * from pg_catalog.pg_tables where tableowner='daniel';
          */
         void PgSqlDatabase::load_tables()
         {
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
             pqxx::result results;
+            CatalogDescriptions cached;
+
+            if (load_schema_cache(cached) == true) {
+                // nothing to parse, the columns come straight from the cache
+                for (auto table : cached) {
+                    std::shared_ptr<PgSqlTable> pPgSqlTable = std::make_shared<PgSqlTable>(m_pPool, m_connection_string);
 
-            if (issueCommand(m_pConnection, sc_list_tables, results) == true) {
+                    if (pPgSqlTable->initialize(table.first, table.second) == true) {
+                        ITableSPtr pTable = pPgSqlTable;
+
+                        addTable(pTable);
+                    }
+                }
+            } else if ((pSession != nullptr) && (pSession->execute(sc_list_tables, results) == true)) {
+                TableNames tables;
+                TableNames preload;
+
+                // just named handles, the columns are looked up on first use
                 for (auto iter : results) {
-                    if ((strcmp(iter[sc_schema_name_position].c_str(), sc_ignore_schema1.c_str()) != 0) &&
-                        (strcmp(iter[sc_schema_name_position].c_str(), sc_ignore_schema2.c_str()) != 0)) {
-                        // process this one
-                        std::string table_name = iter[sc_table_name_position].c_str();
-
-                        ITableSPtr pTable = std::make_shared<PgSqlTable>(m_pConnection);
-                        if (pTable->initialize(table_name) == true) {
-                            addTable(pTable);
+                    ITableSPtr pTable = std::make_shared<PgSqlTable>(m_pPool, m_connection_string);
+
+                    tables.push_back(iter[0].c_str());
+                    if (pTable->initialize(tables.back()) == true) {
+                        addTable(pTable);
+                    }
+                }
+
+                // unless asked for up front, then one round trip covers all of them
+                if (get_preload_tables(tables, preload) == true) {
+                    CatalogDetails catalog;
+
+                    if (PgSqlTable::loadCatalog(pSession, catalog, preload) == true) {
+                        for (auto table : catalog) {
+                            std::shared_ptr<PgSqlTable> pTable = std::dynamic_pointer_cast<PgSqlTable>(Database::getTable(table.first));
+
+                            if (pTable != nullptr) {
+                                pTable->initialize(table.first, table.second);
+                            }
                         }
                     }
                 }
+                save_schema_cache();
+            }
+        }
+
+        bool PgSqlDatabase::get_schema_version(std::string &version)
+        {
+            bool success = false;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            pqxx::result results;
+
+            if ((pSession != nullptr) && (pSession->execute(sc_schema_version_query, results) == true)) {
+                if ((results.size() > 0) && (results[0][0].is_null() == false)) {
+                    version = results[0][0].c_str();
+                    success = true;
+                }
             }
+
+            return success;
+        }
+
+        bool PgSqlDatabase::create_async_connections(uint32_t count, AsyncConnections &connections)
+        {
+            bool success = true;
+
+            // same database the blocking connection ended up on
+            for (uint32_t index = 0; (success == true) && (index < count); index++) {
+                std::shared_ptr<PgSqlAsyncConnection> pConnection = std::make_shared<PgSqlAsyncConnection>();
+
+                if (pConnection->initialize(m_connection_string) == true) {
+                    connections.push_back(pConnection);
+                } else {
+                    success = false;
+                }
+            }
+
+            return success;
         }
 
         bool PgSqlDatabase::select_database(const std::string &name)
@@ -143,25 +211,26 @@ orville=> select * from pg_catalog.pg_tables where tableowner='daniel';
             connection << sc_conneciton_host_address << "=" << details.server_name << " ";
             connection << sc_connection_port << "=" << details.port << " ";
 
-            try {
-                if (m_pConnection != nullptr) {
-                    delete m_pConnection;
-                    m_pConnection = nullptr;
-                }
+            ConnectionPoolSettings settings = get_pool_settings();
+            std::string connection_string = connection.str();
 
-                m_pConnection = new pqxx::connection(connection.str().c_str());
-                if (m_pConnection != nullptr) {
-                    if (m_pConnection->is_open() == true) {
-                        success = true;
-                    } else {
-                        delete m_pConnection;
-                        m_pConnection = nullptr;
-                    }
+            m_pPool = std::make_shared<PgSqlSessionPool>([connection_string]() {
+                PgSqlSessionSPtr pSession = std::make_shared<PgSqlSession>(connection_string);
+
+                if (pSession->initialize() == false) {
+                    pSession = nullptr;
                 }
-            }
-            catch (const std::exception &db_error) {
-                m_pConnection = nullptr;
-                success = false;
+                return pSession;
+            }, settings, [](const PgSqlSessionSPtr &pSession) {
+                return pSession->isAlive();
+            });
+
+            // opening the minimum up front is what tells us the database is there
+            if (m_pPool->reserve(settings.min_connections) == true) {
+                m_connection_string = connection_string;
+                success = true;
+            } else {
+                m_pPool = nullptr;
             }
             return success;
         }
@@ -171,11 +240,12 @@ orville=> select * from pg_catalog.pg_tables where tableowner='daniel';
             bool success = false;
             pqxx::result results;
 
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
             std::string query = sc_create_database;
 
             query.replace(query.find("%s"), 2, name);
 
-            if (issueCommand(m_pConnection, query, results) == true) {
+            if ((pSession != nullptr) && (pSession->execute(query, results) == true)) {
                 success = true;
             }
 
@@ -208,9 +278,80 @@ orville=> select * from pg_catalog.pg_tables where tableowner='daniel';
 
         bool PgSqlDatabase::on_drop_table(const std::string &query)
         {
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
             pqxx::result results;
 
-            return issueCommand(m_pConnection, query, results);
+            return (pSession != nullptr) && (pSession->execute(query, results) == true);
+        }
+
+        ICursorSPtr PgSqlDatabase::on_query(const std::string &query, const StatementValues &values)
+        {
+            PgSqlSessionSPtr pSession = (m_pPool != nullptr) ? acquireCursorSession(m_pPool) : nullptr;
+            std::shared_ptr<PgSqlCursor> pCursor = (pSession != nullptr) ? std::make_shared<PgSqlCursor>(pSession) : nullptr;
+
+            // declared as a server side cursor, so only statements that return rows
+            if ((pCursor != nullptr) && (pCursor->initialize(query, values) == false)) {
+                pCursor = nullptr;
+            }
+
+            return pCursor;
+        }
+
+        TransactionConnectionSPtr PgSqlDatabase::get_transaction_connection()
+        {
+            // held by the transaction until it ends, the thread's table calls lease the same one
+            return m_pPool != nullptr ? m_pPool->acquire() : nullptr;
+        }
+
+        void PgSqlDatabase::on_query_batch(const std::vector<std::string> &queries, std::vector<QueryResult> &results)
+        {
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+
+            if (pSession == nullptr) {
+                results[0].error = sc_no_connection;
+            } else {
+                try {
+                    // the pipeline keeps sending without waiting on each answer, all of it in one
+                    // transaction, the session's when it has one open
+                    std::unique_ptr<pqxx::work> pWork = nullptr;
+                    pqxx::transaction_base *pTransaction = pSession->getTransaction();
+
+                    if (pTransaction == nullptr) {
+                        pWork = std::make_unique<pqxx::work>(*pSession->getConnection());
+                        pTransaction = pWork.get();
+                    }
+
+                    pqxx::pipeline pipeline(*pTransaction);
+                    std::vector<pqxx::pipeline::query_id> query_ids;
+                    bool success = true;
+
+                    for (auto query : queries) {
+                        query_ids.push_back(pipeline.insert(query));
+                    }
+                    pipeline.complete();
+
+                    for (std::size_t index = 0; (success == true) && (index < query_ids.size()); index++) {
+                        try {
+                            getResult(pipeline.retrieve(query_ids[index]), results[index]);
+                        }
+                        catch (const std::exception &db_error) {
+                            results[index].error = db_error.what();
+                            success = false;
+                        }
+                    }
+
+                    // a failure rolls back the writes that came before it
+                    if ((success == true) && (pWork != nullptr)) {
+                        pWork->commit();
+                    }
+                }
+                catch (const std::exception &db_error) {
+                    for (auto &result : results) {
+                        result.success = false;
+                        result.error = db_error.what();
+                    }
+                }
+            }
         }
   }
 }
\ No newline at end of file
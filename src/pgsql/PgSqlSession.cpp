@@ -0,0 +1,276 @@
+/**
+ * PgSqlSession.cpp
+ */
+
+#include "pgsql/PgSqlSession.h"
+#include "pgsql/PgSqlUtility.h"
+
+namespace afm {
+    namespace database {
+        static const std::string sc_statement_prefix = "afm_statement_";
+        static const std::string sc_alive_query = "select 1";
+
+        using SnapshotTransaction = pqxx::transaction<pqxx::isolation_level::repeatable_read, pqxx::write_policy::read_only>;
+
+        PgSqlSession::PgSqlSession(const std::string &connection_string, std::size_t statement_capacity)
+            : m_connection_string(connection_string)
+            , m_statement_capacity(statement_capacity)
+        {
+
+        }
+
+        PgSqlSession::~PgSqlSession()
+        {
+            // anything not committed is rolled back with the transaction
+            close_users();
+            m_pTransaction = nullptr;
+
+            // prepared statements go away with the connection
+            m_statements.clear();
+            m_lookup.clear();
+            m_pRawConnection = nullptr;
+            m_pConnection = nullptr;
+        }
+
+        bool PgSqlSession::initialize()
+        {
+            bool success = false;
+            PGconn *pConnection = PQconnectdb(m_connection_string.c_str());
+
+            try {
+                // opened here so the statements pqxx cannot run binary can still reach it
+                if (PQstatus(pConnection) == CONNECTION_OK) {
+                    m_pConnection = std::make_unique<pqxx::connection>(pqxx::connection::seize_raw_connection(pConnection));
+                    m_pRawConnection = pConnection;
+                    success = m_pConnection->is_open();
+                }
+            }
+            catch (const std::exception &db_error) {
+                m_pConnection = nullptr;
+            }
+
+            if (m_pConnection == nullptr) {
+                PQfinish(pConnection);
+            }
+
+            return success;
+        }
+
+        bool PgSqlSession::isAlive()
+        {
+            bool success = false;
+            pqxx::result result;
+
+            if ((m_pConnection != nullptr) && (m_pConnection->is_open() == true)) {
+                success = execute(sc_alive_query, result);
+            }
+
+            return success;
+        }
+
+        bool PgSqlSession::begin(PgSqlSessionMode mode)
+        {
+            bool success = false;
+
+            if ((m_mode == PgSqlSessionMode::AutoCommit) && (m_pConnection != nullptr)) {
+                try {
+                    if (mode == PgSqlSessionMode::ReadSnapshot) {
+                        m_pTransaction = std::make_unique<SnapshotTransaction>(*m_pConnection);
+                        m_mode = mode;
+                        success = true;
+                    } else if (mode == PgSqlSessionMode::Write) {
+                        m_pTransaction = std::make_unique<pqxx::work>(*m_pConnection);
+                        m_mode = mode;
+                        success = true;
+                    } else if (mode == PgSqlSessionMode::AutoCommit) {
+                        success = true;
+                    }
+                }
+                catch (const std::exception &db_error) {
+                    m_pTransaction = nullptr;
+                }
+            }
+
+            return success;
+        }
+
+        bool PgSqlSession::commit()
+        {
+            bool success = false;
+
+            if (m_pTransaction != nullptr) {
+                close_users();
+
+                try {
+                    m_pTransaction->commit();
+                    success = true;
+                }
+                catch (const std::exception &db_error) {
+                    success = false;
+                }
+                m_pTransaction = nullptr;
+                m_mode = PgSqlSessionMode::AutoCommit;
+
+                // ended outside of its scopes takes them with it
+                reset_scopes();
+            }
+
+            return success;
+        }
+
+        bool PgSqlSession::rollback()
+        {
+            bool success = false;
+
+            if (m_pTransaction != nullptr) {
+                close_users();
+
+                try {
+                    m_pTransaction->abort();
+                    success = true;
+                }
+                catch (const std::exception &db_error) {
+                    success = false;
+                }
+                m_pTransaction = nullptr;
+                m_mode = PgSqlSessionMode::AutoCommit;
+
+                // ended outside of its scopes takes them with it
+                reset_scopes();
+            }
+
+            return success;
+        }
+
+        uint64_t PgSqlSession::attach(TransactionUser close_user)
+        {
+            uint64_t user_id = ++m_user_id;
+
+            m_users[user_id] = close_user;
+
+            return user_id;
+        }
+
+        void PgSqlSession::detach(uint64_t user_id)
+        {
+            m_users.erase(user_id);
+        }
+
+        void PgSqlSession::close_users()
+        {
+            std::map<uint64_t, TransactionUser> users;
+
+            // taken first, each one detaches itself as it closes
+            users.swap(m_users);
+            for (auto &user : users) {
+                user.second();
+            }
+        }
+
+        bool PgSqlSession::execute(const std::string &query, pqxx::result &result)
+        {
+            bool success = false;
+
+            if (m_pTransaction != nullptr) {
+                try {
+                    result = m_pTransaction->exec(query);
+                    success = true;
+                }
+                catch (const std::exception &db_error) {
+                    // the server has aborted the transaction, only a rollback ends it now
+                    success = false;
+                }
+            } else {
+                success = issueCommand(m_pConnection.get(), query, result);
+            }
+
+            return success;
+        }
+    
+
+        bool PgSqlSession::on_execute(const std::string &command)
+        {
+            pqxx::result result;
+
+            return execute(command, result);
+        }
+
+        bool PgSqlSession::execute(const std::string &query, const StatementValues &values, PgSqlResult &result)
+        {
+            bool success = false;
+            PreparedStatement statement;
+
+            if (prepare(query, statement) == true) {
+                PgSqlParameters parameters;
+                ExecStatusType status = PGRES_FATAL_ERROR;
+
+                // inside a transaction it runs within it, the server aborts it on a failure as it would for pqxx
+                getParameters(values, parameters);
+                result.reset(PQexecPrepared(m_pRawConnection, statement.name.c_str(), (int)values.size(), parameters.values.data(),
+                                            parameters.lengths.data(), parameters.formats.data(), statement.result_format));
+
+                status = (result != nullptr) ? PQresultStatus(result.get()) : PGRES_FATAL_ERROR;
+                success = (status == PGRES_COMMAND_OK) || (status == PGRES_TUPLES_OK);
+            }
+
+            return success;
+        }
+
+        bool PgSqlSession::prepare(const std::string &query, PreparedStatement &statement)
+        {
+            bool success = false;
+            StatementMap::iterator entry = m_lookup.find(query);
+
+            if (entry != m_lookup.end()) {
+                // most recently used moves to the front
+                m_statements.splice(m_statements.begin(), m_statements, entry->second);
+                statement = *entry->second;
+                success = true;
+            } else if (m_pConnection != nullptr) {
+                try {
+                    statement.query = query;
+                    statement.name = sc_statement_prefix + std::to_string(m_statement_id++);
+                    m_pConnection->prepare(statement.name, query);
+
+                    // the result types are known once prepared, binary only when we can decode every one of them
+                    PgSqlResult description(PQdescribePrepared(m_pRawConnection, statement.name.c_str()));
+
+                    if ((description != nullptr) && (PQresultStatus(description.get()) == PGRES_COMMAND_OK) &&
+                        (hasBinaryResults(description.get()) == true)) {
+                        statement.result_format = sc_pgsql_binary_format;
+                    }
+
+                    m_statements.push_front(statement);
+                    m_lookup[query] = m_statements.begin();
+                    success = true;
+
+                    if (m_statements.size() > m_statement_capacity) {
+                        PreparedStatement oldest = m_statements.back();
+
+                        m_lookup.erase(oldest.query);
+                        m_statements.pop_back();
+                        m_pConnection->unprepare(oldest.name);
+                    }
+                }
+                catch (const std::exception &db_error) {
+                    // a failed prepare leaves nothing behind, a failed deallocate only a name on the server
+                }
+            }
+
+            return success;
+        }
+
+        PgSqlSessionSPtr acquireCursorSession(const PgSqlSessionPoolSPtr &pPool)
+        {
+            PgSqlSessionSPtr pSession = pPool->getLease();
+
+            if ((pSession == nullptr) || (pSession->getTransaction() == nullptr)) {
+                // an idle lease let go first, so it is not one the thread still holds
+                pSession = nullptr;
+                pSession = pPool->acquireExclusive();
+            }
+
+            return pSession;
+        }
+    }
+}
@@ -2,60 +2,78 @@
  * PgSqlTable.cpp
  */
 
+#include <cstdio>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
 #include "Row.h"
 
+#include "pgsql/PgSqlBlobStream.h"
 #include "pgsql/PgSqlColumn.h"
+#include "pgsql/PgSqlCursor.h"
 #include "pgsql/PgSqlTable.h"
 #include "pgsql/PgSqlUtility.h"
 
 namespace afm {
     namespace database {
-        static const std::string sc_table_describe = "select column_name, column_default, is_nullable, data_type, character_maximum_length, numeric_precision_radix, udt_name, is_identity  from information_schema.columns where table_name='%s'";
+        // fields after the table name line up with PgSqlTableColumns
+        static const std::string sc_catalog_query = "select c.table_name, c.column_name, c.column_default, c.is_nullable, c.data_type, "
+            "c.character_maximum_length, c.numeric_precision_radix, c.udt_name, c.is_identity "
+            "from information_schema.columns c "
+            "join pg_catalog.pg_tables p on p.schemaname = c.table_schema and p.tablename = c.table_name "
+            "where c.table_schema not in ('pg_catalog', 'information_schema')";
+        static const std::string sc_catalog_table_filter = " and c.table_name in (%s)";
+        static const std::string sc_catalog_order = " order by c.table_name, c.ordinal_position";
+        static const std::string sc_blob_size = "select octet_length(%c) from %t";
+        static const std::string sc_copy_out = "copy %t (%c) to stdout";
+        static const std::string sc_copy_in = "copy %t (%c) from stdin";
+        static const std::string sc_copy_binary = " with (format binary)";
+        static const std::string sc_copy_failed = "import aborted";
+        static const std::size_t sc_copy_chunk_size = 65536;
 
-        PgSqlTable::PgSqlTable(pqxx::connection *pConnection)
+        PgSqlTable::PgSqlTable(PgSqlSessionPoolSPtr pPool, const std::string &connection_string)
             : Table()
-            , m_pConnection(pConnection)
+            , m_pPool(pPool)
+            , m_connection_string(connection_string)
         {
 
         }
 
         PgSqlTable::~PgSqlTable()
         {
-            m_pConnection = nullptr;
+            m_pPool = nullptr;
         }
 
-        bool PgSqlTable::initialize(const std::string &table_name)
+        bool PgSqlTable::loadCatalog(PgSqlSessionSPtr pSession, CatalogDetails &catalog, const TableNames &tables)
         {
-            bool success = Table::initialize(table_name);
+            bool success = false;
+            std::string query = sc_catalog_query;
+            pqxx::result results;
 
-            if (success == true) {
-                std::string query = sc_table_describe;
-                pqxx::result results;
-                std::stringstream column_details;
+            if (tables.size() > 0) {
+                std::string filter = sc_catalog_table_filter;
 
-                query.replace(query.find("%s"), 2, table_name);
+                filter.replace(filter.find("%s"), 2, build_name_list(tables));
+                query += filter;
+            }
+            query += sc_catalog_order;
 
-                if (issueCommand(m_pConnection, query, results) == true) {
-                    for (auto column : results) {
-                        for (uint8_t index = 0; index < sc_max_pgsql_columns; index++) {
-                            column_details << column[index].c_str();
-                            if (index < (sc_max_pgsql_columns - 1)) {
-                                column_details << ",";
-                            }
-                        }
-                        IColumnSPtr pColumn = createEmptyColumn();
+            if (pSession->execute(query, results) == true) {
+                std::stringstream column_details;
 
-                        if (pColumn->initialize(column_details.str()) == true) {
-                            add_column(pColumn);
+                for (auto column : results) {
+                    // the table name leads, the rest is what the column parser expects
+                    for (uint8_t index = 0; index < sc_max_pgsql_columns; index++) {
+                        column_details << column[index + 1].c_str();
+                        if (index < (sc_max_pgsql_columns - 1)) {
+                            column_details << ",";
                         }
-                        column_details.str(""); // clear it
                     }
-                } else {
-                    success = false;
+                    catalog[column[0].c_str()].push_back(column_details.str());
+                    column_details.str(""); // clear it
                 }
+                success = true;
             }
 
             return success;
@@ -66,74 +84,484 @@ namespace afm {
             return std::make_shared<PgSqlColumn>();;
         }
 
-        bool PgSqlTable::on_create_row(const std::string &query)
+        bool PgSqlTable::on_create_row(const std::string &query, const StatementValues &values)
         {
             bool success = false;
-            pqxx::result results;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            PgSqlResult results;
 
-            success = issueCommand(m_pConnection, query, results);
+            success = (pSession != nullptr) && (pSession->execute(query, values, results) == true);
 
             return success;
         }
 
-        bool PgSqlTable::on_update_row(const std::string &query)
+        bool PgSqlTable::on_create_rows(const Rows &rows, uint32_t batch_size)
+        {
+            std::size_t row_index = 0;
+
+            return copy_rows([&rows, &row_index](IRowSPtr &pRow) {
+                bool more = (row_index < rows.size());
+
+                if (more == true) {
+                    pRow = rows[row_index++];
+                }
+                return more;
+            }, batch_size);
+        }
+
+        bool PgSqlTable::on_update_row(const std::string &query, const StatementValues &values)
         {
             bool success = false;
-            pqxx::result results;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            PgSqlResult results;
 
-            success = issueCommand(m_pConnection, query, results);
+            success = (pSession != nullptr) && (pSession->execute(query, values, results) == true);
 
             return success;
         }
 
-        bool PgSqlTable::on_get_row(IRowSPtr &pRow, const std::string &query)
+        bool PgSqlTable::on_get_row(IRowSPtr &pRow, const std::string &query, const StatementValues &values)
         {
             bool success = false;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            PgSqlResult results;
 
-            pqxx::result results;
-            if (issueCommand(m_pConnection, query, results) == true) {
-                RowData row_data;
-                if (results.size() > 0) {
-                    pqxx::row row = results[0];
-                    for (uint8_t index = 0; index < results.columns(); index++) {
-                        row_data.push_back(row[index].c_str());
-                    }
-                }
+            // we should warn when more than one row is returned
+            if ((pSession != nullptr) && (pSession->execute(query, values, results) == true) && (PQntuples(results.get()) > 0)) {
+                IRowSPtr pNewRow = createEmptyRow();
 
-                pRow = createEmptyRow();
-                pRow->setValues(row_data);
-                success = true;
+                if (getRow(results.get(), 0, pNewRow) == true) {
+                    pRow = pNewRow;
+                    success = true;
+                }
             }
 
             return success;
         }
 
-        bool PgSqlTable::on_get_rows(Rows &rows, const std::string &query)
+        bool PgSqlTable::on_get_rows(Rows &rows, const std::string &query, const StatementValues &values, const Projection &projection)
         {
-             bool success = false;
-            pqxx::result results;
+            bool success = false;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            PgSqlResult results;
 
-            if (issueCommand(m_pConnection, query, results) == true) {
-                RowData row_data;
-                for (auto row : results) {
-                    row_data.clear();
+            if ((pSession != nullptr) && (pSession->execute(query, values, results) == true)) {
+                int row_count = PQntuples(results.get());
 
-                    for (uint8_t index = 0; index < results.columns(); index++) {
-                        row_data.push_back(row[index].c_str());
+                rows.reserve(rows.size() + row_count);
+                success = true;
+
+                for (int row = 0; row < row_count; row++) {
+                    IRowSPtr pRow = createEmptyRow(projection);
+
+                    if (getRow(results.get(), row, pRow) == false) {
+                        success = false;
                     }
-                    IRowSPtr pRow = createEmptyRow();
-                    pRow->setValues(row_data);
                     rows.push_back(pRow);
                 }
+            }
+
+            return success;
+        }
+
+        bool PgSqlTable::on_get_values(AggregateRows &results, const std::string &query, const StatementValues &values, const DataTypes &types)
+        {
+            bool success = false;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            PgSqlResult rows;
+
+            if ((pSession != nullptr) && (pSession->execute(query, values, rows) == true)) {
+                int row_count = PQntuples(rows.get());
+
+                results.reserve(results.size() + row_count);
                 success = true;
+
+                for (int row = 0; row < row_count; row++) {
+                    AggregateRow result = create_values(types);
+
+                    for (std::size_t index = 0; (index < result.size()) && ((int)index < PQnfields(rows.get())); index++) {
+                        if (getValue(rows.get(), row, (int)index, result[index]) == false) {
+                            success = false;
+                        }
+                    }
+                    results.push_back(result);
+                }
+            }
+
+            return success;
+        }
+
+        ICursorSPtr PgSqlTable::on_scan(const std::string &query, const StatementValues &values, const Projection &projection)
+        {
+            PgSqlSessionSPtr pSession = acquireCursorSession(m_pPool);
+            std::shared_ptr<PgSqlCursor> pCursor = std::make_shared<PgSqlCursor>(shared_from_this(), pSession, projection);
+
+            if ((pSession == nullptr) || (pCursor->initialize(query, values) == false)) {
+                pCursor = nullptr;
             }
 
-            return success;           
+            return pCursor;
         }
 
         IColumnSPtr PgSqlTable::on_clone_column(const Column &column) const
         {
             return std::make_shared<PgSqlColumn>(column);
         }
+
+        bool PgSqlTable::on_load_columns(ColumnDetails &columns) const
+        {
+            bool success = false;
+            CatalogDetails catalog;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+
+            if ((pSession != nullptr) && (loadCatalog(pSession, catalog, {getName()}) == true)) {
+                columns = catalog[getName()];
+                success = true;
+            }
+
+            return success;
+        }
+
+        IBlobStreamSPtr PgSqlTable::on_read_blob(const std::string &column_name, const std::string &filter, const StatementValues &values)
+        {
+            IBlobStreamSPtr pStream = nullptr;
+            uint64_t size = 0;
+
+            if (get_blob_size(column_name, filter, values, size) == true) {
+                PgSqlSessionSPtr pSession = acquireCursorSession(m_pPool);
+                std::shared_ptr<PgSqlBlobStream> pBlobStream = std::make_shared<PgSqlBlobStream>(pSession, size, false);
+
+                if ((pSession != nullptr) && (pBlobStream->initialize(getName(), column_name, filter, values) == true)) {
+                    pStream = pBlobStream;
+                }
+            }
+
+            return pStream;
+        }
+
+        IBlobStreamSPtr PgSqlTable::on_write_blob(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t size)
+        {
+            IBlobStreamSPtr pStream = nullptr;
+            uint64_t current_size = 0;
+
+            // only for the row to exist, the update would quietly match nothing otherwise
+            if (get_blob_size(column_name, filter, values, current_size) == true) {
+                PgSqlSessionSPtr pSession = acquireCursorSession(m_pPool);
+                std::shared_ptr<PgSqlBlobStream> pBlobStream = std::make_shared<PgSqlBlobStream>(pSession, size, true);
+
+                if ((pSession != nullptr) && (pBlobStream->initialize(getName(), column_name, filter, values) == true)) {
+                    pStream = pBlobStream;
+                }
+            }
+
+            return pStream;
+        }
+
+        bool PgSqlTable::get_blob_size(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t &size)
+        {
+            bool success = false;
+            std::string query = sc_blob_size;
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            PgSqlResult results;
+            AggregateRow length = create_values({DataType::BIG_INT_T});
+
+            query.replace(query.find("%c"), 2, column_name);
+            query.replace(query.find("%t"), 2, getName());
+            query += filter;
+
+            if ((pSession != nullptr) && (pSession->execute(query, values, results) == true) && (PQntuples(results.get()) > 0) &&
+                (getValue(results.get(), 0, 0, length[0]) == true)) {
+                // a null value streams as empty, the value stays at zero
+                int64_t value = 0;
+
+                length[0]->getValue(value);
+                size = static_cast<uint64_t>(value);
+                success = true;
+            }
+
+            return success;
+        }
+    
+
+        bool PgSqlTable::on_export_rows(const std::string &file_name, BulkFormat format)
+        {
+            bool success = false;
+            FILE *pFile = (can_copy() == true) ? fopen(file_name.c_str(), "wb") : nullptr;
+
+            if (pFile != nullptr) {
+                PGconn *pConnection = start_copy(sc_copy_out, format, PGRES_COPY_OUT);
+
+                if (pConnection != nullptr) {
+                    char *pBuffer = nullptr;
+                    int length = 0;
+
+                    success = true;
+
+                    // the data is written as the server sends it, the copy is drained even when the file fails
+                    while ((length = PQgetCopyData(pConnection, &pBuffer, 0)) > 0) {
+                        if (fwrite(pBuffer, 1, length, pFile) != static_cast<std::size_t>(length)) {
+                            success = false;
+                        }
+                        PQfreemem(pBuffer);
+                    }
+
+                    // -1 is the end of the copy, -2 a failure
+                    success = (length == -1) && (success == true);
+                    success = (finish_copy(pConnection) == true) && (success == true);
+                }
+                success = (fclose(pFile) == 0) && (success == true);
+            }
+
+            return success;
+        }
+
+        bool PgSqlTable::on_export_rows(RowCallback callback)
+        {
+            bool success = false;
+            PgSqlSessionSPtr pSession = acquireCursorSession(m_pPool);
+            std::vector<std::string> column_names;
+            uint64_t user_id = 0;
+
+            for (auto column : get_columns()) {
+                column_names.push_back(column->getName());
+            }
+
+            // the callback runs with the stream open, so like a cursor it works through a session no other call uses
+            // unless it is inside the thread's transaction
+            if (pSession != nullptr) {
+                try {
+                    std::unique_ptr<pqxx::work> pWork = nullptr;
+                    pqxx::transaction_base *pTransaction = pSession->getTransaction();
+
+                    if (pTransaction == nullptr) {
+                        pWork = std::make_unique<pqxx::work>(*pSession->getConnection());
+                        pTransaction = pWork.get();
+                    }
+
+                    pqxx::stream_from stream(*pTransaction, getName(), column_names);
+                    bool more = true;
+                    bool ended = false;
+
+                    if (pWork == nullptr) {
+                        // a callback ending the session's transaction finishes the stream first, the export is cut short
+                        user_id = pSession->attach([&stream, &ended]() {
+                            ended = true;
+                            try {
+                                stream.complete();
+                            }
+                            catch (const std::exception &db_error) {
+                                // the transaction is ending anyway
+                            }
+                        });
+                    }
+
+                    success = true;
+                    while ((more == true) && (ended == false)) {
+                        auto pFields = stream.read_row();
+
+                        if (pFields != nullptr) {
+                            IRowSPtr pRow = createEmptyRow();
+                            Columns columns = pRow->getColumns();
+
+                            for (std::size_t index = 0; (index < columns.size()) && (index < pFields->size()); index++) {
+                                // NULL arrives without data and leaves the column untouched
+                                if (getValue((*pFields)[index].data(), (*pFields)[index].size(), columns[index]->getValue()) == false) {
+                                    success = false;
+                                }
+                            }
+                            pRow->clearDirtyFlag();
+
+                            // a field we could not read fails the export the way a failed fetch does
+                            more = (success == true) && (callback(pRow) == true);
+                        } else {
+                            more = false;
+                        }
+                    }
+
+                    // whatever the callback did not want is drained here
+                    if (ended == false) {
+                        stream.complete();
+                    } else {
+                        success = false;
+                    }
+                    if (pWork != nullptr) {
+                        pWork->commit();
+                    }
+                }
+                catch (const std::exception &db_error) {
+                    success = false;
+                }
+
+                if (user_id != 0) {
+                    pSession->detach(user_id);
+                }
+            }
+
+            return success;
+        }
+
+        bool PgSqlTable::on_import_rows(const std::string &file_name, BulkFormat format)
+        {
+            bool success = false;
+            FILE *pFile = (can_copy() == true) ? fopen(file_name.c_str(), "rb") : nullptr;
+
+            if (pFile != nullptr) {
+                PGconn *pConnection = start_copy(sc_copy_in, format, PGRES_COPY_IN);
+
+                if (pConnection != nullptr) {
+                    std::vector<char> buffer(sc_copy_chunk_size);
+                    std::size_t length = 0;
+
+                    success = true;
+
+                    // the server parses the file, we only move it across in chunks
+                    while ((success == true) && ((length = fread(buffer.data(), 1, buffer.size(), pFile)) > 0)) {
+                        success = (PQputCopyData(pConnection, buffer.data(), length) == 1);
+                    }
+                    success = (success == true) && (ferror(pFile) == 0);
+
+                    // ending with an error message has the server throw every row of the copy away
+                    success = (PQputCopyEnd(pConnection, success == true ? nullptr : sc_copy_failed.c_str()) == 1) && (success == true);
+                    success = (finish_copy(pConnection) == true) && (success == true);
+                }
+                fclose(pFile);
+            }
+
+            return success;
+        }
+
+        bool PgSqlTable::on_import_rows(RowSource source, uint32_t batch_size)
+        {
+            return copy_rows([this, &source](IRowSPtr &pRow) {
+                pRow = createEmptyRow();
+
+                return source(pRow);
+            }, batch_size);
+        }
+
+        bool PgSqlTable::copy_rows(RowSource source, uint32_t batch_size)
+        {
+            PgSqlSessionSPtr pSession = m_pPool->acquire();
+            bool success = (pSession != nullptr);
+            bool more = success;
+            std::vector<std::string> column_names;
+
+            for (auto column : get_columns()) {
+                if (is_insert_column(column) == true) {
+                    column_names.push_back(column->getName());
+                }
+            }
+
+            try {
+                // each batch is its own copy from stdin inside its own transaction, or the
+                // session's write transaction when one is open
+                while (more == true) {
+                    std::unique_ptr<pqxx::work> pWork = nullptr;
+                    std::unique_ptr<pqxx::stream_to> pStream = nullptr;
+                    uint32_t batch_count = 0;
+
+                    while ((more == true) && (batch_count < batch_size)) {
+                        IRowSPtr pRow = nullptr;
+
+                        more = source(pRow);
+                        if (more == true) {
+                            std::vector<std::optional<std::string>> row_data;
+
+                            // started by the first row so running dry on a batch boundary costs nothing
+                            if (pStream == nullptr) {
+                                pqxx::transaction_base *pTransaction = pSession->getTransaction();
+
+                                if (pTransaction == nullptr) {
+                                    pWork = std::make_unique<pqxx::work>(*pSession->getConnection());
+                                    pTransaction = pWork.get();
+                                }
+                                pStream = std::make_unique<pqxx::stream_to>(*pTransaction, getName(), column_names);
+                            }
+
+                            for (auto column : pRow->getColumns()) {
+                                if (is_insert_column(column) == true) {
+                                    row_data.push_back(getText(column->getValue()));
+                                }
+                            }
+                            pStream->write_row(row_data);
+                            batch_count++;
+                        }
+                    }
+
+                    if (pStream != nullptr) {
+                        pStream->complete();
+                        if (pWork != nullptr) {
+                            pWork->commit();
+                        }
+                    }
+                }
+            }
+            catch (const std::exception &db_error) {
+                // only the batch in flight is lost, earlier batches are already committed
+                success = false;
+            }
+
+            return success;
+        }
+
+        bool PgSqlTable::can_copy() const
+        {
+            PgSqlSessionSPtr pSession = m_pPool->getLease();
+
+            // a file copy runs on a libpq connection of its own, it could neither see nor be undone
+            // with a transaction this thread has open
+            return (pSession == nullptr) || (pSession->getTransaction() == nullptr);
+        }
+
+        PGconn *PgSqlTable::start_copy(const std::string &command, BulkFormat format, ExecStatusType expected) const
+        {
+            std::string query = command;
+            std::string column_names;
+            PGconn *pConnection = PQconnectdb(m_connection_string.c_str());
+
+            for (auto column : get_columns()) {
+                if (column_names.size() > 0) {
+                    column_names += ",";
+                }
+                column_names += column->getName();
+            }
+            query.replace(query.find("%t"), 2, getName());
+            query.replace(query.find("%c"), 2, column_names);
+            if (format == BulkFormat::Binary) {
+                query += sc_copy_binary;
+            }
+
+            if (PQstatus(pConnection) == CONNECTION_OK) {
+                PGresult *pResult = PQexec(pConnection, query.c_str());
+
+                if (PQresultStatus(pResult) != expected) {
+                    PQfinish(pConnection);
+                    pConnection = nullptr;
+                }
+                PQclear(pResult);
+            } else {
+                PQfinish(pConnection);
+                pConnection = nullptr;
+            }
+
+            return pConnection;
+        }
+
+        bool PgSqlTable::finish_copy(PGconn *pConnection) const
+        {
+            bool success = true;
+            PGresult *pResult = nullptr;
+
+            // the copy reports how it went once it is over
+            while ((pResult = PQgetResult(pConnection)) != nullptr) {
+                if (PQresultStatus(pResult) != PGRES_COMMAND_OK) {
+                    success = false;
+                }
+                PQclear(pResult);
+            }
+            PQfinish(pConnection);
+
+            return success;
+        }
     }
 }
\ No newline at end of file
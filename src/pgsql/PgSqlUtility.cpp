@@ -2,24 +2,755 @@
  * PgSqlUtility.cpp
  */
 
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+
+#include <libpq-fe.h>
+
+#include "tools/tools.h"
 #include "pgsql/PgSqlUtility.h"
 
 namespace afm {
     namespace database {
+        // built in type oids, fixed by the server catalog
+        static const std::map<pqxx::oid, DataType> sc_type_oids = {
+            {16, DataType::BIT_T},          // bool
+            {17, DataType::BLOB_T},         // bytea
+            {20, DataType::BIG_INT_T},      // int8
+            {21, DataType::SMALL_INT_T},    // int2
+            {23, DataType::INT_T},          // int4
+            {25, DataType::TEXT_T},         // text
+            {114, DataType::JSON_T},        // json
+            {142, DataType::XML_T},         // xml
+            {700, DataType::REAL_T},        // float4
+            {701, DataType::FLOAT_T},       // float8
+            {1042, DataType::CHAR_T},       // bpchar
+            {1043, DataType::VARCHAR_T},    // varchar
+            {1082, DataType::DATE_T},       // date
+            {1083, DataType::TIME_T},       // time
+            {1114, DataType::DATE_TIME_T},  // timestamp
+            {1184, DataType::DATE_TIME_T},  // timestamptz
+            {1700, DataType::FLOAT_T},      // numeric, read as a double
+            {3802, DataType::JSON_T}        // jsonb
+        };
+
+        // the types whose binary form we decode, a statement returning anything else is fetched as text
+        static const std::set<pqxx::oid> sc_binary_oids = {
+            16, 17, 19, 20, 21, 23, 25, 114, 700, 701, 1042, 1043, 1082, 1083, 1114, 1184, 1700, 3802
+        };
+
+        static const int64_t sc_microseconds_per_day = 86400000000LL;
+        static const int64_t sc_days_before_2000 = 10957;  // binary dates and times count from 2000-01-01
+
+        static int hex_value(char digit)
+        {
+            int value = -1;
+
+            if ((digit >= '0') && (digit <= '9')) {
+                value = digit - '0';
+            } else if ((digit >= 'a') && (digit <= 'f')) {
+                value = digit - 'a' + 10;
+            } else if ((digit >= 'A') && (digit <= 'F')) {
+                value = digit - 'A' + 10;
+            }
+
+            return value;
+        }
+
+        static uint64_t read_network(const char *pData, std::size_t size)
+        {
+            uint64_t value = 0;
+
+            for (std::size_t index = 0; index < size; index++) {
+                value = (value << 8) | static_cast<uint8_t>(pData[index]);
+            }
+
+            return value;
+        }
+
+        static bool set_integer(int64_t value, const IVariableDataSPtr &pValue)
+        {
+            bool success = false;
+
+            switch (pValue->getType()) {
+                case DataType::BIT_T:
+                {
+                    success = pValue->setValue(value != 0);
+                }
+                break;
+                case DataType::TINY_INT_T:
+                {
+                    success = pValue->setValue(static_cast<int8_t>(value));
+                }
+                break;
+                case DataType::SMALL_INT_T:
+                {
+                    success = pValue->setValue(static_cast<int16_t>(value));
+                }
+                break;
+                case DataType::INT_T:
+                {
+                    success = pValue->setValue(static_cast<int32_t>(value));
+                }
+                break;
+                case DataType::BIG_INT_T:
+                {
+                    success = pValue->setValue(value);
+                }
+                break;
+                case DataType::DECIMAL_T:
+                case DataType::NUMERIC_T:
+                case DataType::FLOAT_T:
+                case DataType::REAL_T:
+                {
+                    success = pValue->setValue(static_cast<double>(value));
+                }
+                break;
+                default:
+                {
+                    std::string text = std::to_string(value);
+
+                    success = getValue(text.c_str(), text.size(), pValue);
+                }
+                break;
+            }
+
+            return success;
+        }
+
+        static bool set_real(double value, const IVariableDataSPtr &pValue)
+        {
+            bool success = false;
+            DataType type = pValue->getType();
+
+            if ((type == DataType::DECIMAL_T) || (type == DataType::NUMERIC_T) || (type == DataType::FLOAT_T) || (type == DataType::REAL_T)) {
+                success = pValue->setValue(value);
+            } else {
+                std::stringstream text;
+
+                text << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+                success = getValue(text.str().c_str(), text.str().size(), pValue);
+            }
+
+            return success;
+        }
+
+        static bool set_time(int64_t microseconds, bool has_date, bool has_time, const IVariableDataSPtr &pValue)
+        {
+            bool success = false;
+            int64_t days = microseconds / sc_microseconds_per_day;
+            int64_t time_of_day = microseconds % sc_microseconds_per_day;
+            struct tm value = {0};
+
+            if (time_of_day < 0) {
+                time_of_day += sc_microseconds_per_day;
+                days--;
+            }
+
+            // civil date from days since 1970-01-01, the value keeps full years and months from 1
+            days += sc_days_before_2000 + 719468;
+            int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+            int64_t day_of_era = days - (era * 146097);
+            int64_t year_of_era = (day_of_era - (day_of_era / 1460) + (day_of_era / 36524) - (day_of_era / 146096)) / 365;
+            int64_t day_of_year = day_of_era - ((365 * year_of_era) + (year_of_era / 4) - (year_of_era / 100));
+            int64_t month = ((5 * day_of_year) + 2) / 153;
+
+            value.tm_mday = static_cast<int>(day_of_year - (((153 * month) + 2) / 5) + 1);
+            value.tm_mon = static_cast<int>(month < 10 ? month + 3 : month - 9);
+            value.tm_year = static_cast<int>(year_of_era + (era * 400) + (value.tm_mon <= 2 ? 1 : 0));
+            value.tm_hour = static_cast<int>(time_of_day / 3600000000LL);
+            value.tm_min = static_cast<int>((time_of_day / 60000000LL) % 60);
+            value.tm_sec = static_cast<int>((time_of_day / 1000000LL) % 60);
+
+            if ((has_date == true) && ((pValue->getType() == DataType::DATE_T) || (pValue->getType() == DataType::DATE_TIME_T))) {
+                success = pValue->setValue(value);
+            } else {
+                // written the way the server writes the text form, only the parts the type has
+                std::stringstream text;
+
+                text << std::setfill('0');
+                if (has_date == true) {
+                    text << std::setw(4) << value.tm_year << "-" << std::setw(2) << value.tm_mon << "-" << std::setw(2) << value.tm_mday;
+                }
+                if ((has_date == true) && (has_time == true)) {
+                    text << " ";
+                }
+                if (has_time == true) {
+                    text << std::setw(2) << value.tm_hour << ":" << std::setw(2) << value.tm_min << ":" << std::setw(2) << value.tm_sec;
+                }
+                success = getValue(text.str().c_str(), text.str().size(), pValue);
+            }
+
+            return success;
+        }
+
+        // base 10000 digits with a weight and display scale, written out exactly as the server would
+        static bool get_numeric_text(const char *pData, std::size_t length, std::string &text)
+        {
+            bool success = (length >= 8);
+
+            if (success == true) {
+                int digit_count = static_cast<int16_t>(read_network(pData, 2));
+                int weight = static_cast<int16_t>(read_network(pData + 2, 2));
+                uint16_t sign = static_cast<uint16_t>(read_network(pData + 4, 2));
+                int scale = static_cast<int16_t>(read_network(pData + 6, 2));
+                auto digit = [&](int index) {
+                    return ((index >= 0) && (index < digit_count)) ? static_cast<int>(read_network(pData + 8 + (index * 2), 2)) : 0;
+                };
+
+                text.clear();
+                success = (digit_count >= 0) && (scale >= 0) && (length >= (8 + (std::size_t)digit_count * 2));
+                if (success == false) {
+                    // too short for the digits it claims
+                } else if (sign == 0xC000) {
+                    text = "NaN";
+                } else if ((sign == 0xD000) || (sign == 0xF000)) {
+                    text = (sign == 0xF000) ? "-Infinity" : "Infinity";
+                } else {
+                    text = (sign == 0x4000) ? "-" : "";
+                    if (weight < 0) {
+                        text.push_back('0');
+                    }
+                    for (int index = 0; index <= weight; index++) {
+                        std::string group = std::to_string(digit(index));
+
+                        text += (index > 0) ? std::string(4 - group.size(), '0') + group : group;
+                    }
+
+                    if (scale > 0) {
+                        std::string fraction;
+
+                        for (int index = weight + 1; (int)fraction.size() < scale; index++) {
+                            std::string group = std::to_string(digit(index));
+
+                            fraction += std::string(4 - group.size(), '0') + group;
+                        }
+                        text += "." + fraction.substr(0, scale);
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        static bool get_binary_value(pqxx::oid type, const char *pData, std::size_t length, const IVariableDataSPtr &pValue)
+        {
+            bool success = false;
+
+            switch (type) {
+                case 16:    // bool
+                {
+                    success = (length == 1) && (set_integer(pData[0] != 0 ? 1 : 0, pValue) == true);
+                }
+                break;
+                case 21:    // int2
+                {
+                    success = (length == 2) && (set_integer(static_cast<int16_t>(read_network(pData, 2)), pValue) == true);
+                }
+                break;
+                case 23:    // int4
+                {
+                    success = (length == 4) && (set_integer(static_cast<int32_t>(read_network(pData, 4)), pValue) == true);
+                }
+                break;
+                case 20:    // int8
+                {
+                    success = (length == 8) && (set_integer(static_cast<int64_t>(read_network(pData, 8)), pValue) == true);
+                }
+                break;
+                case 700:   // float4
+                {
+                    if (length == 4) {
+                        uint32_t bits = static_cast<uint32_t>(read_network(pData, 4));
+                        float value = 0;
+
+                        std::memcpy(&value, &bits, sizeof(value));
+                        success = set_real(value, pValue);
+                    }
+                }
+                break;
+                case 701:   // float8
+                {
+                    if (length == 8) {
+                        uint64_t bits = read_network(pData, 8);
+                        double value = 0;
+
+                        std::memcpy(&value, &bits, sizeof(value));
+                        success = set_real(value, pValue);
+                    }
+                }
+                break;
+                case 1700:  // numeric
+                {
+                    // no native type is wider than its digits, the value parses them as it would the text form
+                    std::string text;
+
+                    success = (get_numeric_text(pData, length, text) == true) && (getValue(text.c_str(), text.size(), pValue) == true);
+                }
+                break;
+                case 1082:  // date, days
+                {
+                    if (length == 4) {
+                        int64_t days = static_cast<int32_t>(read_network(pData, 4));
+
+                        success = set_time(days * sc_microseconds_per_day, true, false, pValue);
+                    }
+                }
+                break;
+                case 1083:  // time, microseconds since midnight
+                {
+                    success = (length == 8) && (set_time(static_cast<int64_t>(read_network(pData, 8)), false, true, pValue) == true);
+                }
+                break;
+                case 1114:  // timestamp, microseconds
+                case 1184:  // timestamptz, microseconds in utc
+                {
+                    success = (length == 8) && (set_time(static_cast<int64_t>(read_network(pData, 8)), true, true, pValue) == true);
+                }
+                break;
+                case 17:    // bytea, the bytes as they are
+                {
+                    DataType value_type = pValue->getType();
+
+                    if ((value_type == DataType::BINARY_T) || (value_type == DataType::VARBINARY_T) || (value_type == DataType::VARBINARY_MAX_T) ||
+                        (value_type == DataType::IMAGE_T) || (value_type == DataType::BLOB_T)) {
+                        BinaryBlob value(reinterpret_cast<const uint8_t *>(pData), reinterpret_cast<const uint8_t *>(pData) + length);
+
+                        success = pValue->setValue(value);
+                    }
+                }
+                break;
+                case 3802:  // jsonb, a version byte ahead of the text
+                {
+                    success = (length > 0) && (pData[0] == 1) && (getValue(pData + 1, length - 1, pValue) == true);
+                }
+                break;
+                default:
+                {
+                    // the character types send their text as is
+                    success = getValue(pData, length, pValue);
+                }
+                break;
+            }
+
+            return success;
+        }
+
         bool issueCommand(pqxx::connection *pConnection, const std::string &command, pqxx::result &result)
         {
             bool success = true;
 
             try {
-                pqxx::work work_unit(*pConnection);
+                // no begin or commit around it, a single statement is atomic on its own
+                pqxx::nontransaction work_unit(*pConnection);
 
                 result = work_unit.exec(command.c_str());
-                work_unit.commit();
             }
             catch (const std::exception &db_error) {
                 success = false;
             }
             return success;
         }
+
+        void getResult(const pqxx::result &source, QueryResult &result)
+        {
+            for (int index = 0; index < source.columns(); index++) {
+                result.columns.push_back(source.column_name(index));
+            }
+
+            result.rows.reserve(source.size());
+
+            for (auto row : source) {
+                RowData values(source.columns());
+
+                for (int index = 0; index < source.columns(); index++) {
+                    if (row[index].is_null() == false) {
+                        values[index].assign(row[index].c_str(), row[index].size());
+                    }
+                }
+                result.rows.push_back(values);
+            }
+            result.affected_rows = source.affected_rows();
+            result.success = true;
+        }
+    
+
+        pqxx::params getParameters(const StatementValues &values)
+        {
+            pqxx::params parameters;
+
+            for (auto pValue : values) {
+                DataType type = pValue != nullptr ? pValue->getType() : DataType::EndDataTypes;
+
+                switch (type) {
+                    case DataType::BIT_T:
+                    {
+                        bool value = false;
+
+                        pValue->getValue(value);
+                        parameters.append(value);
+                    }
+                    break;
+                    case DataType::TINY_INT_T:
+                    case DataType::SMALL_INT_T:
+                    {
+                        // there is no single byte integer, smallint carries both
+                        int16_t value = 0;
+
+                        pValue->getValue(value);
+                        parameters.append(value);
+                    }
+                    break;
+                    case DataType::INT_T:
+                    {
+                        int32_t value = 0;
+
+                        pValue->getValue(value);
+                        parameters.append(value);
+                    }
+                    break;
+                    case DataType::BIG_INT_T:
+                    {
+                        int64_t value = 0;
+
+                        pValue->getValue(value);
+                        parameters.append(value);
+                    }
+                    break;
+                    case DataType::DECIMAL_T:
+                    case DataType::NUMERIC_T:
+                    {
+                        // text so the server parses the digits itself, a float would send 0.99 as 0.9900000095
+                        parameters.append(pValue->getValue());
+                    }
+                    break;
+                    case DataType::FLOAT_T:
+                    case DataType::REAL_T:
+                    {
+                        double value = 0;
+
+                        pValue->getValue(value);
+                        parameters.append(value);
+                    }
+                    break;
+                    case DataType::BINARY_T:
+                    case DataType::VARBINARY_T:
+                    case DataType::VARBINARY_MAX_T:
+                    case DataType::IMAGE_T:
+                    case DataType::BLOB_T:
+                    {
+                        // goes across as binary, no escaping on either end
+                        BinaryBlob value;
+
+                        pValue->getValue(value);
+                        parameters.append(std::basic_string<std::byte>(reinterpret_cast<const std::byte *>(value.data()), value.size()));
+                    }
+                    break;
+                    case DataType::EndDataTypes:
+                    {
+                        parameters.append();
+                    }
+                    break;
+                    default:
+                    {
+                        // text, dates and times go across in their text form
+                        parameters.append(pValue->getValue());
+                    }
+                    break;
+                }
+            }
+
+            return parameters;
+        }
+
+        void getParameters(const StatementValues &values, PgSqlParameters &parameters)
+        {
+            parameters.data.resize(values.size());
+            parameters.values.assign(values.size(), nullptr);
+            parameters.lengths.assign(values.size(), 0);
+            parameters.formats.assign(values.size(), 0);
+
+            for (std::size_t index = 0; index < values.size(); index++) {
+                const IVariableDataSPtr &pValue = values[index];
+                DataType type = pValue != nullptr ? pValue->getType() : DataType::EndDataTypes;
+
+                if ((type == DataType::BINARY_T) || (type == DataType::VARBINARY_T) || (type == DataType::VARBINARY_MAX_T) ||
+                    (type == DataType::IMAGE_T) || (type == DataType::BLOB_T)) {
+                    BinaryBlob value;
+
+                    pValue->getValue(value);
+                    parameters.data[index].assign(value.begin(), value.end());
+                    parameters.formats[index] = sc_pgsql_binary_format;
+                } else if ((type == DataType::FLOAT_T) || (type == DataType::REAL_T)) {
+                    // every digit the double has, the default stream precision keeps six
+                    std::stringstream text;
+                    double value = 0;
+
+                    pValue->getValue(value);
+                    text << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+                    parameters.data[index] = text.str();
+                } else if (type != DataType::EndDataTypes) {
+                    parameters.data[index] = pValue->getValue();
+                }
+
+                // a null pointer is how libpq is told NULL
+                if (type != DataType::EndDataTypes) {
+                    parameters.values[index] = parameters.data[index].data();
+                    parameters.lengths[index] = static_cast<int>(parameters.data[index].size());
+                }
+            }
+        }
+
+        bool hasBinaryResults(const PGresult *pDescription)
+        {
+            bool success = (pDescription != nullptr) && (PQnfields(pDescription) > 0);
+
+            for (int index = 0; (success == true) && (index < PQnfields(pDescription)); index++) {
+                success = (sc_binary_oids.find(PQftype(pDescription, index)) != sc_binary_oids.end());
+            }
+
+            return success;
+        }
+
+        bool getValue(const pqxx::field &field, const IVariableDataSPtr &pValue)
+        {
+            bool success = true;
+
+            if (field.is_null() == false) {
+                success = getValue(field.c_str(), field.size(), pValue);
+            }
+
+            return success;
+        }
+
+        bool getValue(const PGresult *pResult, int row, int column, const IVariableDataSPtr &pValue)
+        {
+            bool success = true;
+
+            if ((pValue != nullptr) && (PQgetisnull(pResult, row, column) == 0)) {
+                const char *pData = PQgetvalue(pResult, row, column);
+                std::size_t length = PQgetlength(pResult, row, column);
+
+                if (PQfformat(pResult, column) == sc_pgsql_binary_format) {
+                    success = get_binary_value(PQftype(pResult, column), pData, length, pValue);
+                } else {
+                    success = getValue(pData, length, pValue);
+                }
+            }
+
+            return success;
+        }
+
+        bool getValue(const char *pText, std::size_t length, const IVariableDataSPtr &pValue)
+        {
+            bool success = true;
+
+            if ((pValue != nullptr) && (pText != nullptr)) {
+                char *pEnd = nullptr;
+
+                switch (pValue->getType()) {
+                    case DataType::BIT_T:
+                    {
+                        // t or f from a boolean, anything else is the text of a number
+                        success = pValue->setValue((pText[0] == 't') || ((pText[0] != 'f') && (pText[0] != '0') && (length > 0)));
+                    }
+                    break;
+                    case DataType::TINY_INT_T:
+                    {
+                        int8_t value = static_cast<int8_t>(strtol(pText, &pEnd, 10));
+
+                        success = (pEnd != pText) && (pValue->setValue(value) == true);
+                    }
+                    break;
+                    case DataType::SMALL_INT_T:
+                    {
+                        int16_t value = static_cast<int16_t>(strtol(pText, &pEnd, 10));
+
+                        success = (pEnd != pText) && (pValue->setValue(value) == true);
+                    }
+                    break;
+                    case DataType::INT_T:
+                    {
+                        int32_t value = static_cast<int32_t>(strtol(pText, &pEnd, 10));
+
+                        success = (pEnd != pText) && (pValue->setValue(value) == true);
+                    }
+                    break;
+                    case DataType::BIG_INT_T:
+                    {
+                        int64_t value = strtoll(pText, &pEnd, 10);
+
+                        success = (pEnd != pText) && (pValue->setValue(value) == true);
+                    }
+                    break;
+                    case DataType::DECIMAL_T:
+                    case DataType::NUMERIC_T:
+                    {
+                        // the widest the value holds, strtof would drop everything past six digits
+                        double value = strtod(pText, &pEnd);
+
+                        success = (pEnd != pText) && (pValue->setValue(value) == true);
+                    }
+                    break;
+                    case DataType::FLOAT_T:
+                    case DataType::REAL_T:
+                    {
+                        double value = strtod(pText, &pEnd);
+
+                        success = (pEnd != pText) && (pValue->setValue(value) == true);
+                    }
+                    break;
+                    case DataType::CHAR_T:
+                    case DataType::VARCHAR_T:
+                    case DataType::VARCHAR_MAX_T:
+                    case DataType::TEXT_T:
+                    case DataType::XML_T:
+                    case DataType::JSON_T:
+                    case DataType::CLOB_T:
+                    {
+                        success = pValue->setValue(std::string(pText, length));
+                    }
+                    break;
+                    case DataType::NCHAR_T:
+                    case DataType::NVARCHAR_T:
+                    case DataType::NVARCHAR_MAX_T:
+                    case DataType::NTEXT_T:
+                    {
+                        success = pValue->setValue(tools::utf8_to_wide(std::string(pText, length)));
+                    }
+                    break;
+                    case DataType::BINARY_T:
+                    case DataType::VARBINARY_T:
+                    case DataType::VARBINARY_MAX_T:
+                    case DataType::IMAGE_T:
+                    case DataType::BLOB_T:
+                    {
+                        BinaryBlob value;
+
+                        success = (decodeBytea(pText, length, value) == true) && (pValue->setValue(value) == true);
+                    }
+                    break;
+                    default:
+                    {
+                        // dates and times arrive as text, let the value parse them
+                        success = pValue->setValue(pText, length);
+                    }
+                    break;
+                }
+            }
+
+            return success;
+        }
+
+        std::optional<std::string> getText(const IVariableDataSPtr &pValue)
+        {
+            std::optional<std::string> text = std::nullopt;
+
+            if (pValue != nullptr) {
+                DataType type = pValue->getType();
+
+                if ((type == DataType::BINARY_T) || (type == DataType::VARBINARY_T) || (type == DataType::VARBINARY_MAX_T) ||
+                    (type == DataType::IMAGE_T) || (type == DataType::BLOB_T)) {
+                    // bytea input in hex form
+                    static const char sc_hex_digits[] = "0123456789abcdef";
+                    BinaryBlob value;
+
+                    pValue->getValue(value);
+                    text = std::string("\\x");
+                    text->reserve(2 + (value.size() * 2));
+                    for (auto byte : value) {
+                        text->push_back(sc_hex_digits[byte >> 4]);
+                        text->push_back(sc_hex_digits[byte & 0x0F]);
+                    }
+                } else {
+                    text = pValue->getValue();
+                }
+            }
+
+            return text;
+        }
+
+        bool decodeBytea(const char *pText, std::size_t length, BinaryBlob &value)
+        {
+            bool success = true;
+
+            value.clear();
+            if ((length >= 2) && (pText[0] == '\\') && (pText[1] == 'x')) {
+                value.reserve((length - 2) / 2);
+                for (std::size_t index = 2; (index + 1) < length; index += 2) {
+                    int high = hex_value(pText[index]);
+                    int low = hex_value(pText[index + 1]);
+
+                    if ((high < 0) || (low < 0)) {
+                        success = false;
+                        break;
+                    }
+                    value.push_back(static_cast<uint8_t>((high << 4) | low));
+                }
+            } else {
+                // the older escape form, let libpq undo it
+                std::size_t unescaped_length = 0;
+                unsigned char *pData = PQunescapeBytea(reinterpret_cast<const unsigned char *>(pText), &unescaped_length);
+
+                if (pData != nullptr) {
+                    value.assign(pData, pData + unescaped_length);
+                    PQfreemem(pData);
+                } else {
+                    success = false;
+                }
+            }
+
+            return success;
+        }
+
+        void describe(const pqxx::result &source, ColumnDescriptions &columns)
+        {
+            columns.clear();
+
+            for (int index = 0; index < source.columns(); index++) {
+                ColumnDescription column;
+                std::map<pqxx::oid, DataType>::const_iterator type = sc_type_oids.find(source.column_type(index));
+
+                column.name = source.column_name(index);
+                column.type = (type != sc_type_oids.end()) ? type->second : DataType::TEXT_T;
+                column.flags = sc_description_null;
+                columns.push_back(column);
+            }
+        }
+
+        bool getRow(const pqxx::row &source, const IRowSPtr &pRow)
+        {
+            bool success = true;
+            int index = 0;
+
+            for (auto column : pRow->getColumns()) {
+                if ((index < source.size()) && (getValue(source[index], column->getValue()) == false)) {
+                    success = false;
+                }
+                index++;
+            }
+            pRow->clearDirtyFlag();
+
+            return success;
+        }
+
+        bool getRow(const PGresult *pResult, int row, const IRowSPtr &pRow)
+        {
+            bool success = true;
+            int index = 0;
+
+            for (auto column : pRow->getColumns()) {
+                if ((index < PQnfields(pResult)) && (getValue(pResult, row, index, column->getValue()) == false)) {
+                    success = false;
+                }
+                index++;
+            }
+            pRow->clearDirtyFlag();
+
+            return success;
+        }
     }
 }
\ No newline at end of file
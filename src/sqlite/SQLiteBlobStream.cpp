@@ -0,0 +1,103 @@
+/**
+ * SQLiteBlobStream.cpp
+ */
+
+#include "sqlite/SQLiteBlobStream.h"
+
+namespace afm {
+    namespace database {
+        static const std::string sc_main_schema = "main";
+
+        SQLiteBlobStream::SQLiteBlobStream(SQLiteConnectionSPtr pConnection, uint64_t size, bool is_writable, uint32_t scope)
+            : BlobStream(size, is_writable)
+            , m_pConnection(pConnection)
+            , m_scope(scope)
+        {
+
+        }
+
+        SQLiteBlobStream::~SQLiteBlobStream()
+        {
+            close();
+        }
+
+        bool SQLiteBlobStream::initialize(const std::string &table_name, const std::string &column_name, int64_t row_id, const std::vector<sqlite3 *> &handles)
+        {
+            bool success = true;
+
+            // an empty value has nothing to open, sqlite refuses a handle on a null anyway
+            if (getSize() > 0) {
+                for (auto p_db : handles) {
+                    sqlite3_blob *pBlob = nullptr;
+
+                    if (sqlite3_blob_open(p_db, sc_main_schema.c_str(), table_name.c_str(), column_name.c_str(), row_id, is_writable() == true ? 1 : 0, &pBlob) == SQLITE_OK) {
+                        m_blobs.push_back(pBlob);
+                    } else {
+                        sqlite3_blob_close(pBlob);
+                        success = false;
+                        break;
+                    }
+                }
+            }
+
+            if (success == false) {
+                close();
+            }
+
+            return success;
+        }
+
+        bool SQLiteBlobStream::on_read(uint64_t offset, uint8_t *pBuffer, uint32_t length)
+        {
+            bool success = false;
+
+            if (m_blobs.size() > 0) {
+                success = (sqlite3_blob_read(m_blobs[0], pBuffer, length, offset) == SQLITE_OK);
+            }
+
+            return success;
+        }
+
+        bool SQLiteBlobStream::on_write(uint64_t offset, const uint8_t *pData, uint32_t length)
+        {
+            bool success = (m_blobs.size() > 0);
+
+            for (auto pBlob : m_blobs) {
+                if (sqlite3_blob_write(pBlob, pData, length, offset) != SQLITE_OK) {
+                    success = false;
+                    break;
+                }
+            }
+
+            return success;
+        }
+
+        bool SQLiteBlobStream::on_close(bool complete)
+        {
+            bool success = true;
+
+            for (auto pBlob : m_blobs) {
+                if (sqlite3_blob_close(pBlob) != SQLITE_OK) {
+                    success = false;
+                }
+            }
+            m_blobs.clear();
+
+            // a write runs in a transaction scope opened along with the stream
+            if (is_writable() == true) {
+                if ((complete == true) && (success == true)) {
+                    success = m_pConnection->commitScope(m_scope);
+                }
+                if ((complete == false) || (success == false)) {
+                    m_pConnection->rollbackScope(m_scope);
+                    success = false;
+                }
+            }
+
+            // back to its pool
+            m_pConnection = nullptr;
+
+            return success;
+        }
+    }
+}
@@ -0,0 +1,208 @@
+/**
+ * SQLiteConnection.cpp
+ */
+
+#include "sqlite/SQLiteConnection.h"
+#include "sqlite/SQLiteUtility.h"
+
+namespace afm {
+    namespace database {
+        static const std::string sc_pragma_statement = "pragma %s=%s";
+        static const std::string sc_journal_mode = "journal_mode";
+        static const std::string sc_synchronous = "synchronous";
+        static const std::string sc_mmap_size = "mmap_size";
+        static const std::string sc_cache_size = "cache_size";
+        static const std::string sc_read_uncommitted = "read_uncommitted";
+        static const std::string sc_begin_transaction = "begin transaction";
+        static const std::string sc_commit_transaction = "commit transaction";
+        static const std::string sc_rollback_transaction = "rollback transaction";
+        static const std::string sc_begin_immediate_transaction = "begin immediate transaction";
+
+        SQLiteConnection::SQLiteConnection()
+        {
+
+        }
+
+        SQLiteConnection::~SQLiteConnection()
+        {
+            if (m_pStatementCache != nullptr) {
+                m_pStatementCache->clear();
+                m_pStatementCache = nullptr;
+            }
+
+            if (m_p_db != nullptr) {
+                // v2 defers the close until any statement still held elsewhere is finalized
+                sqlite3_close_v2(m_p_db);
+                m_p_db = nullptr;
+            }
+        }
+
+        bool SQLiteConnection::initialize(const std::string &file_name, bool read_only, const SQLiteSettings &settings)
+        {
+            bool success = false;
+            int flags = (read_only == true ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)) | SQLITE_OPEN_URI;
+
+            if (sqlite3_open_v2(file_name.c_str(), &m_p_db, flags, nullptr) == SQLITE_OK) {
+                success = true;
+
+                sqlite3_busy_timeout(m_p_db, settings.busy_timeout);
+
+                // the journal mode is kept in the file, only the writer sets it
+                if ((read_only == false) && (settings.journal_mode.size() > 0)) {
+                    success = apply_pragma(sc_journal_mode, settings.journal_mode);
+                }
+                if ((success == true) && (settings.synchronous.size() > 0)) {
+                    success = apply_pragma(sc_synchronous, settings.synchronous);
+                }
+                if ((success == true) && (settings.mmap_size != 0)) {
+                    success = apply_pragma(sc_mmap_size, std::to_string(settings.mmap_size));
+                }
+                if ((success == true) && (settings.cache_size != 0)) {
+                    success = apply_pragma(sc_cache_size, std::to_string(settings.cache_size));
+                }
+                if ((success == true) && (settings.read_uncommitted == true)) {
+                    success = apply_pragma(sc_read_uncommitted, "true");
+                }
+
+                if (success == true) {
+                    m_pStatementCache = std::make_shared<SQLiteStatementCache>(m_p_db, sc_default_statement_cache_size);
+                }
+            }
+
+            if (success == false) {
+                // a failed open still hands back a handle that has to be closed
+                sqlite3_close_v2(m_p_db);
+                m_p_db = nullptr;
+            }
+
+            return success;
+        }
+
+        bool SQLiteConnection::execute(const std::string &command)
+        {
+            bool success = issueCommand(m_p_db, command);
+
+            // both sides always run so a rollback reaches the mirror even when this side has none open
+            if ((m_pMirror != nullptr) && (m_pMirror->execute(command) == false)) {
+                success = false;
+            }
+
+            return success;
+        }
+
+        bool SQLiteConnection::execute(const std::string &query, const StatementValues &values)
+        {
+            bool success = false;
+
+            if (m_pMirror == nullptr) {
+                success = execute_statement(query, values);
+            } else {
+                // outside of a transaction the mirror holds its change open until this side has
+                // made it too, so a failure here leaves neither side changed
+                bool own_transaction = (sqlite3_get_autocommit(m_pMirror->getHandle()) != 0);
+
+                if ((own_transaction == false) || (m_pMirror->execute(sc_begin_transaction) == true)) {
+                    success = m_pMirror->execute_statement(query, values);
+                    if (success == true) {
+                        success = execute_statement(query, values);
+                    }
+
+                    if (own_transaction == true) {
+                        if (success == true) {
+                            success = m_pMirror->execute(sc_commit_transaction);
+                        } else {
+                            m_pMirror->execute(sc_rollback_transaction);
+                        }
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        bool SQLiteConnection::mirror(const std::string &query, const StatementValues &values)
+        {
+            bool success = true;
+
+            if (m_pMirror != nullptr) {
+                success = m_pMirror->execute_statement(query, values);
+            }
+
+            return success;
+        }
+
+        bool SQLiteConnection::query(const std::string &query, QueryResult &result)
+        {
+            SQLiteStatementSPtr pStatement = acquire(query);
+
+            if (pStatement != nullptr) {
+                if ((m_pMirror != nullptr) && (pStatement->isReadOnly() == false)) {
+                    // writes go through execute so the mirror sees them too
+                    release(pStatement);
+                    result.success = execute(query, StatementValues());
+                } else {
+                    int step_result = SQLITE_ROW;
+
+                    while ((step_result = pStatement->step()) == SQLITE_ROW) {
+                        pStatement->getResult(result);
+                    }
+                    result.success = (step_result == SQLITE_DONE);
+                    release(pStatement);
+                }
+            }
+
+            if (result.success == true) {
+                if (result.columns.size() == 0) {
+                    result.affected_rows = sqlite3_changes(m_p_db);
+                }
+            } else {
+                result.error = sqlite3_errmsg(m_p_db);
+            }
+
+            return result.success;
+        }
+
+        bool SQLiteConnection::on_begin(bool read_only)
+        {
+            // deferred takes no write lock, its snapshot starts with the first read and lasts until it ends
+            return execute((read_only == true) ? sc_begin_transaction : sc_begin_immediate_transaction);
+        }
+
+        bool SQLiteConnection::on_commit()
+        {
+            return execute(sc_commit_transaction);
+        }
+
+        bool SQLiteConnection::on_rollback()
+        {
+            return execute(sc_rollback_transaction);
+        }
+
+        bool SQLiteConnection::execute_statement(const std::string &query, const StatementValues &values)
+        {
+            bool success = false;
+            SQLiteStatementSPtr pStatement = acquire(query);
+
+            if (pStatement != nullptr) {
+                if (pStatement->bind(values) == true) {
+                    if (pStatement->step() == SQLITE_DONE) {
+                        success = true;
+                    }
+                }
+                release(pStatement);
+            }
+
+            return success;
+        }
+
+        bool SQLiteConnection::apply_pragma(const std::string &pragma, const std::string &value)
+        {
+            std::string query = sc_pragma_statement;
+
+            query.replace(query.find("%s"), 2, pragma);
+            query.replace(query.find("%s"), 2, value);
+
+            return issueCommand(m_p_db, query);
+        }
+    }
+}
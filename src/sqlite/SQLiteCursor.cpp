@@ -0,0 +1,84 @@
+/**
+ * SQLiteCursor.cpp
+ */
+
+#include "sqlite/SQLiteColumn.h"
+#include "sqlite/SQLiteCursor.h"
+
+namespace afm {
+    namespace database {
+
+        SQLiteCursor::SQLiteCursor(TableConstSPtr pTable, SQLiteConnectionSPtr pConnection, SQLiteStatementSPtr pStatement, const Projection &projection)
+            : Cursor(pTable, projection)
+            , m_pConnection(pConnection)
+            , m_pStatement(pStatement)
+        {
+
+        }
+
+        SQLiteCursor::SQLiteCursor(SQLiteConnectionSPtr pConnection, SQLiteStatementSPtr pStatement)
+            : Cursor()
+            , m_pConnection(pConnection)
+            , m_pStatement(pStatement)
+        {
+
+        }
+
+        SQLiteCursor::~SQLiteCursor()
+        {
+            close();
+        }
+
+        bool SQLiteCursor::initialize()
+        {
+            bool success = true;
+
+            if (m_pStatement != nullptr) {
+                ColumnDescriptions columns;
+
+                // the row the first step brings back waits for the first next
+                m_pending = m_pStatement->step();
+                success = ((m_pending == SQLITE_ROW) || (m_pending == SQLITE_DONE)) && (m_pStatement->describe(columns) == true);
+                if (success == true) {
+                    set_columns(columns);
+                }
+            }
+
+            return success;
+        }
+
+        bool SQLiteCursor::on_next(IRowSPtr &pRow)
+        {
+            bool success = false;
+
+            if (m_pStatement != nullptr) {
+                int result = (m_pending != SQLITE_OK) ? m_pending : m_pStatement->step();
+
+                m_pending = SQLITE_OK;
+                if (result == SQLITE_ROW) {
+                    success = m_pStatement->getRow(pRow);
+                }
+
+                if ((success == false) && (result != SQLITE_DONE)) {
+                    set_failed();
+                }
+            }
+
+            return success;
+        }
+
+        void SQLiteCursor::on_close()
+        {
+            // the statement goes back to the cache and the connection back to its pool
+            if (m_pStatement != nullptr) {
+                m_pConnection->release(m_pStatement);
+            }
+            m_pConnection = nullptr;
+        }
+
+        IColumnSPtr SQLiteCursor::on_create_column() const
+        {
+            return std::make_shared<SQLiteColumn>();
+        }
+    }
+}
@@ -6,6 +6,9 @@
 #include <string>
 #include <vector>
 
+#include "tools/tools.h"
+
+#include "sqlite/SQLiteCursor.h"
 #include "sqlite/SQLiteDB.h"
 #include "sqlite/SQLiteTable.h"
 #include "sqlite/SQLiteUtility.h"
@@ -41,10 +44,28 @@ namespace afm {
                 }
         };
 
-        using TableNames = std::vector<std::string>;
         static const std::string sc_table_query = "SELECT name FROM sqlite_master WHERE type='table';";
         static const std::string sc_single_table_query = "SELECT name FROM sqlite_master WHERE type='table' and name='%s'";
         static const std::string sc_table_ignore = "sqlite_";
+        static const std::string sc_schema_version_query = "pragma schema_version";
+        static const std::string sc_memory_database = ":memory:";
+        static const std::string sc_wal_journal = "wal";
+
+        // database options
+        static const std::string sc_journal_mode = "journal_mode";
+        static const std::string sc_synchronous = "synchronous";
+        static const std::string sc_mmap_size = "mmap_size";
+        static const std::string sc_cache_size = "cache_size";
+        static const std::string sc_busy_timeout = "busy_timeout";
+        static const std::string sc_read_connections = "read_connections";
+        static const std::string sc_replica = "replica";
+        static const std::string sc_replica_sync_interval = "replica_sync_interval";
+
+        static const std::string sc_replica_modes[] = {
+            "none",
+            "memory",
+            "write_through"
+        };
 
         int sqlite_table_query_callback(void *p_tablenames, int col_count, char **pp_data, char **pp_columns);
 
@@ -57,9 +78,18 @@ namespace afm {
 
         SQLiteDatabase::~SQLiteDatabase()
         {
-            if (m_p_db != nullptr) {
-                sqlite3_close(m_p_db);
-                m_p_db = nullptr;
+            // the replica may still need the writer for a last synchronize
+            m_pReplica = nullptr;
+
+            // connections still leased out close as their holders let go of them
+            if (m_pReaders != nullptr) {
+                m_pReaders->clear();
+                m_pReaders = nullptr;
+            }
+
+            if (m_pWriters != nullptr) {
+                m_pWriters->clear();
+                m_pWriters = nullptr;
             }
         }
 
@@ -68,11 +98,50 @@ namespace afm {
             bool success = false;
 
             if (Database::initialize(connection, database_name) == true) {
-                if (sqlite3_open(database_name.c_str(), &m_p_db) != SQLITE_OK) {
-                    m_p_db = nullptr;
-                } else {
+                SQLiteSettings settings;
+                SQLiteSettings read_settings;
+                std::string file_name = database_name;
+
+                parse_settings(getOptions());
+                settings = m_settings;
+                read_settings = m_settings;
+
+                // every connection opens the memory copy, the file is only touched by the replica
+                if (m_replica_settings.mode != SQLiteReplicaMode::None) {
+                    m_pReplica = std::make_shared<SQLiteReplica>(database_name, m_replica_settings);
+                    file_name = m_pReplica->getMemoryName();
+
+                    // a shared cache reader would lock tables against the writer instead
+                    read_settings.read_uncommitted = true;
+                }
+
+                // a single writer, sqlite only ever allows one at a time anyway
+                m_pWriters = std::make_shared<SQLiteConnectionPool>([file_name, settings]() {
+                    SQLiteConnectionSPtr pConnection = std::make_shared<SQLiteConnection>();
+
+                    if (pConnection->initialize(file_name, false, settings) == false) {
+                        pConnection = nullptr;
+                    }
+                    return pConnection;
+                }, 1);
+
+                // the writer goes first so the file exists and is in wal mode before any reader opens
+                if ((m_pWriters->reserve(1) == true) && ((m_pReplica == nullptr) || (m_pReplica->initialize(m_pWriters, settings) == true))) {
+                    if (m_settings.read_connections > 0) {
+                        m_pReaders = std::make_shared<SQLiteConnectionPool>([file_name, read_settings]() {
+                            SQLiteConnectionSPtr pConnection = std::make_shared<SQLiteConnection>();
+
+                            if (pConnection->initialize(file_name, true, read_settings) == false) {
+                                pConnection = nullptr;
+                            }
+                            return pConnection;
+                        }, m_settings.read_connections);
+                    }
                     load_tables();
                     success = true;
+                } else {
+                    m_pReplica = nullptr;
+                    m_pWriters = nullptr;
                 }
             }
             return success;
@@ -84,15 +153,16 @@ namespace afm {
 
             // if not found in the base class then go see if we can find it
             if (pTable == nullptr) {
+                SQLiteConnectionSPtr pConnection = m_pWriters->acquire();
                 TableNames tables;
 
                 std::string query = sc_single_table_query;
                 
                 query.replace(query.find("%s"), 2, name);
 
-                if (issueCommand(m_p_db, query, sqlite_table_query_callback, &tables) == true) {
+                if ((pConnection != nullptr) && (issueCommand(pConnection->getHandle(), query, sqlite_table_query_callback, &tables) == true)) {
                     if (tables.size() > 0) {
-                        pTable = std::make_shared<SQLiteTable>(m_p_db);
+                        pTable = std::make_shared<SQLiteTable>(m_pWriters, m_pReaders);
 
                         pTable->initialize(tables[0]);
                         addTable(pTable);
@@ -104,10 +174,11 @@ namespace afm {
 
         ITableSPtr SQLiteDatabase::createTable(const DatabaseOptions &details)
         {
-            ITableSPtr pTable = std::make_shared<SQLiteTable>(m_p_db);
+            SQLiteConnectionSPtr pConnection = m_pWriters->acquire();
+            ITableSPtr pTable = std::make_shared<SQLiteTable>(m_pWriters, m_pReaders);
 
-            if (pTable->initialize(details) == true) {
-                if (issueCommand(m_p_db, build_table_create(pTable)) == false) {
+            if ((pConnection != nullptr) && (pTable->initialize(details) == true)) {
+                if (pConnection->execute(build_table_create(pTable)) == false) {
                     pTable = nullptr;
                 } else {
                     addTable(pTable);
@@ -153,25 +224,191 @@ namespace afm {
             return success;
         }
 
+        bool SQLiteDatabase::synchronize()
+        {
+            bool success = false;
+
+            if (m_pReplica != nullptr) {
+                success = m_pReplica->synchronize();
+            }
+
+            return success;
+        }
+
         // internal methods
         void SQLiteDatabase::load_tables()
         {
+            SQLiteConnectionSPtr pConnection = m_pWriters->acquire();
+            CatalogDescriptions cached;
             TableNames tables;
 
-            if (issueCommand(m_p_db, sc_table_query, sqlite_table_query_callback, &tables) == true) {
+            if (load_schema_cache(cached) == true) {
+                // nothing to parse, the columns come straight from the cache
+                for (auto table : cached) {
+                    std::shared_ptr<SQLiteTable> pSQLiteTable = std::make_shared<SQLiteTable>(m_pWriters, m_pReaders);
+
+                    if (pSQLiteTable->initialize(table.first, table.second) == true) {
+                        ITableSPtr pTable = pSQLiteTable;
+
+                        addTable(pTable);
+                    }
+                }
+            } else if ((pConnection != nullptr) && (issueCommand(pConnection->getHandle(), sc_table_query, sqlite_table_query_callback, &tables) == true)) {
+                TableNames preload;
+
+                // just named handles, the columns are looked up on first use
                 for (auto table : tables) {
-                    ITableSPtr pTable = std::make_shared<SQLiteTable>(m_p_db);
+                    ITableSPtr pTable = std::make_shared<SQLiteTable>(m_pWriters, m_pReaders);
 
-                    pTable->initialize(table);
+                    if (pTable->initialize(table) == true) {
+                        addTable(pTable);
+                    }
+                }
 
-                    addTable(pTable);
+                // unless asked for up front, then one round trip covers all of them
+                if (get_preload_tables(tables, preload) == true) {
+                    CatalogDetails catalog;
+
+                    if (SQLiteTable::loadCatalog(pConnection->getHandle(), catalog, preload) == true) {
+                        for (auto table : catalog) {
+                            std::shared_ptr<SQLiteTable> pTable = std::dynamic_pointer_cast<SQLiteTable>(Database::getTable(table.first));
+
+                            if (pTable != nullptr) {
+                                pTable->initialize(table.first, table.second);
+                            }
+                        }
+                    }
                 }
+                save_schema_cache();
             }
         }
 
+        bool SQLiteDatabase::get_schema_version(std::string &version)
+        {
+            bool success = false;
+            SQLiteConnectionSPtr pConnection = m_pWriters->acquire();
+            TableNames values;
+
+            if ((pConnection != nullptr) && (issueCommand(pConnection->getHandle(), sc_schema_version_query, sqlite_table_query_callback, &values) == true)) {
+                if (values.size() > 0) {
+                    version = values[0];
+                    success = true;
+                }
+            }
+
+            return success;
+        }
+
         bool SQLiteDatabase::on_drop_table(const std::string &query)
         {
-            return issueCommand(m_p_db, query);
+            bool success = false;
+            SQLiteConnectionSPtr pConnection = m_pWriters->acquire();
+
+            if (pConnection != nullptr) {
+                success = pConnection->execute(query);
+            }
+
+            return success;
+        }
+
+        void SQLiteDatabase::on_query_batch(const std::vector<std::string> &queries, std::vector<QueryResult> &results)
+        {
+            // nothing goes over a network, so each query simply runs in turn on the writer
+            SQLiteConnectionSPtr pConnection = m_pWriters->acquire();
+
+            if (pConnection != nullptr) {
+                for (std::size_t index = 0; index < queries.size(); index++) {
+                    if (pConnection->query(queries[index], results[index]) == false) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        ICursorSPtr SQLiteDatabase::on_query(const std::string &query, const StatementValues &values)
+        {
+            ICursorSPtr pCursor = nullptr;
+            SQLiteConnectionSPtr pConnection = (m_pWriters != nullptr) ? m_pWriters->getLease() : nullptr;
+            SQLiteStatementSPtr pStatement = nullptr;
+            std::shared_ptr<SQLiteCursor> pQueryCursor = nullptr;
+
+            // a thread in a transaction reads through its writer so it sees its own changes
+            if ((pConnection == nullptr) || (pConnection->inTransaction() == false)) {
+                pConnection = (m_pReaders != nullptr) ? m_pReaders->acquire() : m_pWriters->acquire();
+            }
+            pStatement = (pConnection != nullptr) ? pConnection->acquire(query) : nullptr;
+
+            if ((pStatement != nullptr) && (pStatement->isReadOnly() == false)) {
+                // writes go through the writer's execute so a replica sees them too, they bring no rows back
+                pConnection->release(pStatement);
+                pConnection = m_pWriters->acquire();
+
+                if ((pConnection != nullptr) && (pConnection->execute(query, values) == true)) {
+                    pQueryCursor = std::make_shared<SQLiteCursor>(pConnection, nullptr);
+                }
+            } else if ((pStatement != nullptr) && (pStatement->bind(values) == true)) {
+                pQueryCursor = std::make_shared<SQLiteCursor>(pConnection, pStatement);
+            } else if (pStatement != nullptr) {
+                pConnection->release(pStatement);
+            }
+
+            if ((pQueryCursor != nullptr) && (pQueryCursor->initialize() == true)) {
+                pCursor = pQueryCursor;
+            }
+
+            return pCursor;
+        }
+
+        TransactionConnectionSPtr SQLiteDatabase::get_transaction_connection()
+        {
+            // the one writer, held by the transaction until it ends
+            return m_pWriters != nullptr ? m_pWriters->acquire() : nullptr;
+        }
+
+        void SQLiteDatabase::parse_settings(const DatabaseOptions &options)
+        {
+            if (options.find(sc_journal_mode) != options.end()) {
+                m_settings.journal_mode = tools::to_lower(options[sc_journal_mode]);
+            }
+            if (options.find(sc_synchronous) != options.end()) {
+                m_settings.synchronous = options[sc_synchronous];
+            }
+            if (options.find(sc_mmap_size) != options.end()) {
+                m_settings.mmap_size = options[sc_mmap_size];
+            }
+            if (options.find(sc_cache_size) != options.end()) {
+                m_settings.cache_size = options[sc_cache_size];
+            }
+            if (options.find(sc_busy_timeout) != options.end()) {
+                m_settings.busy_timeout = options[sc_busy_timeout];
+            }
+            if (options.find(sc_read_connections) != options.end()) {
+                m_settings.read_connections = options[sc_read_connections];
+            }
+            if (options.find(sc_replica) != options.end()) {
+                std::string mode = tools::to_lower(options[sc_replica]);
+
+                for (int index = 0; index < (int)SQLiteReplicaMode::EndReplicaModes; index++) {
+                    if (mode == sc_replica_modes[index]) {
+                        m_replica_settings.mode = (SQLiteReplicaMode)index;
+                        break;
+                    }
+                }
+            }
+            if (options.find(sc_replica_sync_interval) != options.end()) {
+                m_replica_settings.sync_interval = options[sc_replica_sync_interval];
+            }
+
+            // every connection to an in memory database is a database of its own, there is nothing to copy
+            if (getName() == sc_memory_database) {
+                m_settings.read_connections = 0;
+                m_replica_settings.mode = SQLiteReplicaMode::None;
+            }
+
+            // outside of wal readers would just block the writer, a replica shares its cache instead
+            if ((m_settings.journal_mode != sc_wal_journal) && (m_replica_settings.mode == SQLiteReplicaMode::None)) {
+                m_settings.read_connections = 0;
+            }
         }
 
         // callbacks
@@ -0,0 +1,158 @@
+/**
+ * SQLiteReplica.cpp
+ */
+
+#include <atomic>
+#include <chrono>
+
+#include <unistd.h>
+
+#include "sqlite/SQLiteReplica.h"
+
+namespace afm {
+    namespace database {
+        static const std::string sc_memory_name = "file:afm_replica_%d_%d?mode=memory&cache=shared";
+        static const std::string sc_main_schema = "main";
+        static const int sc_sync_pages = 64;
+        static const int sc_sync_retries = 100;
+        static const std::chrono::milliseconds sc_sync_retry_delay(10);
+
+        static std::atomic<uint32_t> s_replica_count(0);
+
+        SQLiteReplica::SQLiteReplica(const std::string &file_name, const SQLiteReplicaSettings &settings)
+            : m_file_name(file_name)
+            , m_memory_name(sc_memory_name)
+            , m_settings(settings)
+        {
+            // shared cache memory databases are found by name, so each copy needs its own
+            m_memory_name.replace(m_memory_name.find("%d"), 2, std::to_string(getpid()));
+            m_memory_name.replace(m_memory_name.find("%d"), 2, std::to_string(s_replica_count++));
+        }
+
+        SQLiteReplica::~SQLiteReplica()
+        {
+            if (m_sync_thread.joinable() == true) {
+                {
+                    std::lock_guard<std::mutex> guard(m_thread_lock);
+
+                    m_stopping = true;
+                }
+                m_stop_signal.notify_all();
+                m_sync_thread.join();
+
+                // whatever changed since the last pass
+                synchronize();
+            }
+
+            m_pFile = nullptr;
+            m_pWriters = nullptr;
+        }
+
+        bool SQLiteReplica::initialize(SQLiteConnectionPoolSPtr pWriters, const SQLiteSettings &settings)
+        {
+            bool success = false;
+            bool read_only = (m_settings.mode == SQLiteReplicaMode::Memory) && (m_settings.sync_interval == 0);
+            SQLiteConnectionSPtr pWriter = nullptr;
+
+            m_pWriters = pWriters;
+            m_connection_settings = settings;
+
+            pWriter = m_pWriters->acquire();
+
+            if ((pWriter != nullptr) && (open_file(read_only) == true) && (load_copy(pWriter->getHandle()) == true)) {
+                success = true;
+
+                if (m_settings.mode == SQLiteReplicaMode::WriteThrough) {
+                    pWriter->setMirror(m_pFile);
+                } else if (read_only == true) {
+                    // nothing more is read from the file, a synchronize opens it again if asked
+                    m_pFile = nullptr;
+                } else {
+                    m_sync_thread = std::thread(&SQLiteReplica::sync_thread, this);
+                }
+            }
+
+            return success;
+        }
+
+        bool SQLiteReplica::synchronize()
+        {
+            bool success = false;
+            std::lock_guard<std::mutex> guard(m_sync_lock);
+
+            // write through already keeps the file current
+            if ((m_settings.mode == SQLiteReplicaMode::Memory) && (m_pWriters != nullptr)) {
+                if ((m_pFile != nullptr) || (open_file(false) == true)) {
+                    SQLiteConnectionSPtr pWriter = m_pWriters->acquire();
+                    sqlite3_backup *pBackup = nullptr;
+
+                    if (pWriter != nullptr) {
+                        pBackup = sqlite3_backup_init(m_pFile->getHandle(), sc_main_schema.c_str(), pWriter->getHandle(), sc_main_schema.c_str());
+                        pWriter = nullptr;
+                    }
+
+                    if (pBackup != nullptr) {
+                        int result = SQLITE_OK;
+                        int retries = 0;
+
+                        // a few pages at a time, writes in between go through the same connection
+                        // as the source so the backup picks them up as it goes
+                        while ((result == SQLITE_OK) || (((result == SQLITE_BUSY) || (result == SQLITE_LOCKED)) && (retries++ < sc_sync_retries))) {
+                            if (result != SQLITE_OK) {
+                                std::this_thread::sleep_for(sc_sync_retry_delay);
+                            }
+                            pWriter = m_pWriters->acquire();
+                            result = sqlite3_backup_step(pBackup, sc_sync_pages);
+                            pWriter = nullptr;
+                        }
+
+                        success = (sqlite3_backup_finish(pBackup) == SQLITE_OK) && (result == SQLITE_DONE);
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        bool SQLiteReplica::load_copy(sqlite3 *p_db)
+        {
+            bool success = false;
+            sqlite3_backup *pBackup = sqlite3_backup_init(p_db, sc_main_schema.c_str(), m_pFile->getHandle(), sc_main_schema.c_str());
+
+            if (pBackup != nullptr) {
+                // nothing reads the copy yet so it goes in one step
+                int result = sqlite3_backup_step(pBackup, -1);
+
+                success = (sqlite3_backup_finish(pBackup) == SQLITE_OK) && (result == SQLITE_DONE);
+            }
+
+            return success;
+        }
+
+        bool SQLiteReplica::open_file(bool read_only)
+        {
+            bool success = false;
+            SQLiteConnectionSPtr pFile = std::make_shared<SQLiteConnection>();
+
+            if (pFile->initialize(m_file_name, read_only, m_connection_settings) == true) {
+                m_pFile = pFile;
+                success = true;
+            }
+
+            return success;
+        }
+
+        void SQLiteReplica::sync_thread()
+        {
+            std::unique_lock<std::mutex> guard(m_thread_lock);
+
+            while (m_stopping == false) {
+                if (m_stop_signal.wait_for(guard, std::chrono::seconds(m_settings.sync_interval), [this]() { return m_stopping; }) == false) {
+                    guard.unlock();
+                    synchronize();
+                    guard.lock();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,393 @@
+/**
+ * SQLiteStatement.cpp
+ */
+
+#include "tools/tools.h"
+#include "sqlite/SQLiteColumn.h"
+#include "sqlite/SQLiteStatement.h"
+
+namespace afm {
+    namespace database {
+
+        SQLiteStatement::SQLiteStatement(sqlite3 *p_db)
+            : m_p_db(p_db)
+        {
+
+        }
+
+        SQLiteStatement::~SQLiteStatement()
+        {
+            if (m_p_statement != nullptr) {
+                sqlite3_finalize(m_p_statement);
+                m_p_statement = nullptr;
+            }
+        }
+
+        bool SQLiteStatement::initialize(const std::string &query)
+        {
+            bool success = false;
+
+            m_query = query;
+
+            // persistent as we expect to run it many times over
+            if (sqlite3_prepare_v3(m_p_db, query.c_str(), query.size() + 1, SQLITE_PREPARE_PERSISTENT, &m_p_statement, nullptr) == SQLITE_OK) {
+                success = (m_p_statement != nullptr);
+            } else {
+                m_p_statement = nullptr;
+            }
+
+            return success;
+        }
+
+        bool SQLiteStatement::bind(const StatementValues &values)
+        {
+            bool success = true;
+
+            // sqlite parameters are 1 based
+            int index = 1;
+
+            for (auto value : values) {
+                if (bind(index++, value) == false) {
+                    success = false;
+                    break;
+                }
+            }
+
+            return success;
+        }
+
+        bool SQLiteStatement::bind(int index, const IVariableDataSPtr &pValue)
+        {
+            int result = SQLITE_OK;
+            DataType type = pValue != nullptr ? pValue->getType() : DataType::EndDataTypes;
+
+            switch (type) {
+                case DataType::BIT_T:
+                {
+                    bool value = false;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_int(m_p_statement, index, value == true ? 1 : 0);
+                }
+                break;
+                case DataType::TINY_INT_T:
+                {
+                    int8_t value = 0;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_int(m_p_statement, index, value);
+                }
+                break;
+                case DataType::SMALL_INT_T:
+                {
+                    int16_t value = 0;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_int(m_p_statement, index, value);
+                }
+                break;
+                case DataType::INT_T:
+                {
+                    int32_t value = 0;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_int(m_p_statement, index, value);
+                }
+                break;
+                case DataType::BIG_INT_T:
+                {
+                    int64_t value = 0;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_int64(m_p_statement, index, value);
+                }
+                break;
+                case DataType::TIMESTAMP_T:
+                {
+                    uint64_t value = 0;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_int64(m_p_statement, index, (sqlite3_int64)value);
+                }
+                break;
+                case DataType::DECIMAL_T:
+                case DataType::NUMERIC_T:
+                {
+                    // as written rather than widened from float, numeric affinity stores "0.99" as 0.99
+                    std::string value = pValue->getValue();
+
+                    result = sqlite3_bind_text(m_p_statement, index, value.c_str(), value.size(), SQLITE_TRANSIENT);
+                }
+                break;
+                case DataType::FLOAT_T:
+                case DataType::REAL_T:
+                {
+                    double value = 0;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_double(m_p_statement, index, value);
+                }
+                break;
+                case DataType::CHAR_T:
+                case DataType::VARCHAR_T:
+                case DataType::VARCHAR_MAX_T:
+                case DataType::TEXT_T:
+                case DataType::XML_T:
+                case DataType::JSON_T:
+                case DataType::CLOB_T:
+                {
+                    std::string value;
+
+                    pValue->getValue(value);
+                    result = sqlite3_bind_text(m_p_statement, index, value.c_str(), value.size(), SQLITE_TRANSIENT);
+                }
+                break;
+                case DataType::BINARY_T:
+                case DataType::VARBINARY_T:
+                case DataType::VARBINARY_MAX_T:
+                case DataType::IMAGE_T:
+                case DataType::BLOB_T:
+                {
+                    BinaryBlob value;
+
+                    pValue->getValue(value);
+                    if (value.size() > 0) {
+                        result = sqlite3_bind_blob(m_p_statement, index, value.data(), value.size(), SQLITE_TRANSIENT);
+                    } else {
+                        result = sqlite3_bind_zeroblob(m_p_statement, index, 0);
+                    }
+                }
+                break;
+                case DataType::EndDataTypes:
+                {
+                    result = sqlite3_bind_null(m_p_statement, index);
+                }
+                break;
+                default:
+                {
+                    // dates, times and wide text go across in their text form
+                    std::string value = pValue->getValue();
+
+                    result = sqlite3_bind_text(m_p_statement, index, value.c_str(), value.size(), SQLITE_TRANSIENT);
+                }
+                break;
+            }
+
+            return result == SQLITE_OK;
+        }
+
+        int SQLiteStatement::step()
+        {
+            return sqlite3_step(m_p_statement);
+        }
+
+        bool SQLiteStatement::getRow(IRowSPtr &pRow) const
+        {
+            bool success = false;
+            const Columns &columns = pRow->getColumns();
+            std::size_t col_count = sqlite3_column_count(m_p_statement);
+
+            if (col_count <= columns.size()) {
+                success = true;
+
+                for (std::size_t index = 0; index < col_count; index++) {
+                    IVariableDataSPtr pValue = columns[index]->getValue();
+
+                    if (pValue != nullptr) {
+                        getValue(index, pValue);
+                        pValue->clearDirtyFlag();
+                    }
+                }
+            }
+
+            return success;
+        }
+
+        bool SQLiteStatement::describe(ColumnDescriptions &columns) const
+        {
+            bool success = true;
+            int col_count = sqlite3_column_count(m_p_statement);
+
+            columns.clear();
+
+            for (int index = 0; index < col_count; index++) {
+                ColumnDescription description;
+                const char *pName = sqlite3_column_name(m_p_statement, index);
+                const char *pType = sqlite3_column_decltype(m_p_statement, index);
+
+                description.name = (pName != nullptr) ? pName : "";
+                description.flags = sc_description_null;
+
+                // expressions have no declared type, only their values do
+                if ((pType != nullptr) && (*pType != '\0')) {
+                    SQLiteColumn column;
+
+                    description.type = column.test_type(tools::to_upper(pType));
+                }
+
+                if (description.type == DataType::EndDataTypes) {
+                    switch (sqlite3_column_type(m_p_statement, index)) {
+                        case SQLITE_INTEGER:
+                        {
+                            description.type = DataType::BIG_INT_T;
+                        }
+                        break;
+                        case SQLITE_FLOAT:
+                        {
+                            description.type = DataType::FLOAT_T;
+                        }
+                        break;
+                        case SQLITE_BLOB:
+                        {
+                            description.type = DataType::BLOB_T;
+                        }
+                        break;
+                        default:
+                        {
+                            description.type = DataType::TEXT_T;
+                        }
+                        break;
+                    }
+                }
+
+                if (description.name.size() == 0) {
+                    success = false;
+                }
+                columns.push_back(description);
+            }
+
+            return success;
+        }
+
+        bool SQLiteStatement::getValue(int index, const IVariableDataSPtr &pValue) const
+        {
+            bool success = true;
+
+            // a NULL leaves the value as it was
+            if (sqlite3_column_type(m_p_statement, index) != SQLITE_NULL) {
+                switch (pValue->getType()) {
+                    case DataType::BIT_T:
+                    {
+                        success = pValue->setValue(sqlite3_column_int64(m_p_statement, index) != 0);
+                    }
+                    break;
+                    case DataType::TINY_INT_T:
+                    {
+                        success = pValue->setValue((int8_t)sqlite3_column_int(m_p_statement, index));
+                    }
+                    break;
+                    case DataType::SMALL_INT_T:
+                    {
+                        success = pValue->setValue((int16_t)sqlite3_column_int(m_p_statement, index));
+                    }
+                    break;
+                    case DataType::INT_T:
+                    {
+                        success = pValue->setValue((int32_t)sqlite3_column_int(m_p_statement, index));
+                    }
+                    break;
+                    case DataType::BIG_INT_T:
+                    {
+                        success = pValue->setValue((int64_t)sqlite3_column_int64(m_p_statement, index));
+                    }
+                    break;
+                    case DataType::TIMESTAMP_T:
+                    {
+                        success = pValue->setValue((uint64_t)sqlite3_column_int64(m_p_statement, index));
+                    }
+                    break;
+                    case DataType::DECIMAL_T:
+                    case DataType::NUMERIC_T:
+                    {
+                        success = pValue->setValue((float)sqlite3_column_double(m_p_statement, index));
+                    }
+                    break;
+                    case DataType::FLOAT_T:
+                    case DataType::REAL_T:
+                    {
+                        success = pValue->setValue(sqlite3_column_double(m_p_statement, index));
+                    }
+                    break;
+                    case DataType::CHAR_T:
+                    case DataType::VARCHAR_T:
+                    case DataType::VARCHAR_MAX_T:
+                    case DataType::TEXT_T:
+                    case DataType::XML_T:
+                    case DataType::JSON_T:
+                    case DataType::CLOB_T:
+                    {
+                        const char *pText = (const char *)sqlite3_column_text(m_p_statement, index);
+
+                        success = pValue->setValue(std::string(pText, sqlite3_column_bytes(m_p_statement, index)));
+                    }
+                    break;
+                    case DataType::NCHAR_T:
+                    case DataType::NVARCHAR_T:
+                    case DataType::NVARCHAR_MAX_T:
+                    case DataType::NTEXT_T:
+                    {
+                        const char *pText = (const char *)sqlite3_column_text(m_p_statement, index);
+
+                        success = pValue->setValue(tools::utf8_to_wide(std::string(pText, sqlite3_column_bytes(m_p_statement, index))));
+                    }
+                    break;
+                    case DataType::BINARY_T:
+                    case DataType::VARBINARY_T:
+                    case DataType::VARBINARY_MAX_T:
+                    case DataType::IMAGE_T:
+                    case DataType::BLOB_T:
+                    {
+                        const uint8_t *pBlob = (const uint8_t *)sqlite3_column_blob(m_p_statement, index);
+                        BinaryBlob value(pBlob, pBlob + sqlite3_column_bytes(m_p_statement, index));
+
+                        success = pValue->setValue(value);
+                    }
+                    break;
+                    case DataType::EndDataTypes:
+                    {
+                        success = false;
+                    }
+                    break;
+                    default:
+                    {
+                        // dates and times are stored as text, let the value parse them
+                        const char *pText = (const char *)sqlite3_column_text(m_p_statement, index);
+
+                        success = pValue->setValue(pText, sqlite3_column_bytes(m_p_statement, index));
+                    }
+                    break;
+                }
+            }
+
+            return success;
+        }
+
+        void SQLiteStatement::getResult(QueryResult &result) const
+        {
+            int col_count = sqlite3_column_count(m_p_statement);
+            RowData values(col_count);
+
+            if (result.columns.size() == 0) {
+                for (int index = 0; index < col_count; index++) {
+                    result.columns.push_back(sqlite3_column_name(m_p_statement, index));
+                }
+            }
+
+            for (int index = 0; index < col_count; index++) {
+                const char *pText = (const char *)sqlite3_column_text(m_p_statement, index);
+
+                // NULL comes back empty
+                if (pText != nullptr) {
+                    values[index].assign(pText, sqlite3_column_bytes(m_p_statement, index));
+                }
+            }
+            result.rows.push_back(values);
+        }
+
+        void SQLiteStatement::reset()
+        {
+            sqlite3_reset(m_p_statement);
+            sqlite3_clear_bindings(m_p_statement);
+        }
+    }
+}
@@ -2,41 +2,53 @@
  * SQLiteTable.cpp
  */
 
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "Row.h"
+#include "VariableData.h"
+#include "sqlite/SQLiteBlobStream.h"
 #include "sqlite/SQLiteColumn.h"
+#include "sqlite/SQLiteCursor.h"
 #include "sqlite/SQLiteTable.h"
 #include "sqlite/SQLiteUtility.h"
 
 namespace afm {
     namespace database {
-        using ColumnNames = std::vector<std::string>;
-
-        static const std::string sc_table_describe = "select sql from sqlite_master where name='%s'";
-        static const std::string sc_foriegn_key_restraint = "FOREIGN KEY";
-        static const std::string sc_constraint = "CONSTRAINT";
-
-        struct RowCallbackData {
-            RowCallbackData(SQLiteTable *pTable, Rows &rows)
-                : m_pTable(pTable)
-                , m_rows(rows)
-            {
-
-            }
-            SQLiteTable *m_pTable = nullptr;
-            Rows &m_rows;
+        // every column of every table in one pass, autoincrement is only allowed on an integer primary key on its own
+        // so the keyword anywhere in the table's sql belongs to that column
+        static const std::string sc_catalog_query = "select m.name, p.name, p.type, p.\"notnull\", p.pk, "
+            "(p.pk = 1 and upper(p.type) = 'INTEGER' and upper(m.sql) like '%AUTOINCREMENT%' and "
+            "(select count(*) from pragma_table_info(m.name) k where k.pk > 0) = 1) "
+            "from sqlite_master m join pragma_table_info(m.name) p "
+            "where m.type = 'table' and m.name not like 'sqlite_%'";
+        static const std::string sc_catalog_table_filter = " and m.name in (%s)";
+        static const std::string sc_catalog_order = " order by m.name, p.cid";
+        static const std::string sc_blob_affinity = "BLOB";
+
+        enum SQLiteCatalogFields : uint8_t {
+            sc_catalog_table = 0,
+            sc_catalog_column,
+            sc_catalog_type,
+            sc_catalog_not_null,
+            sc_catalog_primary,
+            sc_catalog_auto_increment,
+            sc_max_catalog_fields
         };
 
-        int sqlite_table_rows_callback(void *p_row_data, int col_count, char **pp_data, char **pp_columns);
-        int sqlite_table_columns_callback(void *p_column_details, int col_count, char **pp_data, char **pp_columns);
-        int sqlite_table_add_update_callback(void *p_flag, int col_count, char **pp_data, char **pp_columns);
+        // blobs are opened by rowid, the first row the filter matches is the one streamed
+        static const std::string sc_blob_locate = "select rowid, length(%c) from %t";
+        static const std::string sc_blob_reset = "update %t set %c=zeroblob(?) where rowid=?";
+
+        int sqlite_catalog_callback(void *p_catalog, int col_count, char **pp_data, char **pp_columns);
 
-        SQLiteTable::SQLiteTable(sqlite3 *p_db)
+        SQLiteTable::SQLiteTable(SQLiteConnectionPoolSPtr pWriters, SQLiteConnectionPoolSPtr pReaders)
             : Table()
-            , m_p_db(p_db)
+            , m_pWriters(pWriters)
+            , m_pReaders(pReaders)
         {
 
         }
@@ -45,150 +57,402 @@ namespace afm {
         {
         }
 
-        bool SQLiteTable::initialize(const std::string &table_name)
+        bool SQLiteTable::loadCatalog(sqlite3 *p_db, CatalogDetails &catalog, const TableNames &tables)
         {
-            bool success = Table::initialize(table_name);
+            std::string query = sc_catalog_query;
 
-            if (success == true) {
-                ColumnNames columns;
+            if (tables.size() > 0) {
+                std::string filter = sc_catalog_table_filter;
 
-                // get column details
-                std::string query = sc_table_describe;
+                filter.replace(filter.find("%s"), 2, build_name_list(tables));
+                query += filter;
+            }
+            query += sc_catalog_order;
 
-                query.replace(query.find("%s"), 2, table_name);
+            return issueCommand(p_db, query, sqlite_catalog_callback, &catalog);
+        }
 
-                if (issueCommand(m_p_db, query, sqlite_table_columns_callback, &columns) == true) {
-                    // we can now look at each column and it's details
-                    for (auto column : columns) {
-                        // skipping foriegn key constraints right now
-                        if ((column.find(sc_foriegn_key_restraint) == std::string::npos) &&
-                            (column.find(sc_constraint) == std::string::npos)) {
-                            IColumnSPtr pColumn = createEmptyColumn();
+        IColumnSPtr SQLiteTable::createEmptyColumn() const
+        {
+            return std::make_shared<SQLiteColumn>();
+        }
 
-                            if (pColumn->initialize(column) == true) {
-                                add_column(pColumn);
-                            }
-                        } else {
-                            // we should notify the database about foreign keys and constraints
-                        }
+        bool SQLiteTable::on_create_row(const std::string &query, const StatementValues &values)
+        {
+            return execute(query, values);
+        }
+
+        bool SQLiteTable::on_create_rows(const Rows &rows, uint32_t batch_size)
+        {
+            // the one writer is held for the whole set, inside an open transaction each batch is a savepoint
+            SQLiteConnectionSPtr pConnection = get_writer();
+            bool success = (pConnection != nullptr);
+            uint32_t scope = 0;
+            uint32_t batch_count = 0;
+            SQLiteStatementSPtr pStatement = nullptr;
+
+            for (auto pRow : rows) {
+                if (success == false) {
+                    break;
+                }
+
+                StatementValues values;
+                std::string query = build_insert(pRow, values);
+
+                if (scope == 0) {
+                    scope = pConnection->beginScope();
+                    success = (scope > 0);
+                }
+
+                // every row binds the same markers, so one statement serves the whole set
+                if ((success == true) && ((pStatement == nullptr) || (pStatement->getQuery() != query))) {
+                    pConnection->release(pStatement);
+                    pStatement = pConnection->acquire(query);
+                    success = (pStatement != nullptr);
+                }
+
+                if (success == true) {
+                    success = pStatement->bind(values);
+                    if (success == true) {
+                        success = (pStatement->step() == SQLITE_DONE);
+                    }
+                    pStatement->reset();
+
+                    if (success == true) {
+                        success = pConnection->mirror(query, values);
                     }
-                } else {
-                    success = false;
+                }
+
+                if ((success == true) && (++batch_count >= batch_size)) {
+                    success = pConnection->commitScope(scope);
+                    if (success == true) {
+                        scope = 0;
+                    }
+                    batch_count = 0;
                 }
             }
+
+            if (pConnection != nullptr) {
+                pConnection->release(pStatement);
+
+                if (scope > 0) {
+                    if (success == true) {
+                        success = pConnection->commitScope(scope);
+                    }
+                    if (success == false) {
+                        // only the batch in flight is lost, earlier batches are already committed
+                        pConnection->rollbackScope(scope);
+                    }
+                }
+            }
+
             return success;
         }
 
-        IColumnSPtr SQLiteTable::createEmptyColumn() const
+        bool SQLiteTable::on_update_row(const std::string &query, const StatementValues &values)
         {
-            return std::make_shared<SQLiteColumn>();
+            bool success = execute(query, values);
+
+            if (success == false) {
+                // log it
+            }
+
+            return success;
         }
 
-        bool SQLiteTable::on_create_row(const std::string &query)
+        bool SQLiteTable::on_get_row(IRowSPtr &pRow, const std::string &query, const StatementValues &values)
         {
             bool success = false;
+            SQLiteConnectionSPtr pConnection = get_reader();
 
-            issueCommand(m_p_db, query, sqlite_table_add_update_callback, &success);
+            if (pConnection != nullptr) {
+                SQLiteStatementSPtr pStatement = pConnection->acquire(query);
+
+                if (pStatement != nullptr) {
+                    if (pStatement->bind(values) == true) {
+                        // we should warn when more than one row is returned
+                        if (pStatement->step() == SQLITE_ROW) {
+                            IRowSPtr pNewRow = createEmptyRow();
+
+                            if (pStatement->getRow(pNewRow) == true) {
+                                pRow = pNewRow;
+                                success = true;
+                            }
+                        }
+                    }
+                    pConnection->release(pStatement);
+                }
+            }
 
             return success;
         }
 
-        bool SQLiteTable::on_update_row(const std::string &query)
+        bool SQLiteTable::on_get_rows(Rows &rows, const std::string &query, const StatementValues &values, const Projection &projection)
         {
             bool success = false;
+            SQLiteConnectionSPtr pConnection = get_reader();
 
-            if (issueCommand(m_p_db, query, sqlite_table_add_update_callback, &success) == false) {
-                // log it
+            if (pConnection != nullptr) {
+                SQLiteStatementSPtr pStatement = pConnection->acquire(query);
+
+                if (pStatement != nullptr) {
+                    if (pStatement->bind(values) == true) {
+                        int result = SQLITE_ROW;
+                        bool all_read = true;
+
+                        while ((result = pStatement->step()) == SQLITE_ROW) {
+                            IRowSPtr pRow = createEmptyRow(projection);
+
+                            if (pStatement->getRow(pRow) == true) {
+                                rows.push_back(pRow);
+                            } else {
+                                all_read = false;
+                            }
+                        }
+
+                        // no rows matching is an empty result, only an error stepping or reading fails
+                        success = (result == SQLITE_DONE) && (all_read == true);
+                    }
+                    pConnection->release(pStatement);
+                }
             }
 
             return success;
         }
 
-        bool SQLiteTable::on_get_row(IRowSPtr &pRow, const std::string &query)
+        bool SQLiteTable::on_get_values(AggregateRows &results, const std::string &query, const StatementValues &values, const DataTypes &types)
         {
             bool success = false;
-            Rows rows;
-            RowCallbackData rowData(this, rows);
+            SQLiteConnectionSPtr pConnection = get_reader();
 
-            if (issueCommand(m_p_db, query, sqlite_table_rows_callback, &rowData) == true) {
-                if (rows.size() > 0) {
-                    // we should warn when more than one row is returned
-                    pRow = rows[0];
-                    success = true;
+            if (pConnection != nullptr) {
+                SQLiteStatementSPtr pStatement = pConnection->acquire(query);
+
+                if (pStatement != nullptr) {
+                    if (pStatement->bind(values) == true) {
+                        int result = SQLITE_ROW;
+
+                        while ((result = pStatement->step()) == SQLITE_ROW) {
+                            AggregateRow row = create_values(types);
+
+                            for (std::size_t index = 0; index < row.size(); index++) {
+                                pStatement->getValue(index, row[index]);
+                            }
+                            results.push_back(row);
+                        }
+
+                        // unlike rows an empty result is an answer, nothing matched
+                        success = (result == SQLITE_DONE);
+                    }
+                    pConnection->release(pStatement);
                 }
             }
 
             return success;
         }
 
-        bool SQLiteTable::on_get_rows(Rows &rows, const std::string &query)
+        ICursorSPtr SQLiteTable::on_scan(const std::string &query, const StatementValues &values, const Projection &projection)
+        {
+            ICursorSPtr pCursor = nullptr;
+            SQLiteConnectionSPtr pConnection = get_reader();
+
+            if (pConnection != nullptr) {
+                SQLiteStatementSPtr pStatement = pConnection->acquire(query);
+
+                if (pStatement != nullptr) {
+                    if (pStatement->bind(values) == true) {
+                        // the cursor owns the statement and its connection until it is closed
+                        pCursor = std::make_shared<SQLiteCursor>(shared_from_this(), pConnection, pStatement, projection);
+                    } else {
+                        pConnection->release(pStatement);
+                    }
+                }
+            }
+
+            return pCursor;
+        }
+
+        IColumnSPtr SQLiteTable::on_clone_column(const Column &column) const
+        {
+            return std::make_shared<SQLiteColumn>(column);
+        }
+
+        bool SQLiteTable::execute(const std::string &query, const StatementValues &values)
         {
             bool success = false;
+            SQLiteConnectionSPtr pConnection = get_writer();
 
-            RowCallbackData rowData(this, rows);
+            if (pConnection != nullptr) {
+                success = pConnection->execute(query, values);
+            }
 
-            if (issueCommand(m_p_db, query, sqlite_table_rows_callback, &rowData) == true) {
-                if (rows.size() > 0) {
-                    success = true;
-                }
+            return success;
+        }
+
+        bool SQLiteTable::on_load_columns(ColumnDetails &columns) const
+        {
+            bool success = false;
+            SQLiteConnectionSPtr pConnection = get_reader();
+            CatalogDetails catalog;
+
+            if ((pConnection != nullptr) && (loadCatalog(pConnection->getHandle(), catalog, {getName()}) == true)) {
+                columns = catalog[getName()];
+                success = true;
             }
 
             return success;
         }
 
-        IColumnSPtr SQLiteTable::on_clone_column(const Column &column) const
+        IBlobStreamSPtr SQLiteTable::on_read_blob(const std::string &column_name, const std::string &filter, const StatementValues &values)
         {
-            return std::make_shared<SQLiteColumn>(column);
+            IBlobStreamSPtr pStream = nullptr;
+            SQLiteConnectionSPtr pConnection = get_reader();
+            int64_t row_id = 0;
+            uint64_t size = 0;
+
+            if ((pConnection != nullptr) && (locate_blob(pConnection, column_name, filter, values, row_id, size) == true)) {
+                // the stream holds the reader until it is closed
+                std::shared_ptr<SQLiteBlobStream> pBlobStream = std::make_shared<SQLiteBlobStream>(pConnection, size, false);
+
+                if (pBlobStream->initialize(getName(), column_name, row_id, {pConnection->getHandle()}) == true) {
+                    pStream = pBlobStream;
+                }
+            }
+
+            return pStream;
         }
 
-        int sqlite_table_columns_callback(void *p_column_details, int col_count, char **pp_data, char **pp_columns)
+        IBlobStreamSPtr SQLiteTable::on_write_blob(const std::string &column_name, const std::string &filter, const StatementValues &values, uint64_t size)
         {
-            ColumnNames *pColumns = (ColumnNames *)p_column_details;
+            IBlobStreamSPtr pStream = nullptr;
+            SQLiteConnectionSPtr pConnection = get_writer();
 
-            if (col_count > 0) {
-                char *pStart = pp_data[0];
-                char *pEOL = pStart;
- 
-                do {
-                    pEOL = strchr(pStart, '\n');
-                    if (pEOL != nullptr) {
-                        *pEOL = '\0';
-                    }
-                    // Column declaration?
-                    if (strchr(pStart, '[') != nullptr) {
-                        pColumns->push_back(pStart);
+            uint32_t scope = 0;
+
+            // the scope stays open until the stream is closed, see SQLiteBlobStream::on_close
+            if (pConnection != nullptr) {
+                scope = pConnection->beginScope();
+            }
+
+            if (scope > 0) {
+                int64_t row_id = 0;
+                uint64_t current_size = 0;
+                bool in_transaction = true;
+
+                if (locate_blob(pConnection, column_name, filter, values, row_id, current_size) == true) {
+                    std::string query = sc_blob_reset;
+                    StatementValues reset_values = { std::make_shared<VariableData>(), std::make_shared<VariableData>() };
+
+                    query.replace(query.find("%t"), 2, getName());
+                    query.replace(query.find("%c"), 2, column_name);
+
+                    // the value is sized up front and then filled in place
+                    reset_values[0]->initialize(DataType::BIG_INT_T);
+                    reset_values[0]->setValue((int64_t)size);
+                    reset_values[1]->initialize(DataType::BIG_INT_T);
+                    reset_values[1]->setValue(row_id);
+
+                    if (pConnection->execute(query, reset_values) == true) {
+                        std::vector<sqlite3 *> handles = {pConnection->getHandle()};
+                        std::shared_ptr<SQLiteBlobStream> pBlobStream = std::make_shared<SQLiteBlobStream>(pConnection, size, true, scope);
+
+                        // a write through replica fills the copy in the file alongside
+                        if (pConnection->getMirror() != nullptr) {
+                            handles.push_back(pConnection->getMirror()->getHandle());
+                        }
+
+                        // from here on the stream owns the transaction, it rolls back if this fails
+                        in_transaction = false;
+
+                        if (pBlobStream->initialize(getName(), column_name, row_id, handles) == true) {
+                            pStream = pBlobStream;
+                        }
                     }
-                    pStart = pEOL + 1;
-                } while (pEOL != nullptr);
+                }
+
+                if (in_transaction == true) {
+                    pConnection->rollbackScope(scope);
+                }
             }
 
-            return SQLITE_OK;
+            return pStream;
         }
 
-        int sqlite_table_rows_callback(void *p_row_data, int col_count, char **pp_data, char **pp_columns)
+        bool SQLiteTable::locate_blob(SQLiteConnectionSPtr &pConnection, const std::string &column_name, const std::string &filter, const StatementValues &values, int64_t &row_id, uint64_t &size)
         {
-            RowCallbackData *pRowData = (RowCallbackData *)p_row_data;
+            bool success = false;
+            std::string query = sc_blob_locate;
 
-            if (col_count > 0) {
-                IRowSPtr pRow = pRowData->m_pTable->createEmptyRow();
-                RowData rowData;
-                for (int index = 0; index < col_count; index++) {
-                    rowData.push_back(pp_data[index]);
-                }
+            query.replace(query.find("%c"), 2, column_name);
+            query.replace(query.find("%t"), 2, getName());
+            query += filter;
+
+            SQLiteStatementSPtr pStatement = pConnection->acquire(query);
+
+            if (pStatement != nullptr) {
+                if ((pStatement->bind(values) == true) && (pStatement->step() == SQLITE_ROW)) {
+                    IVariableDataSPtr pRowId = std::make_shared<VariableData>();
+                    IVariableDataSPtr pSize = std::make_shared<VariableData>();
+                    int64_t length = 0;
 
-                if (pRow->setValues(rowData) == true) {
-                    pRowData->m_rows.push_back(pRow);
+                    pRowId->initialize(DataType::BIG_INT_T);
+                    pSize->initialize(DataType::BIG_INT_T);
+
+                    if ((pStatement->getValue(0, pRowId) == true) && (pStatement->getValue(1, pSize) == true)) {
+                        pRowId->getValue(row_id);
+                        pSize->getValue(length);
+                        size = length;
+                        success = true;
+                    }
                 }
+                pConnection->release(pStatement);
             }
 
-            return SQLITE_OK;
+            return success;
         }
 
-        int sqlite_table_add_update_callback(void *p_flag, int col_count, char **pp_data, char **pp_columns)
+        SQLiteConnectionSPtr SQLiteTable::get_writer() const
         {
-            bool *pSuccess = (bool *)p_flag;
+            return m_pWriters->acquire();
+        }
+
+        SQLiteConnectionSPtr SQLiteTable::get_reader() const
+        {
+            // a thread in a transaction reads through its writer so it sees its own changes
+            SQLiteConnectionSPtr pConnection = m_pWriters->getLease();
+
+            if ((pConnection == nullptr) || (pConnection->inTransaction() == false)) {
+                // without a reader pool (in memory databases) reads share the writer
+                pConnection = m_pReaders != nullptr ? m_pReaders->acquire() : m_pWriters->acquire();
+            }
+
+            return pConnection;
+        }
+
+        int sqlite_catalog_callback(void *p_catalog, int col_count, char **pp_data, char **pp_columns)
+        {
+            CatalogDetails *pCatalog = (CatalogDetails *)p_catalog;
+
+            if ((pp_data != nullptr) && (col_count >= sc_max_catalog_fields)) {
+                // rebuild the declaration the column parser understands, "[Name] TYPE PRIMARY KEY AUTOINCREMENT NOT NULL"
+                std::stringstream column;
+                const char *pType = pp_data[sc_catalog_type];
+
+                // no declared type means blob affinity
+                column << "[" << pp_data[sc_catalog_column] << "] " << (((pType != nullptr) && (*pType != '\0')) ? pType : sc_blob_affinity.c_str());
+
+                if (strcmp(pp_data[sc_catalog_primary], "0") != 0) {
+                    column << " " << sc_primary_key;
+                }
+                if (strcmp(pp_data[sc_catalog_auto_increment], "0") != 0) {
+                    column << " " << sc_auto_increment;
+                }
+                if (strcmp(pp_data[sc_catalog_not_null], "0") != 0) {
+                    column << " " << sc_not_null;
+                }
 
-            *pSuccess = true;
+                (*pCatalog)[pp_data[sc_catalog_table]].push_back(column.str());
+            }
 
             return SQLITE_OK;
         }
@@ -4,6 +4,7 @@
 #include <DatabaseFactory.h>
 
 afm::database::ITableSPtr create_table(afm::database::IDatabaseSPtr &pDatabase, const std::string &table_name);
+void test_sqlite_checks(afm::database::IDatabaseSPtr &pDatabase);
 
 void test_sqlite()
 {
@@ -36,6 +37,17 @@ void test_sqlite()
                 std::cout << row->toString();
             }
 
+            afm::database::ICursorSPtr pCursor = pTable->scan();
+            if (pCursor != nullptr) {
+                afm::database::IRowSPtr pScanRow = nullptr;
+                uint32_t row_count = 0;
+
+                while (pCursor->next(pScanRow) == true) {
+                    row_count++;
+                }
+                std::cout << "Scanned " << row_count << " rows\n";
+            }
+
             afm::database::IRowSPtr pRow = pTable->createEmptyRow();
             if (pRow != nullptr) {
                 afm::database::QueryOptions options;
@@ -65,12 +77,352 @@ void test_sqlite()
             std::cout << "FAILED to find table: artists\n";
         }
 
+        test_sqlite_checks(pDatabase);
+
         if (pDatabase->test_database() != true) {
             std::cout << "FAILED database test.\n";
         }
     }
 }
 
+// the checks below read tables the demo above leaves alone and write only a scratch table, the expected
+// values are those of the bundled chinook.db
+bool check(bool passed, const std::string &description)
+{
+    if (passed == false) {
+        std::cout << "FAILED: " << description << "\n";
+    }
+
+    return passed;
+}
+
+std::size_t count_rows(afm::database::ITableSPtr &pTable, const afm::database::QueryOptions &options)
+{
+    afm::database::Rows rows;
+
+    // nothing matching counts as no rows
+    pTable->get(rows, options);
+
+    return rows.size();
+}
+
+std::string get_text(const afm::database::IRowSPtr &pRow, const std::string &column_name)
+{
+    afm::database::IColumnSPtr pColumn = (pRow != nullptr) ? pRow->getColumn(column_name) : nullptr;
+
+    return (pColumn != nullptr) ? pColumn->getValue()->getValue() : std::string();
+}
+
+afm::database::ITableSPtr create_scratch_table(afm::database::IDatabaseSPtr &pDatabase)
+{
+    afm::database::TableOptions details;
+
+    // an integer primary key without autoincrement takes the ids it is given
+    pDatabase->dropTable("afm_checks");
+    details["name"] = "afm_checks";
+    details["columns"] = nlohmann::json::array();
+    details["columns"].push_back({ {"name", "id"}, {"type", "integer"}, {"primary", true} });
+    details["columns"].push_back({ {"name", "name"}, {"type", "text"} });
+    details["columns"].push_back({ {"name", "amount"}, {"type", "integer"} });
+    details["columns"].push_back({ {"name", "price"}, {"type", "numeric"}, {"size", "10"}, {"precision", ",2"} });
+    return pDatabase->createTable(details);
+}
+
+afm::database::Rows make_rows(afm::database::ITableSPtr &pTable, uint32_t first_id, uint32_t count)
+{
+    afm::database::Rows rows;
+
+    for (uint32_t id = first_id; id < (first_id + count); id++) {
+        afm::database::IRowSPtr pRow = pTable->createEmptyRow();
+
+        pRow->setValue("id", std::to_string(id).c_str());
+        pRow->setValue("name", ("row " + std::to_string(id)).c_str());
+        pRow->setValue("amount", std::to_string(id).c_str());
+        rows.push_back(pRow);
+    }
+
+    return rows;
+}
+
+void test_sqlite_options(afm::database::IDatabaseSPtr &pDatabase)
+{
+    afm::database::ITableSPtr pTable = pDatabase->getTable("tracks");
+
+    if (check(pTable != nullptr, "tracks table") == true) {
+        afm::database::QueryOptions options;
+        afm::database::Rows rows;
+
+        check(count_rows(pTable, {{"GenreId", 1}}) == 1297, "equality");
+        check(count_rows(pTable, {{"$or", {{{"GenreId", 1}}, {{"GenreId", 2}}}}}) == 1427, "$or");
+        check(count_rows(pTable, {{"$and", {{{"GenreId", 1}}, {{"Milliseconds", {{">", 300000}}}}}}}) == 407, "$and with >");
+        check(count_rows(pTable, {{"GenreId", {1, 2, 3}}}) == 1801, "array as in");
+        check(count_rows(pTable, {{"GenreId", {{"not in", {1, 2, 3}}}}}) == 1702, "not in");
+        check(count_rows(pTable, {{"Milliseconds", {{"between", {200000, 210000}}}}}) == 162, "between");
+        check(count_rows(pTable, {{"Name", {{"like", "A%"}}}}) == 199, "like");
+        check(count_rows(pTable, {{"Composer", nullptr}}) == 978, "null as is null");
+        check(count_rows(pTable, {{"Composer", {{"is null", false}}}}) == 2525, "is not null");
+
+        options["GenreId"] = 2;
+        options["$order_by"] = {"Milliseconds desc", "TrackId"};
+        options["$limit"] = 3;
+        options["$offset"] = 2;
+        if (check(pTable->get(rows, options) == true, "$order_by, $limit and $offset") == true) {
+            check((rows.size() == 3) && (get_text(rows[0], "TrackId") == "601") && (get_text(rows[1], "TrackId") == "848") &&
+                  (get_text(rows[2], "TrackId") == "127"), "ordered page of rows");
+        }
+
+        // a malformed filter fails rather than matching everything
+        check(pTable->get(rows, afm::database::QueryOptions {{"NoSuchColumn", 1}}) == false, "unknown column");
+        check(pTable->get(rows, afm::database::QueryOptions {{"GenreId", {{"between", {1}}}}}) == false, "between without two bounds");
+        check(pTable->get(rows, afm::database::QueryOptions {{"1 = 1 or GenreId", 1}}) == false, "filter key that is not a column");
+        check(count_rows(pTable, {{"genreid", 1}}) == 1297, "filter key in another case");
+    }
+}
+
+void test_sqlite_updates(afm::database::ITableSPtr &pTable)
+{
+    afm::database::IRowSPtr pRow = nullptr;
+
+    for (auto pNewRow : make_rows(pTable, 1, 10)) {
+        check(pTable->create(pNewRow) == true, "create");
+    }
+
+    // an update needs a filter, ordering and paging alone would widen it to every row
+    if (check(pTable->get(pRow, {{"id", 5}}) == true, "get one row") == true) {
+        pRow->setValue("name", "renamed");
+        check(pTable->set(pRow, {{"$limit", 1}}) == false, "update without a filter");
+        check(count_rows(pTable, {{"name", "renamed"}}) == 0, "no row renamed");
+        check(pTable->set(pRow, {{"amount", 5}}) == true, "update with a filter");
+        check(count_rows(pTable, {{"name", "renamed"}}) == 1, "one row renamed");
+    }
+}
+
+void test_sqlite_lookups(afm::database::IDatabaseSPtr &pDatabase, afm::database::ITableSPtr &pScratch)
+{
+    afm::database::ITableSPtr pTable = pDatabase->getTable("tracks");
+    afm::database::IRowSPtr pRow = nullptr;
+
+    // repeated point lookups reuse the cached statement, each with its own bound values
+    if (check(pTable != nullptr, "tracks table") == true) {
+        for (int64_t id = 1; id <= 3; id++) {
+            if (check(pTable->get(pRow, {{"TrackId", id}}) == true, "get by key") == true) {
+                check(get_text(pRow, "TrackId") == std::to_string(id), "the row asked for");
+            }
+        }
+        check(pTable->get(pRow, {{"TrackId", -1}}) == false, "get with no match");
+
+        // read straight into the column types, numbers never pass through text
+        if (check(pTable->get(pRow, {{"TrackId", 1}}) == true, "get track 1") == true) {
+            afm::database::IVariableDataSPtr pMilliseconds = pRow->getColumn("Milliseconds")->getValue();
+            afm::database::IVariableDataSPtr pPrice = pRow->getColumn("UnitPrice")->getValue();
+            float price = 0;
+
+            check((pMilliseconds->isCharacterData() == false) && (pMilliseconds->getValue() == "343719"), "integer column");
+            check((pPrice->getValue(price) == true) && (price > 0.989) && (price < 0.991), "numeric column");
+            check(get_text(pRow, "Name") == "For Those About To Rock (We Salute You)", "text column");
+        }
+    }
+
+    // a numeric goes in as written, not as the nearest float
+    if (check(pScratch->get(pRow, {{"id", 1}}) == true, "get scratch row") == true) {
+        afm::database::ICursorSPtr pCursor = nullptr;
+        afm::database::IRowSPtr pResult = nullptr;
+
+        pRow->setValue("price", "0.99");
+        check(pScratch->set(pRow, {{"id", 1}}) == true, "set numeric");
+        pCursor = pDatabase->query("select count(*) as matches from afm_checks where id = 1 and price = 0.99");
+        check((pCursor != nullptr) && (pCursor->next(pResult) == true) && (get_text(pResult, "matches") == "1"), "numeric stored exactly");
+        check((pScratch->get(pRow, {{"id", 1}}) == true) && (get_text(pRow, "price") == "0.99"), "numeric read back");
+    }
+}
+
+void test_sqlite_bulk(afm::database::ITableSPtr &pTable)
+{
+    // bulk insert in batches, 1000 rows on top of the 10 the updates made
+    check(pTable->createMany(make_rows(pTable, 101, 1000), 128) == true, "createMany");
+    check(count_rows(pTable, {{"id", {{"between", {101, 1100}}}}}) == 1000, "every row created with its id");
+    check(pTable->createMany(make_rows(pTable, 1100, 2)) == false, "createMany with a duplicate key");
+    check(count_rows(pTable, {{"id", 1101}}) == 0, "a failed batch leaves nothing behind");
+}
+
+void test_sqlite_transactions(afm::database::IDatabaseSPtr &pDatabase, afm::database::ITableSPtr &pTable)
+{
+    afm::database::QueryOptions range = {{"id", {{"between", {2001, 3000}}}}};
+
+    // a rolled back transaction leaves nothing behind, a committed one keeps its rows
+    afm::database::ITransactionSPtr pTransaction = pDatabase->beginTransaction();
+    if (check(pTransaction != nullptr, "begin transaction") == true) {
+        check(pTable->createMany(make_rows(pTable, 2001, 1000)) == true, "createMany in a transaction");
+        check(count_rows(pTable, range) == 1000, "rows visible inside the transaction");
+        pTransaction->rollback();
+        check(count_rows(pTable, range) == 0, "rows gone after rollback");
+    }
+
+    pTransaction = pDatabase->beginTransaction();
+    if (check(pTransaction != nullptr, "begin transaction") == true) {
+        afm::database::IRowSPtr pFirst = make_rows(pTable, 2001, 1)[0];
+        afm::database::IRowSPtr pSecond = make_rows(pTable, 2002, 1)[0];
+        afm::database::ITransactionSPtr pNested = nullptr;
+
+        check(pTable->create(pFirst) == true, "create in a transaction");
+        pNested = pDatabase->beginTransaction();
+        if (check(pNested != nullptr, "savepoint") == true) {
+            check(pTable->create(pSecond) == true, "create in a savepoint");
+            pNested->rollback();
+        }
+        check(pTransaction->commit() == true, "commit");
+        check((count_rows(pTable, range) == 1) && (count_rows(pTable, {{"id", 2001}}) == 1), "only the outer row committed");
+    }
+
+    // released without a commit rolls back
+    pTransaction = pDatabase->beginTransaction();
+    if (check(pTransaction != nullptr, "begin transaction") == true) {
+        afm::database::IRowSPtr pRow = make_rows(pTable, 2003, 1)[0];
+
+        check(pTable->create(pRow) == true, "create in a transaction");
+        pTransaction = nullptr;
+        check(count_rows(pTable, {{"id", 2003}}) == 0, "released transaction rolled back");
+    }
+}
+
+void test_sqlite_paging(afm::database::IDatabaseSPtr &pDatabase)
+{
+    afm::database::ITableSPtr pTable = pDatabase->getTable("albums");
+
+    if (check(pTable != nullptr, "albums table") == true) {
+        afm::database::PageOrder orders[] = { afm::database::PageOrder::Ascending, afm::database::PageOrder::Descending };
+
+        for (auto order : orders) {
+            afm::database::PageToken token;
+            afm::database::Rows rows;
+            std::size_t total = 0;
+            std::size_t pages = 0;
+            int64_t last_id = (order == afm::database::PageOrder::Ascending) ? 0 : INT64_MAX;
+            bool in_order = true;
+
+            // 347 albums in pages of 50, the token is null again once the last page is read
+            do {
+                if (check(pTable->page(rows, token, 50, order) == true, "page") == false) {
+                    break;
+                }
+                for (auto pRow : rows) {
+                    int64_t id = std::stoll(get_text(pRow, "AlbumId"));
+
+                    in_order = in_order && ((order == afm::database::PageOrder::Ascending) ? (id > last_id) : (id < last_id));
+                    last_id = id;
+                }
+                total += rows.size();
+                pages++;
+            } while ((token.is_null() == false) && (pages < 10));
+
+            check((total == 347) && (pages == 7) && (in_order == true), "every album once, in key order");
+        }
+
+        // past the last key is an empty page rather than a failure, a failed read leaves the token where it was
+        afm::database::PageToken token = nlohmann::json::array({ 100000 });
+        afm::database::Rows rows;
+
+        check((pTable->page(rows, token, 50) == true) && (rows.size() == 0) && (token.is_null() == true), "empty last page");
+        token = nlohmann::json::array({ 100 });
+        check((pTable->page(rows, token, 50, afm::database::PageOrder::Ascending, {{"NoSuchColumn", 1}}) == false) &&
+              (token == nlohmann::json::array({ 100 })), "failed page keeps its token");
+    }
+}
+
+void test_sqlite_aggregates(afm::database::IDatabaseSPtr &pDatabase)
+{
+    afm::database::ITableSPtr pTable = pDatabase->getTable("tracks");
+
+    if (check(pTable != nullptr, "tracks table") == true) {
+        afm::database::AggregateRows results;
+        afm::database::Aggregates aggregates = {
+            { afm::database::AggregateFunction::Count, "" },
+            { afm::database::AggregateFunction::Sum, "Milliseconds" },
+            { afm::database::AggregateFunction::Minimum, "Milliseconds" },
+            { afm::database::AggregateFunction::Maximum, "Milliseconds" },
+            { afm::database::AggregateFunction::Average, "Milliseconds" }
+        };
+
+        if (check(pTable->aggregate(results, aggregates, afm::database::ColumnNames(), {{"GenreId", 1}}) == true, "aggregate") == true) {
+            int64_t count = 0;
+            int64_t sum = 0;
+            double average = 0;
+
+            check((results.size() == 1) && (results[0].size() == 5), "one row of five aggregates");
+            if (results.size() == 1) {
+                check((results[0][0]->getValue(count) == true) && (count == 1297), "count");
+                check((results[0][1]->getValue(sum) == true) && (sum == 368231326), "sum");
+                check(results[0][2]->getValue() == "1071", "minimum");
+                check(results[0][3]->getValue() == "1612329", "maximum");
+                check((results[0][4]->getValue(average) == true) && (average > 283910.04) && (average < 283910.05), "average");
+            }
+        }
+
+        // a row per genre in genre order
+        aggregates = { { afm::database::AggregateFunction::Count, "" } };
+        if (check(pTable->aggregate(results, aggregates, {"GenreId"}, {{"$order_by", "GenreId"}}) == true, "grouped aggregate") == true) {
+            int64_t count = 0;
+
+            check(results.size() == 25, "a row per genre");
+            check((results.size() > 0) && (results[0][0]->getValue() == "1") && (results[0][1]->getValue(count) == true) && (count == 1297),
+                  "grouping value before the aggregate");
+        }
+
+        // only columns of the table can be aggregated or grouped
+        aggregates = { { afm::database::AggregateFunction::Sum, "NoSuchColumn" } };
+        check(pTable->aggregate(results, aggregates) == false, "aggregate of an unknown column");
+    }
+}
+
+void test_sqlite_exports(afm::database::IDatabaseSPtr &pDatabase)
+{
+    afm::database::ITableSPtr pTable = pDatabase->getTable("albums");
+    afm::database::ICursorSPtr pCursor = nullptr;
+    afm::database::IRowSPtr pRow = nullptr;
+    std::size_t count = 0;
+
+    if (check(pTable != nullptr, "albums table") == true) {
+        check((pTable->exportRows([&count](const afm::database::IRowSPtr &pRow) { count++; return true; }) == true) && (count == 347), "export every row");
+        count = 0;
+        check((pTable->exportRows([&count](const afm::database::IRowSPtr &pRow) { return ++count < 10; }) == true) && (count == 10), "export stopped early");
+    }
+
+    // the second row overflows, the cursor has to say it failed rather than ran out
+    pCursor = pDatabase->query("select abs(x) as value from (select 1 as x union all select -9223372036854775808)");
+    if (check(pCursor != nullptr, "query cursor") == true) {
+        check(pCursor->next(pRow) == true, "first row before the failure");
+        check((pCursor->next(pRow) == false) && (pCursor->hasFailed() == true), "failed fetch is not the end of the rows");
+    }
+    pCursor = pDatabase->query("select 1 as value");
+    if (check(pCursor != nullptr, "query cursor") == true) {
+        while (pCursor->next(pRow) == true) {
+        }
+        check(pCursor->hasFailed() == false, "running out of rows is not a failure");
+    }
+}
+
+void test_sqlite_checks(afm::database::IDatabaseSPtr &pDatabase)
+{
+    afm::database::ITableSPtr pScratch = create_scratch_table(pDatabase);
+
+    std::cout << "Running checks\n";
+
+    test_sqlite_options(pDatabase);
+    if (check(pScratch != nullptr, "scratch table") == true) {
+        test_sqlite_updates(pScratch);
+        test_sqlite_lookups(pDatabase, pScratch);
+        test_sqlite_bulk(pScratch);
+        test_sqlite_transactions(pDatabase, pScratch);
+    }
+    test_sqlite_paging(pDatabase);
+    test_sqlite_aggregates(pDatabase);
+    test_sqlite_exports(pDatabase);
+    pScratch = nullptr;
+    check(pDatabase->dropTable("afm_checks") == true, "drop scratch table");
+
+    std::cout << "Checks done\n";
+}
+
 void test_mysql()
 {
    afm::database::DatabaseOptions options;
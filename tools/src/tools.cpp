@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <sstream>
 
 #include "tools/tools.h"
@@ -96,5 +97,67 @@ namespace afm {
 
             return lower.str();
         }
+
+        std::wstring utf8_to_wide(const std::string &source)
+        {
+            std::wstring wide;
+
+            wide.reserve(source.size());
+
+            for (std::size_t index = 0; index < source.size();) {
+                unsigned char lead = static_cast<unsigned char>(source[index]);
+                uint32_t code_point = lead;
+                std::size_t extra = 0;
+
+                if (lead >= 0xF0) {
+                    code_point = lead & 0x07;
+                    extra = 3;
+                } else if (lead >= 0xE0) {
+                    code_point = lead & 0x0F;
+                    extra = 2;
+                } else if (lead >= 0xC0) {
+                    code_point = lead & 0x1F;
+                    extra = 1;
+                }
+
+                index++;
+                while ((extra > 0) && (index < source.size())) {
+                    code_point = (code_point << 6) | (static_cast<unsigned char>(source[index++]) & 0x3F);
+                    extra--;
+                }
+                wide.push_back(static_cast<wchar_t>(code_point));
+            }
+
+            return wide;
+        }
+
+        std::string wide_to_utf8(const std::wstring &source)
+        {
+            std::string narrow;
+
+            narrow.reserve(source.size());
+
+            for (auto character : source) {
+                uint32_t code_point = static_cast<uint32_t>(character);
+
+                if (code_point < 0x80) {
+                    narrow.push_back(static_cast<char>(code_point));
+                } else if (code_point < 0x800) {
+                    narrow.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                    narrow.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                } else if (code_point < 0x10000) {
+                    narrow.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                    narrow.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                    narrow.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                } else {
+                    narrow.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                    narrow.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                    narrow.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                    narrow.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                }
+            }
+
+            return narrow;
+        }
     }
 }
\ No newline at end of file
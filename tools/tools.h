@@ -20,6 +20,8 @@ namespace afm {
         std::string rtrim_string(const std::string &target);
         std::string to_upper(const std::string &source);
         std::string to_lower(const std::string &source);
+        std::wstring utf8_to_wide(const std::string &source);
+        std::string wide_to_utf8(const std::wstring &source);
     }
 }
 #endif
\ No newline at end of file